@@ -0,0 +1,168 @@
+extern "C" {
+#include <libavfilter/avfilter.h>
+#include <libavfilter/buffersink.h>
+#include <libavfilter/buffersrc.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/version.h>
+}
+
+#include <benchmark/benchmark.h>
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <string>
+#include <vector>
+
+#include "audio/equalizer.h"
+#include "model/audio_filter.h"
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr int kChannels = 2;
+constexpr int kFrames = 1024;  //!< Frames per block (close to what is decoded for each packet)
+
+//! Create filters with logarithmically spaced frequencies (20Hz to 20kHz) and alternating gains
+std::vector<model::AudioFilter> CreateFilters(int bands) {
+  std::vector<model::AudioFilter> filters;
+  filters.reserve(bands);
+
+  for (int i = 0; i < bands; i++) {
+    double frequency = 20.0 * std::pow(1000.0, static_cast<double>(i) / (bands - 1));
+    double gain = (i % 2 ? -3.0 : 3.0);
+    filters.push_back(model::AudioFilter{.frequency = frequency, .Q = 1.41, .gain = gain});
+  }
+
+  return filters;
+}
+
+//! Create interleaved stereo block with white noise
+std::vector<int16_t> CreateBlock() {
+  std::vector<int16_t> block(kFrames * kChannels);
+  uint32_t seed = 42;
+
+  for (auto& sample : block) {
+    seed = seed * 1664525u + 1013904223u;
+    sample = static_cast<int16_t>(seed >> 20);
+  }
+
+  return block;
+}
+
+/* ********************************************************************************************** */
+
+void BM_NativeEqualizer(benchmark::State& state) {
+  audio::Equalizer equalizer(kSampleRate);
+  equalizer.SetFilters(CreateFilters(static_cast<int>(state.range(0))));
+
+  const auto input = CreateBlock();
+  std::vector<int16_t> block(input.size());
+
+  for (auto _ : state) {
+    std::memcpy(block.data(), input.data(), input.size() * sizeof(int16_t));
+    equalizer.Process(block.data(), kFrames);
+    benchmark::DoNotOptimize(block.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kFrames);
+}
+
+/* ********************************************************************************************** */
+
+//! Same filter chain created by driver::FFmpeg: abuffer -> equalizer (one per band) -> abuffersink
+class FilterGraph {
+ public:
+  explicit FilterGraph(const std::vector<model::AudioFilter>& filters)
+      : graph_{avfilter_graph_alloc()} {
+    AVFilterContext* previous = Create("abuffer", "src",
+                                       "sample_rate=44100:sample_fmt=s16:channel_layout=stereo:"
+                                       "time_base=1/44100");
+    source_ = previous;
+
+    for (size_t i = 0; i < filters.size(); i++) {
+      std::string args = "frequency=" + std::to_string(filters[i].frequency) +
+                         ":width_type=q:width=" + std::to_string(filters[i].Q) +
+                         ":gain=" + std::to_string(filters[i].gain) +
+                         ":transform=dii:precision=auto";
+
+      AVFilterContext* equalizer = Create("equalizer", "equalizer_" + std::to_string(i), args);
+      avfilter_link(previous, 0, equalizer, 0);
+      previous = equalizer;
+    }
+
+    AVFilterContext* aformat = Create("aformat", "aformat", "sample_fmts=s16");
+    avfilter_link(previous, 0, aformat, 0);
+
+    sink_ = Create("abuffersink", "sink", "");
+    avfilter_link(aformat, 0, sink_, 0);
+
+    avfilter_graph_config(graph_, nullptr);
+  }
+
+  ~FilterGraph() { avfilter_graph_free(&graph_); }
+
+  //! Send block through filter chain and drain all filtered frames
+  void Process(AVFrame* input, AVFrame* output) {
+    av_buffersrc_add_frame_flags(source_, input, AV_BUFFERSRC_FLAG_KEEP_REF);
+
+    while (av_buffersink_get_frame(sink_, output) >= 0) {
+      benchmark::DoNotOptimize(output->data[0]);
+      av_frame_unref(output);
+    }
+  }
+
+ private:
+  AVFilterContext* Create(const char* filter, const std::string& name, const std::string& args) {
+    AVFilterContext* context = nullptr;
+    avfilter_graph_create_filter(&context, avfilter_get_by_name(filter), name.c_str(),
+                                 args.c_str(), nullptr, graph_);
+    return context;
+  }
+
+  AVFilterGraph* graph_;
+  AVFilterContext* source_ = nullptr;
+  AVFilterContext* sink_ = nullptr;
+};
+
+void BM_FilterGraphEqualizer(benchmark::State& state) {
+  FilterGraph graph(CreateFilters(static_cast<int>(state.range(0))));
+
+  const auto block = CreateBlock();
+
+  AVFrame* input = av_frame_alloc();
+  input->format = AV_SAMPLE_FMT_S16;
+  input->sample_rate = kSampleRate;
+  input->nb_samples = kFrames;
+#if LIBAVUTIL_VERSION_MAJOR > 56
+  av_channel_layout_default(&input->ch_layout, kChannels);
+#else
+  input->channel_layout = AV_CH_LAYOUT_STEREO;
+  input->channels = kChannels;
+#endif
+  av_frame_get_buffer(input, 0);
+
+  AVFrame* output = av_frame_alloc();
+  int64_t pts = 0;
+
+  for (auto _ : state) {
+    av_frame_make_writable(input);
+    std::memcpy(input->data[0], block.data(), block.size() * sizeof(int16_t));
+    input->pts = pts;
+    pts += kFrames;
+
+    graph.Process(input, output);
+  }
+
+  state.SetItemsProcessed(state.iterations() * kFrames);
+
+  av_frame_free(&output);
+  av_frame_free(&input);
+}
+
+/* ********************************************************************************************** */
+
+BENCHMARK(BM_NativeEqualizer)->Arg(10)->Arg(31)->Arg(64);
+BENCHMARK(BM_FilterGraphEqualizer)->Arg(10)->Arg(31)->Arg(64);
+
+}  // namespace
@@ -0,0 +1,74 @@
+#include <benchmark/benchmark.h>
+
+#include <cstdint>
+#include <vector>
+
+#include "audio/driver/alsa.h"
+#include "audio/pcm_ring.h"
+#include "model/application_error.h"
+#include "model/audio_format.h"
+#include "model/playback_settings.h"
+
+namespace {
+
+/* ********************************************************************************************** */
+
+/**
+ * @brief Emulate playback writer thread from Player, moving samples from decode-ahead buffer into
+ * ALSA "null" plugin (which discards them immediately, so only the cost from writing is measured).
+ * Argument selects access mode: 0 for regular writes (snd_pcm_writei) and 1 for mmap.
+ */
+void BM_AlsaWrite(benchmark::State& state) {
+  const bool mmap = state.range(0) == 1;
+  const model::AudioFormat format;
+
+  driver::Alsa alsa(model::PlaybackSettings{.device = "null", .mmap = mmap});
+
+  if (alsa.CreatePlaybackStream() != error::kSuccess ||
+      alsa.ConfigureParameters(format) != error::kSuccess || alsa.Prepare() != error::kSuccess) {
+    state.SkipWithError("Cannot open playback stream on ALSA null device");
+    return;
+  }
+
+  if (alsa.GetSettings().mmap != mmap) {
+    state.SkipWithError("ALSA null device does not support mmap access");
+    return;
+  }
+
+  const int period = static_cast<int>(alsa.GetPeriodSize());
+  const std::vector<uint8_t> block(static_cast<size_t>(period) * format.GetFrameSize(), 0x5A);
+
+  audio::PcmRing ring(period * 4, format.GetFrameSize());
+  std::vector<uint8_t> buffer(block.size());
+  int64_t frames = 0;
+
+  for (auto _ : state) {
+    ring.Write(block.data(), period);
+
+    while (!ring.Empty()) {
+      int available = ring.Size();
+      void* area = alsa.BeginDirectWrite(available);
+
+      if (area != nullptr) {
+        // Single copy: from decode-ahead buffer straight into device buffer
+        int read = ring.Read(area, available);
+        alsa.CommitDirectWrite(read);
+        frames += read;
+      } else {
+        // Two copies: from decode-ahead buffer into writer buffer, and then into device buffer
+        int read = ring.Read(buffer.data(), period);
+        alsa.AudioCallback(buffer.data(), read);
+        frames += read;
+      }
+    }
+  }
+
+  state.SetItemsProcessed(frames);
+  state.SetBytesProcessed(frames * format.GetFrameSize());
+}
+
+/* ********************************************************************************************** */
+
+BENCHMARK(BM_AlsaWrite)->ArgName("mmap")->Arg(0)->Arg(1);
+
+}  // namespace
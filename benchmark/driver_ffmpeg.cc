@@ -0,0 +1,194 @@
+extern "C" {
+#include <libavcodec/avcodec.h>
+#include <libavformat/avformat.h>
+#include <libavutil/channel_layout.h>
+#include <libavutil/version.h>
+}
+
+#include <benchmark/benchmark.h>
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "audio/driver/ffmpeg.h"
+#include "model/application_error.h"
+#include "model/audio_format.h"
+#include "model/input_settings.h"
+#include "model/song.h"
+
+namespace {
+
+constexpr int kSampleRate = 192000;
+constexpr int kChannels = 2;
+constexpr int kDuration = 60;  //!< Song duration (in seconds)
+constexpr int kPeriod = 1024;  //!< Frames per read (same as Player, when period size is unknown)
+
+//! Send frame to encoder (or flush it, when frame is null) and write all encoded packets to file
+void WritePackets(AVCodecContext* encoder, AVFrame* frame, AVPacket* packet,
+                  AVFormatContext* output) {
+  avcodec_send_frame(encoder, frame);
+
+  while (avcodec_receive_packet(encoder, packet) >= 0) {
+    av_packet_rescale_ts(packet, encoder->time_base, output->streams[0]->time_base);
+    av_interleaved_write_frame(output, packet);
+  }
+}
+
+//! Encode a high-resolution FLAC file (24-bit/192kHz stereo) with a sweep and some noise
+bool EncodeFlac(const std::string& filepath) {
+  AVFormatContext* output = nullptr;
+  if (avformat_alloc_output_context2(&output, nullptr, "flac", filepath.c_str()) < 0) return false;
+
+  const AVCodec* codec = avcodec_find_encoder(AV_CODEC_ID_FLAC);
+  AVStream* stream = avformat_new_stream(output, nullptr);
+  AVCodecContext* encoder = avcodec_alloc_context3(codec);
+
+  encoder->sample_fmt = AV_SAMPLE_FMT_S32;
+  encoder->bits_per_raw_sample = 24;
+  encoder->sample_rate = kSampleRate;
+  encoder->time_base = AVRational{1, kSampleRate};
+#if LIBAVUTIL_VERSION_MAJOR > 56
+  av_channel_layout_default(&encoder->ch_layout, kChannels);
+#else
+  encoder->channel_layout = AV_CH_LAYOUT_STEREO;
+  encoder->channels = kChannels;
+#endif
+
+  bool success = avcodec_open2(encoder, codec, nullptr) >= 0 &&
+                 avcodec_parameters_from_context(stream->codecpar, encoder) >= 0 &&
+                 avio_open(&output->pb, filepath.c_str(), AVIO_FLAG_WRITE) >= 0 &&
+                 avformat_write_header(output, nullptr) >= 0;
+
+  AVFrame* frame = av_frame_alloc();
+  AVPacket* packet = av_packet_alloc();
+
+  if (success) {
+    frame->format = encoder->sample_fmt;
+    frame->nb_samples = encoder->frame_size;
+#if LIBAVUTIL_VERSION_MAJOR > 56
+    av_channel_layout_copy(&frame->ch_layout, &encoder->ch_layout);
+#else
+    frame->channel_layout = encoder->channel_layout;
+    frame->channels = kChannels;
+#endif
+    av_frame_get_buffer(frame, 0);
+
+    const int64_t total = static_cast<int64_t>(kDuration) * kSampleRate;
+    uint32_t seed = 42;
+
+    for (int64_t pts = 0; pts < total; pts += frame->nb_samples) {
+      av_frame_make_writable(frame);
+      frame->nb_samples = static_cast<int>(std::min<int64_t>(encoder->frame_size, total - pts));
+      frame->pts = pts;
+
+      auto samples = reinterpret_cast<int32_t*>(frame->data[0]);
+
+      for (int i = 0; i < frame->nb_samples; i++) {
+        double time = static_cast<double>(pts + i) / kSampleRate;
+        double sweep = std::sin(2 * M_PI * (100 + 100 * time) * time);
+
+        for (int c = 0; c < kChannels; c++) {
+          seed = seed * 1664525u + 1013904223u;
+          int32_t noise = static_cast<int32_t>(seed >> 16) - 32768;
+
+          // 24-bit samples are stored in the most significant bits
+          auto value = static_cast<int32_t>(sweep * 4000000) + noise;
+          samples[i * kChannels + c] = value * 256;
+        }
+      }
+
+      WritePackets(encoder, frame, packet, output);
+    }
+
+    WritePackets(encoder, nullptr, packet, output);
+    success = av_write_trailer(output) >= 0;
+  }
+
+  av_packet_free(&packet);
+  av_frame_free(&frame);
+  avcodec_free_context(&encoder);
+  avio_closep(&output->pb);
+  avformat_free_context(output);
+
+  return success;
+}
+
+//! Get path to FLAC file, created only once for all benchmarks (empty in case of error)
+const std::string& GetFlacFile() {
+  static const std::string filepath = [] {
+    auto path = (std::filesystem::temp_directory_path() / "spectrum_benchmark.flac").string();
+    return EncodeFlac(path) ? path : std::string{};
+  }();
+
+  return filepath;
+}
+
+/* ********************************************************************************************** */
+
+/**
+ * @brief Decode whole song from a large FLAC file, just like Player does. Argument selects thread
+ * budget for decoder, and "rtf" counter is the real-time factor (seconds of audio decoded for each
+ * second elapsed)
+ */
+void BM_FFmpegDecodeFlac(benchmark::State& state) {
+  const std::string& filepath = GetFlacFile();
+
+  if (filepath.empty()) {
+    state.SkipWithError("Cannot create FLAC file to decode");
+    return;
+  }
+
+  driver::FFmpeg decoder(false, model::InputSettings{
+                                    .threads = static_cast<uint32_t>(state.range(0)),
+                                });
+
+  // Same format as the song, so filter chain is skipped
+  const model::AudioFormat format{
+      .sample_format = model::AudioFormat::SampleFormat::S32,
+      .sample_rate = kSampleRate,
+      .channels = kChannels,
+  };
+
+  decoder.SetOutputFormat(format);
+
+  std::vector<uint8_t> buffer(static_cast<size_t>(kPeriod) * format.GetFrameSize());
+  int64_t decoded = 0;
+
+  for (auto _ : state) {
+    model::Song song{.filepath = filepath};
+
+    if (decoder.OpenFile(song) != error::kSuccess) {
+      state.SkipWithError("Cannot open FLAC file to decode");
+      break;
+    }
+
+    int frames;
+    int64_t position;
+
+    do {
+      frames = kPeriod;
+      decoder.Read(buffer.data(), frames, position);
+      decoded += frames;
+    } while (frames > 0);
+
+    decoder.ClearCache();
+  }
+
+  state.SetItemsProcessed(decoded);
+  state.counters["rtf"] =
+      benchmark::Counter(static_cast<double>(decoded) / kSampleRate, benchmark::Counter::kIsRate);
+}
+
+/* ********************************************************************************************** */
+
+BENCHMARK(BM_FFmpegDecodeFlac)
+    ->ArgName("threads")
+    ->DenseRange(1, 8)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
+
+}  // namespace
@@ -0,0 +1,173 @@
+#include <benchmark/benchmark.h>
+#include <fftw3.h>
+#include <malloc.h>
+
+#include <cmath>
+#include <cstring>
+#include <vector>
+
+#include "audio/driver/fftw.h"
+
+namespace {
+
+constexpr int kSampleRate = 44100;
+constexpr int kFrames = 1024;  //!< Frames per block (close to what is decoded for each packet)
+constexpr int kNumberBars = 10;
+
+constexpr int kBufferSizes[] = {8192, 4096, 1024};  //!< Bass, mid and treble ranges
+
+//! Get memory currently allocated from heap, including large blocks allocated with mmap
+size_t GetHeapUsage() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+//! Create planar stereo block with two sine waves (200Hz in left channel and 2kHz in right)
+void CreateBlock(std::vector<float>& left, std::vector<float>& right) {
+  left.resize(kFrames);
+  right.resize(kFrames);
+
+  for (int i = 0; i < kFrames; i++) {
+    left[i] = static_cast<float>(std::sin(2 * M_PI * 200 * i / kSampleRate) * 20000);
+    right[i] = static_cast<float>(std::sin(2 * M_PI * 2000 * i / kSampleRate) * 20000);
+  }
+}
+
+/* ********************************************************************************************** */
+
+/**
+ * @brief Same analysis as it used to be done by driver::FFTW: double precision buffers and one
+ * plan per channel for each audio range (so six transforms for every block)
+ */
+class DoublePrecisionAnalysis {
+  struct Range {
+    int size;
+    double* multiplier;
+    double* in_left;
+    double* in_right;
+    fftw_complex* out_left;
+    fftw_complex* out_right;
+    fftw_plan plan_left;
+    fftw_plan plan_right;
+  };
+
+ public:
+  DoublePrecisionAnalysis()
+      : history_left_(kBufferSizes[0], 0), history_right_(kBufferSizes[0], 0) {
+    for (int size : kBufferSizes) {
+      Range range{.size = size};
+
+      range.multiplier = fftw_alloc_real(size);
+      range.in_left = fftw_alloc_real(size);
+      range.in_right = fftw_alloc_real(size);
+      range.out_left = fftw_alloc_complex(size / 2 + 1);
+      range.out_right = fftw_alloc_complex(size / 2 + 1);
+
+      range.plan_left = fftw_plan_dft_r2c_1d(size, range.in_left, range.out_left, FFTW_MEASURE);
+      range.plan_right = fftw_plan_dft_r2c_1d(size, range.in_right, range.out_right, FFTW_MEASURE);
+
+      for (int i = 0; i < size; i++) {
+        range.multiplier[i] = 0.5 * (1 - std::cos(2 * M_PI * i / (size - 1)));
+      }
+
+      ranges_.push_back(range);
+    }
+  }
+
+  ~DoublePrecisionAnalysis() {
+    for (auto& range : ranges_) {
+      fftw_destroy_plan(range.plan_left);
+      fftw_destroy_plan(range.plan_right);
+      fftw_free(range.multiplier);
+      fftw_free(range.in_left);
+      fftw_free(range.in_right);
+      fftw_free(range.out_left);
+      fftw_free(range.out_right);
+    }
+  }
+
+  void Execute(const float* left, const float* right, int frames) {
+    int kept = static_cast<int>(history_left_.size()) - frames;
+    std::memmove(history_left_.data(), history_left_.data() + frames, sizeof(double) * kept);
+    std::memmove(history_right_.data(), history_right_.data() + frames, sizeof(double) * kept);
+
+    for (int i = 0; i < frames; i++) {
+      history_left_[kept + i] = left[i];
+      history_right_[kept + i] = right[i];
+    }
+
+    for (auto& range : ranges_) {
+      int offset = static_cast<int>(history_left_.size()) - range.size;
+
+      for (int j = 0; j < range.size; j++) {
+        range.in_left[j] = range.multiplier[j] * history_left_[offset + j];
+        range.in_right[j] = range.multiplier[j] * history_right_[offset + j];
+      }
+
+      fftw_execute(range.plan_left);
+      fftw_execute(range.plan_right);
+
+      benchmark::DoNotOptimize(range.out_left);
+      benchmark::DoNotOptimize(range.out_right);
+    }
+  }
+
+ private:
+  std::vector<double> history_left_, history_right_;
+  std::vector<Range> ranges_;
+};
+
+/* ********************************************************************************************** */
+
+/**
+ * @brief Windowing and FFT as it used to be done, using double precision and one plan per channel.
+ * The "bytes" counter is the memory used by input history, windows and FFTW buffers/plans
+ */
+void BM_DoublePrecisionAnalysis(benchmark::State& state) {
+  size_t heap = GetHeapUsage();
+  DoublePrecisionAnalysis analysis;
+  heap = GetHeapUsage() - heap;
+
+  std::vector<float> left, right;
+  CreateBlock(left, right);
+
+  for (auto _ : state) {
+    analysis.Execute(left.data(), right.data(), kFrames);
+  }
+
+  state.SetItemsProcessed(state.iterations() * kFrames);
+  state.counters["bytes"] = static_cast<double>(heap);
+}
+
+/* ********************************************************************************************** */
+
+/**
+ * @brief Complete audio analysis from driver::FFTW, using single precision and a single plan to
+ * transform both channels. The "bytes" counter is the memory used by the whole analyzer
+ */
+void BM_FftwExecute(benchmark::State& state) {
+  size_t heap = GetHeapUsage();
+  driver::FFTW analyzer;
+  analyzer.Init(kNumberBars * 2);
+  heap = GetHeapUsage() - heap;
+
+  std::vector<float> left, right;
+  CreateBlock(left, right);
+
+  std::vector<double> out(analyzer.GetOutputSize());
+
+  for (auto _ : state) {
+    analyzer.Execute(left.data(), right.data(), kFrames, out.data());
+    benchmark::DoNotOptimize(out.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * kFrames);
+  state.counters["bytes"] = static_cast<double>(heap);
+}
+
+/* ********************************************************************************************** */
+
+BENCHMARK(BM_DoublePrecisionAnalysis)->Unit(benchmark::kMicrosecond);
+BENCHMARK(BM_FftwExecute)->Unit(benchmark::kMicrosecond);
+
+}  // namespace
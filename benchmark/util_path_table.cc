@@ -0,0 +1,110 @@
+#include <benchmark/benchmark.h>
+#include <malloc.h>
+
+#include <algorithm>
+#include <cctype>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+#include "util/path_table.h"
+
+namespace {
+
+constexpr char kDirectory[] = "/home/user/music/";  //!< Parent directory for all entries
+constexpr char kTextToSearch[] = "track 4217";      //!< Matches only a handful of entries
+
+//! Get filename for entry at informed index, just like a big directory with songs
+std::string GetFilename(int index) {
+  return "Artist " + std::to_string(index % 1000) + " - Track " + std::to_string(index) + ".flac";
+}
+
+//! Get memory currently allocated from heap, including large blocks allocated with mmap
+size_t GetHeapUsage() {
+  struct mallinfo2 info = mallinfo2();
+  return info.uordblks + info.hblkhd;
+}
+
+/* ********************************************************************************************** */
+
+/**
+ * @brief Search mode as it used to be done by ListDirectory: the filtered list is a copy from all
+ * paths matching the text to search. Argument is the number of entries in directory, and "bytes"
+ * counter is the memory used by the list of entries
+ */
+void BM_PathVectorSearch(benchmark::State& state) {
+  size_t heap = GetHeapUsage();
+  std::vector<std::filesystem::path> files;
+
+  for (int i = 0; i < state.range(0); i++) {
+    files.emplace_back(kDirectory + GetFilename(i));
+  }
+
+  heap = GetHeapUsage() - heap;
+
+  const std::string text{kTextToSearch};
+  auto compare = [](char a, char b) { return std::tolower(a) == std::tolower(b); };
+
+  for (auto _ : state) {
+    std::vector<std::filesystem::path> result;
+
+    for (const auto& file : files) {
+      const std::string filename = file.filename().string();
+
+      if (std::search(filename.begin(), filename.end(), text.begin(), text.end(), compare) !=
+          filename.end()) {
+        result.push_back(file);
+      }
+    }
+
+    benchmark::DoNotOptimize(result.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["bytes"] = static_cast<double>(heap);
+}
+
+/* ********************************************************************************************** */
+
+/**
+ * @brief Search mode using PathTable: filenames are compared in place, and the filtered list is
+ * only a vector of indexes. Argument is the number of entries in directory, and "bytes" counter is
+ * the memory used by the list of entries
+ */
+void BM_PathTableSearch(benchmark::State& state) {
+  size_t heap = GetHeapUsage();
+  util::PathTable table;
+
+  for (int i = 0; i < state.range(0); i++) {
+    table.emplace_back(kDirectory + GetFilename(i), false);
+  }
+
+  table.shrink_to_fit();
+  heap = GetHeapUsage() - heap;
+
+  for (auto _ : state) {
+    auto result = table.find(kTextToSearch);
+    benchmark::DoNotOptimize(result.data());
+  }
+
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+  state.counters["bytes"] = static_cast<double>(heap);
+}
+
+/* ********************************************************************************************** */
+
+BENCHMARK(BM_PathVectorSearch)
+    ->ArgName("entries")
+    ->RangeMultiplier(10)
+    ->Range(10000, 1000000)
+    ->Unit(benchmark::kMicrosecond);
+
+BENCHMARK(BM_PathTableSearch)
+    ->ArgName("entries")
+    ->RangeMultiplier(10)
+    ->Range(10000, 1000000)
+    ->Unit(benchmark::kMicrosecond);
+
+}  // namespace
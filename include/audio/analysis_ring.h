@@ -0,0 +1,224 @@
+/**
+ * \file
+ * \brief  Class for a lock-free ring buffer holding audio samples for analysis
+ */
+
+#ifndef INCLUDE_AUDIO_ANALYSIS_RING_H_
+#define INCLUDE_AUDIO_ANALYSIS_RING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include "audio/deinterleaver.h"
+#include "model/pcm_block.h"
+
+namespace audio {
+
+/**
+ * @brief Fixed-capacity single-producer/single-consumer ring buffer for audio analysis. Audio
+ * thread (producer) writes interleaved samples, which are split into planar channels right away,
+ * and analysis thread (consumer) reads them in the same layout used by the analyzer. Nothing is
+ * allocated after construction, and none of these operations will ever block on each other.
+ *
+ * Unlike PcmRing, producer never waits for space: when consumer falls behind, the oldest frames
+ * are overwritten and counted as dropped. As producer never touches the read index, consumer
+ * validates each read afterwards (same approach as a seqlock), and discards whatever was
+ * overwritten while copying.
+ */
+class AnalysisRing {
+ public:
+  /**
+   * @brief Construct a new AnalysisRing object
+   * @param capacity Maximum number of frames to hold
+   */
+  explicit AnalysisRing(int capacity)
+      : capacity_{capacity},
+        deinterleaver_{},
+        left_(capacity),
+        right_(capacity),
+        write_index_{0},
+        claim_index_{0},
+        read_index_{0},
+        dropped_{0} {}
+
+  /**
+   * @brief Destroy the AnalysisRing object
+   */
+  virtual ~AnalysisRing() = default;
+
+  //! Remove these
+  AnalysisRing(const AnalysisRing& other) = delete;             // copy constructor
+  AnalysisRing(AnalysisRing&& other) = delete;                  // move constructor
+  AnalysisRing& operator=(const AnalysisRing& other) = delete;  // copy assignment
+  AnalysisRing& operator=(AnalysisRing&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Producer side
+
+  /**
+   * @brief Convert samples from block and append them into ring buffer, overwriting the oldest
+   * frames if there is not enough space (must be called only by producer)
+   * @param block Interleaved audio samples
+   */
+  void Write(const model::PcmBlock& block) {
+    if (block.data == nullptr || block.frames <= 0) return;
+
+    auto data = static_cast<const uint8_t*>(block.data);
+    int frame_size = block.format.GetFrameSize();
+    int frames = block.frames;
+
+    // Only the most recent frames fit into ring buffer
+    if (frames > capacity_) {
+      dropped_.fetch_add(frames - capacity_, std::memory_order_relaxed);
+      data += static_cast<size_t>(frames - capacity_) * frame_size;
+      frames = capacity_;
+    }
+
+    uint64_t write = write_index_.load(std::memory_order_relaxed);
+
+    // Announce which frames are about to be overwritten, before touching any of them
+    claim_index_.store(write + frames, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    int offset = static_cast<int>(write % capacity_);
+    int first = std::min(frames, capacity_ - offset);
+
+    model::PcmBlock part = block;
+    part.data = data;
+    part.frames = first;
+    deinterleaver_.Process(part, &left_[offset], &right_[offset]);
+
+    // Wrap around internal storage
+    part.data = data + static_cast<size_t>(first) * frame_size;
+    part.frames = frames - first;
+    deinterleaver_.Process(part, &left_[0], &right_[0]);
+
+    write_index_.store(write + frames, std::memory_order_release);
+  }
+
+  /* ******************************************************************************************** */
+  //! Consumer side
+
+  /**
+   * @brief Copy the oldest frames available from ring buffer (must be called only by consumer)
+   * @param left Output buffer for left channel
+   * @param right Output buffer for right channel
+   * @param frames Maximum number of frames to read
+   * @return int Number of frames read
+   */
+  int Read(float* left, float* right, int frames) {
+    uint64_t read = read_index_.load(std::memory_order_relaxed);
+    int count = 0;
+
+    while (true) {
+      uint64_t write = write_index_.load(std::memory_order_acquire);
+
+      // Producer has already overwritten the oldest frames not read yet
+      if (write - read > static_cast<uint64_t>(capacity_)) {
+        Drop(read, write - capacity_);
+      }
+
+      count = std::min(frames, static_cast<int>(write - read));
+      if (count <= 0) {
+        count = 0;
+        break;
+      }
+
+      CopyOut(static_cast<int>(read % capacity_), count, left, right);
+
+      // Frames copied are valid only if producer did not start to overwrite them in the meantime
+      std::atomic_thread_fence(std::memory_order_acquire);
+      uint64_t claim = claim_index_.load(std::memory_order_relaxed);
+
+      if (claim <= read + capacity_) break;
+
+      Drop(read, claim - capacity_);
+    }
+
+    read_index_.store(read + count, std::memory_order_release);
+    return count;
+  }
+
+  /**
+   * @brief Discard the oldest frames, keeping only the most recent ones (must be called only by
+   * consumer). Frames already overwritten by producer are counted as dropped, not as skipped.
+   * @param frames Maximum number of frames to keep
+   * @return int Number of frames skipped
+   */
+  int Keep(int frames) {
+    uint64_t read = read_index_.load(std::memory_order_relaxed);
+    uint64_t write = write_index_.load(std::memory_order_acquire);
+
+    if (write - read > static_cast<uint64_t>(capacity_)) {
+      Drop(read, write - capacity_);
+    }
+
+    int skipped = std::max(static_cast<int>(write - read) - frames, 0);
+
+    read_index_.store(read + skipped, std::memory_order_release);
+    return skipped;
+  }
+
+  /**
+   * @brief Discard all frames from ring buffer (must be called only by consumer)
+   */
+  void Clear() {
+    read_index_.store(write_index_.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  /* ******************************************************************************************** */
+  //! Getters (safe to call from any thread)
+
+  //! Number of frames currently stored in ring buffer
+  int Size() const {
+    uint64_t stored = write_index_.load(std::memory_order_acquire) -
+                      read_index_.load(std::memory_order_acquire);
+    return static_cast<int>(std::min(stored, static_cast<uint64_t>(capacity_)));
+  }
+
+  //! Maximum number of frames
+  int Capacity() const { return capacity_; }
+
+  //! Total number of frames overwritten before consumer could read them
+  uint64_t Dropped() const { return dropped_.load(std::memory_order_relaxed); }
+
+  /* ******************************************************************************************** */
+  //! Utilities
+ private:
+  //! Skip frames overwritten by producer, moving read index forward (only called by consumer)
+  void Drop(uint64_t& read, uint64_t until) {
+    dropped_.fetch_add(until - read, std::memory_order_relaxed);
+    read = until;
+  }
+
+  //! Copy frames from ring buffer, wrapping around when reaching the end
+  void CopyOut(int offset, int count, float* left, float* right) const {
+    int first = std::min(count, capacity_ - offset);
+    std::memcpy(left, &left_[offset], first * sizeof(float));
+    std::memcpy(right, &right_[offset], first * sizeof(float));
+    std::memcpy(left + first, &left_[0], (count - first) * sizeof(float));
+    std::memcpy(right + first, &right_[0], (count - first) * sizeof(float));
+  }
+
+  /* ******************************************************************************************** */
+  //! Variables
+ private:
+  const int capacity_;  //!< Maximum number of frames
+
+  Deinterleaver deinterleaver_;  //!< Split audio samples by channel (used by producer)
+  std::vector<float> left_;      //!< Raw storage for left channel
+  std::vector<float> right_;     //!< Raw storage for right channel
+
+  //! Monotonic frame counters (kept in separate cache lines to avoid false sharing)
+  alignas(64) std::atomic<uint64_t> write_index_;  //!< Total frames written by producer
+  std::atomic<uint64_t> claim_index_;              //!< Total frames being written by producer
+  alignas(64) std::atomic<uint64_t> read_index_;   //!< Total frames read by consumer
+
+  std::atomic<uint64_t> dropped_;  //!< Frames lost (overwritten or not even fitting into ring)
+};
+
+}  // namespace audio
+#endif  // INCLUDE_AUDIO_ANALYSIS_RING_H_
@@ -36,18 +36,26 @@ class Analyzer {
   virtual error::Code Init(int output_size) = 0;
 
   /**
-   * @brief Run FFT on input vector to get information about audio in the frequency domain
+   * @brief Set sample rate from audio data received for analysis
    *
-   * @param in Input vector with audio raw data (signal amplitude)
-   * @param size Input vector size
+   * @param sample_rate Number of frames per second
+   */
+  virtual error::Code SetSampleRate(int sample_rate) = 0;
+
+  /**
+   * @brief Run FFT on input to get information about audio in the frequency domain
+   *
+   * @param left Input samples from left channel (signal amplitude in signed 16-bit range)
+   * @param right Input samples from right channel (signal amplitude in signed 16-bit range)
+   * @param frames Number of samples per channel
    * @param out Output vector where each entry represents a frequency bar
    */
-  virtual error::Code Execute(double *in, int size, double *out) = 0;
+  virtual error::Code Execute(const float *left, const float *right, int frames, double *out) = 0;
 
   /**
    * @brief Get internal buffer size
    *
-   * @return Maximum size for input vector
+   * @return Maximum number of frames for input
    */
   virtual int GetBufferSize() = 0;
 
@@ -6,11 +6,12 @@
 #ifndef INCLUDE_AUDIO_BASE_DECODER_H_
 #define INCLUDE_AUDIO_BASE_DECODER_H_
 
-#include <functional>
+#include <cstdint>
 #include <vector>
 
 #include "model/application_error.h"
 #include "model/audio_filter.h"
+#include "model/audio_format.h"
 #include "model/song.h"
 #include "model/volume.h"
 
@@ -18,7 +19,7 @@ namespace driver {
 
 /**
  * @brief Common interface to read audio file as an input stream, decode it, apply biquad IIR
- * filters on extracted audio data and finally, send the result to audio callback
+ * filters on extracted audio data and finally, let the caller read the result whenever it needs
  */
 class Decoder {
  public:
@@ -35,12 +36,6 @@ class Decoder {
   /* ******************************************************************************************** */
   //! Public API for Decoder
 
-  /**
-   * @brief Function invoked after resample is available.
-   * (for better understanding: take a look at Audio Loop from Player, and also Playback class)
-   */
-  using AudioCallback = std::function<bool(void*, int, int64_t&)>;
-
   /**
    * @brief Open file as input stream and check for codec compatibility for decoding
    * @param audio_info (In/Out) In case of success, this is filled with detailed audio information
@@ -49,18 +44,37 @@ class Decoder {
   virtual error::Code OpenFile(model::Song& audio_info) = 0;
 
   /**
-   * @brief Decode and resample input stream to desired sample format/rate
-   * @param samples Maximum value of samples
-   * @param callback Pass resamples to this callback
+   * @brief Read next frames from input stream, already decoded and converted to the output audio
+   * format. Caller decides when and how much to read, and any frame decoded but not read yet is
+   * kept internally to be returned by the next call
+   * @param buffer Destination for interleaved samples (must fit the requested number of frames)
+   * @param frames (In/Out) Maximum number of frames to read, and then, number of frames actually
+   * read (zero means that song has reached its end)
+   * @param position (Out) Position in song (in milliseconds) of the first frame read
    * @return error::Code Application error code
    */
-  virtual error::Code Decode(int samples, AudioCallback callback) = 0;
+  virtual error::Code Read(void* buffer, int& frames, int64_t& position) = 0;
+
+  /**
+   * @brief Seek exact position in song, so the next read starts right from it
+   * @param position Position in song (in milliseconds)
+   * @return error::Code Application error code
+   */
+  virtual error::Code Seek(int64_t position) = 0;
 
   /**
    * @brief After file is opened and decoded, or when some error occurs, always clear internal cache
    */
   virtual void ClearCache() = 0;
 
+  /**
+   * @brief Set audio format for decoded samples returned by Read (in case that some file is already
+   * opened, it takes effect immediately)
+   * @param format Audio format negotiated with playback
+   * @return error::Code Application error code
+   */
+  virtual error::Code SetOutputFormat(const model::AudioFormat& format) = 0;
+
   /* ******************************************************************************************** */
   //! Public API for Equalizer TODO: split into a new header along with FFmpeg class
 
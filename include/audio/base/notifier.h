@@ -6,6 +6,7 @@
 #ifndef INCLUDE_AUDIO_BASE_NOTIFIER_H_
 #define INCLUDE_AUDIO_BASE_NOTIFIER_H_
 
+#include <chrono>
 #include <filesystem>
 #include <vector>
 
@@ -77,11 +78,31 @@ class Notifier {
    */
   virtual void SeekBackwardPosition(int value) = 0;
 
+  /**
+   * @brief Notify Audio Player to seek an absolute position in current playing song
+   * @param position Exact position in song
+   */
+  virtual void SeekTo(std::chrono::milliseconds position) = 0;
+
   /**
    * @brief Notify Audio Player to apply audio filters in the audio chain
    * @param frequencies Vector of audio filters
    */
   virtual void ApplyAudioFilters(const std::vector<model::AudioFilter>& filters) = 0;
+
+  /**
+   * @brief Notify Audio Player about files that user will probably play soon, so it can open them
+   * in background
+   * @param files List of full paths to files (first one has the highest priority)
+   */
+  virtual void WarmUpFiles(const std::vector<std::filesystem::path>& files) = 0;
+
+  /**
+   * @brief Notify Audio Player about file to be played right after the current song, so it can
+   * continue without any gap between them
+   * @param file Full path to file (empty to clear it)
+   */
+  virtual void SetNextSong(const std::filesystem::path& file) = 0;
 };
 
 }  // namespace interface
@@ -6,7 +6,12 @@
 #ifndef INCLUDE_AUDIO_BASE_PLAYBACK_H_
 #define INCLUDE_AUDIO_BASE_PLAYBACK_H_
 
+#include <cstdint>
+#include <vector>
+
 #include "model/application_error.h"
+#include "model/audio_format.h"
+#include "model/playback_settings.h"
 #include "model/volume.h"
 
 namespace driver {
@@ -29,17 +34,33 @@ class Playback {
   /* ******************************************************************************************** */
   //! Public API
 
+  /**
+   * @brief Sample formats and sample rates supported by playback stream
+   */
+  struct Capabilities {
+    std::vector<model::AudioFormat::SampleFormat> sample_formats;  //!< Supported sample formats
+    std::vector<uint32_t> sample_rates;                             //!< Supported sample rates
+  };
+
   /**
    * @brief Create a Playback Stream
    * @return error::Code Playback error converted to application error code
    */
   virtual error::Code CreatePlaybackStream() = 0;
 
+  /**
+   * @brief Get sample formats and sample rates supported by playback stream (must be called after
+   * playback stream is created)
+   * @return Capabilities Supported formats and rates
+   */
+  virtual Capabilities GetCapabilities() = 0;
+
   /**
    * @brief Configure Playback Stream parameters (sample format, etc...)
+   * @param format Audio format for samples written into playback stream
    * @return error::Code Playback error converted to application error code
    */
-  virtual error::Code ConfigureParameters() = 0;
+  virtual error::Code ConfigureParameters(const model::AudioFormat& format) = 0;
 
   /**
    * @brief Make playback stream ready to play
@@ -48,17 +69,30 @@ class Playback {
   virtual error::Code Prepare() = 0;
 
   /**
-   * @brief Pause current song on playback stream
+   * @brief Pause current song on playback stream (samples not played yet must be kept)
    * @return error::Code Playback error converted to application error code
    */
   virtual error::Code Pause() = 0;
 
   /**
-   * @brief Stop playing song on playback stream
+   * @brief Resume current song on playback stream, from exactly where it was paused
+   * @return error::Code Playback error converted to application error code
+   */
+  virtual error::Code Resume() = 0;
+
+  /**
+   * @brief Stop playing song on playback stream immediately, discarding samples not played yet
    * @return error::Code Playback error converted to application error code
    */
   virtual error::Code Stop() = 0;
 
+  /**
+   * @brief Stop playing song on playback stream only after all samples written were played (blocks
+   * until then, so it should be used only when song has finished naturally)
+   * @return error::Code Playback error converted to application error code
+   */
+  virtual error::Code Drain() = 0;
+
   /**
    * @brief Directly write audio buffer to playback stream (this should be called by decoder)
    *
@@ -68,6 +102,30 @@ class Playback {
    */
   virtual error::Code AudioCallback(void* buffer, int size) = 0;
 
+  /**
+   * @brief Get direct access to playback stream buffer, so samples can be written into it without
+   * any intermediate copy (blocks until there is space available in buffer)
+   *
+   * @param frames Maximum number of frames to write (updated with number of frames available)
+   * @return void* Address to write interleaved frames, or nullptr in case direct access is not
+   * available (in this case, AudioCallback must be used instead)
+   */
+  virtual void* BeginDirectWrite(int& frames) = 0;
+
+  /**
+   * @brief Commit frames written into the address returned by BeginDirectWrite
+   *
+   * @param frames Number of frames written
+   * @return error::Code Playback error converted to application error code
+   */
+  virtual error::Code CommitDirectWrite(int frames) = 0;
+
+  /**
+   * @brief Get playback latency, i.e. how many frames already written will still take to be heard
+   * @return int Number of frames queued in playback stream
+   */
+  virtual int GetDelay() = 0;
+
   /**
    * @brief Set volume on playback stream
    *
@@ -87,6 +145,12 @@ class Playback {
    * @return uint32_t Period size
    */
   virtual uint32_t GetPeriodSize() const = 0;
+
+  /**
+   * @brief Get settings from playback stream (including values negotiated with device)
+   * @return model::PlaybackSettings Playback settings
+   */
+  virtual model::PlaybackSettings GetSettings() const = 0;
 };
 
 }  // namespace driver
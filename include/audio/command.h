@@ -6,6 +6,7 @@
 #ifndef INCLUDE_AUDIO_COMMAND_H_
 #define INCLUDE_AUDIO_COMMAND_H_
 
+#include <chrono>
 #include <iostream>
 #include <string>
 #include <variant>
@@ -30,7 +31,9 @@ struct Command {
     SeekBackward = 8005,
     SetVolume = 8006,
     UpdateAudioFilters = 8007,
-    Exit = 8008,
+    SetNextSong = 8008,
+    Exit = 8009,
+    SeekTo = 8010,
   };
 
   //! Overloaded operators
@@ -51,13 +54,15 @@ struct Command {
   static Command Stop();
   static Command SeekForward(int offset);
   static Command SeekBackward(int offset);
+  static Command SeekTo(std::chrono::milliseconds position);
   static Command SetVolume(const model::Volume& value);
   static Command UpdateAudioFilters(const std::vector<model::AudioFilter>& filters);
+  static Command SetNextSong(const std::string& filepath);
   static Command Exit();
 
   //! Possible types for content
   using Content = std::variant<std::monostate, std::string, int, model::Volume,
-                               std::vector<model::AudioFilter>>;
+                               std::vector<model::AudioFilter>, std::chrono::milliseconds>;
 
   //! Getter for command identifier
   Identifier GetId() const { return id; }
@@ -72,6 +77,16 @@ struct Command {
     }
   }
 
+  //! Generic getter for command content, moving it out from command (avoids copying large content)
+  template <typename T>
+  T TakeContent() {
+    if (std::holds_alternative<T>(content)) {
+      return std::get<T>(std::move(content));
+    } else {
+      return T();
+    }
+  }
+
   //! Variables
   // P.S. removed private keyword, otherwise wouldn't be possible to use C++ brace initialization
   Identifier id;    //!< Unique type identifier for Command
@@ -0,0 +1,252 @@
+/**
+ * \file
+ * \brief  Class for a lock-free queue holding commands to audio player
+ */
+
+#ifndef INCLUDE_AUDIO_COMMAND_QUEUE_H_
+#define INCLUDE_AUDIO_COMMAND_QUEUE_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+
+#include "audio/command.h"
+
+namespace audio {
+
+/**
+ * @brief Bounded multi-producer/single-consumer queue for audio player commands. Any thread may
+ * push commands (without ever blocking), while only Audio thread (consumer) pops them. As Audio
+ * thread checks for new commands on every decoded chunk, an atomic flag tells whether there is
+ * something pending, so this costs a single load while queue is idle. Commands are always moved
+ * in and out of the queue, so their content is never copied.
+ */
+class CommandQueue {
+ public:
+  /**
+   * @brief Construct a new CommandQueue object
+   * @param capacity Maximum number of commands (must be a power of two)
+   */
+  explicit CommandQueue(size_t capacity = kDefaultCapacity)
+      : mask_{capacity - 1},
+        cells_{std::make_unique<Cell[]>(capacity)},
+        enqueue_{0},
+        dequeue_{0},
+        pending_{false} {
+    for (size_t i = 0; i < capacity; i++) cells_[i].sequence.store(i, std::memory_order_relaxed);
+  }
+
+  /**
+   * @brief Destroy the CommandQueue object
+   */
+  virtual ~CommandQueue() = default;
+
+  //! Remove these
+  CommandQueue(const CommandQueue& other) = delete;             // copy constructor
+  CommandQueue(CommandQueue&& other) = delete;                  // move constructor
+  CommandQueue& operator=(const CommandQueue& other) = delete;  // copy assignment
+  CommandQueue& operator=(CommandQueue&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Producer side
+
+  /**
+   * @brief Add command to the end of queue (safe to call from any thread)
+   * @param cmd Media command
+   * @return true if command was added, false if queue is full
+   */
+  bool Push(Command&& cmd) {
+    uint64_t position = enqueue_.load(std::memory_order_relaxed);
+    Cell* cell;
+
+    while (true) {
+      cell = &cells_[position & mask_];
+      uint64_t sequence = cell->sequence.load(std::memory_order_acquire);
+      auto diff = static_cast<int64_t>(sequence) - static_cast<int64_t>(position);
+
+      if (diff == 0) {
+        // Cell is free, try to reserve it (in case of failure, position is updated)
+        if (enqueue_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+          break;
+        }
+      } else if (diff < 0) {
+        // Consumer did not release this cell yet, so queue is full
+        return false;
+      } else {
+        // Another producer has already reserved this cell
+        position = enqueue_.load(std::memory_order_relaxed);
+      }
+    }
+
+    cell->cmd = std::move(cmd);
+    cell->sequence.store(position + 1, std::memory_order_release);
+
+    pending_.store(true, std::memory_order_release);
+    return true;
+  }
+
+  /* ******************************************************************************************** */
+  //! Consumer side
+
+  /**
+   * @brief Check if there is some command waiting to be popped (safe to call from any thread)
+   * @return true if queue may have some command, false if it is surely empty
+   */
+  bool Pending() const { return pending_.load(std::memory_order_acquire); }
+
+  /**
+   * @brief Pop command from the beginning of queue (must be called only by consumer), merging it
+   * with the next ones whenever possible:
+   * - Consecutive seek commands become a single seek with the net offset
+   * - Consecutive absolute seek commands become a single seek to the last position
+   * - Volume and audio filters are set only using the latest command from queue
+   * @return Media command (or None if queue is empty)
+   */
+  Command Pop() {
+    while (Command* front = Peek()) {
+      Command cmd = std::move(*front);
+      Discard();
+
+      switch (cmd.GetId()) {
+        case Command::Identifier::None:
+          // Cancelled by consumer, so simply ignore it
+          continue;
+
+        case Command::Identifier::SeekForward:
+        case Command::Identifier::SeekBackward: {
+          int offset = SeekOffset(cmd);
+
+          for (Command* next = Peek(); next != nullptr && SeekOffset(*next) != 0; next = Peek()) {
+            offset += SeekOffset(*next);
+            Discard();
+          }
+
+          // Seeks cancelled each other
+          if (offset == 0) continue;
+
+          cmd = offset > 0 ? Command::SeekForward(offset) : Command::SeekBackward(-offset);
+        } break;
+
+        case Command::Identifier::SeekTo:
+          // Only the last one from consecutive absolute seeks matters
+          for (Command* next = Peek(); next != nullptr && *next == cmd.GetId(); next = Peek()) {
+            cmd = std::move(*next);
+            Discard();
+          }
+          break;
+
+        case Command::Identifier::SetVolume:
+        case Command::Identifier::UpdateAudioFilters:
+          // There is a newer value waiting in queue, so skip this one
+          if (Find(cmd.GetId())) continue;
+          break;
+
+        default:
+          break;
+      }
+
+      return cmd;
+    }
+
+    return Command::None();
+  }
+
+  /**
+   * @brief Get command from queue without removing it (must be called only by consumer)
+   * @param index Position relative to the beginning of queue
+   * @return Pointer to command, or nullptr if there is no command published at this position
+   */
+  Command* Peek(size_t index = 0) {
+    uint64_t position = dequeue_ + index;
+    Cell& cell = cells_[position & mask_];
+
+    if (index > mask_ || cell.sequence.load(std::memory_order_acquire) != position + 1) {
+      return nullptr;
+    }
+
+    return &cell.cmd;
+  }
+
+  /**
+   * @brief Remove command from the beginning of queue, releasing its cell to producers (must be
+   * called only by consumer, after a successful Peek)
+   */
+  void Discard() {
+    Cell& cell = cells_[dequeue_ & mask_];
+    cell.cmd = Command::None();
+    cell.sequence.store(dequeue_ + mask_ + 1, std::memory_order_release);
+    dequeue_++;
+
+    // Clear flag only when queue looks empty, but check again in case some producer has just
+    // published a command (otherwise, it could be left unnoticed)
+    if (Peek() == nullptr) {
+      pending_.store(false, std::memory_order_relaxed);
+      std::atomic_thread_fence(std::memory_order_seq_cst);
+      if (Peek() != nullptr) pending_.store(true, std::memory_order_relaxed);
+    }
+  }
+
+  /**
+   * @brief Cancel every command currently in queue that does not match the given predicate (they
+   * are kept in place, but will be ignored by Pop)
+   * @param keep Predicate returning true for commands to be kept
+   */
+  void Retain(const std::function<bool(const Command&)>& keep) {
+    for (size_t i = 0; Command* cmd = Peek(i); i++) {
+      if (!keep(*cmd)) *cmd = Command::None();
+    }
+  }
+
+  /**
+   * @brief Remove every command from queue (must be called only by consumer)
+   */
+  void Clear() {
+    while (Peek() != nullptr) Discard();
+  }
+
+  /* ******************************************************************************************** */
+  //! Utilities
+ private:
+  //! Get seek offset with sign based on direction (or zero, if command is not a seek)
+  static int SeekOffset(const Command& cmd) {
+    if (cmd == Command::Identifier::SeekForward) return cmd.GetContent<int>();
+    if (cmd == Command::Identifier::SeekBackward) return -cmd.GetContent<int>();
+    return 0;
+  }
+
+  //! Check if there is some command with the given identifier in queue
+  bool Find(Command::Identifier id) {
+    for (size_t i = 0; Command* cmd = Peek(i); i++) {
+      if (*cmd == id) return true;
+    }
+
+    return false;
+  }
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+ public:
+  static constexpr size_t kDefaultCapacity = 64;  //!< Maximum number of commands in queue
+
+  /* ******************************************************************************************** */
+  //! Variables
+ private:
+  //! Slot for a single command, where sequence tells whether it is free or published
+  struct Cell {
+    std::atomic<uint64_t> sequence;  //!< Position for next push (free) or pop (published)
+    Command cmd = Command::None();   //!< Media command
+  };
+
+  const size_t mask_;              //!< Used to wrap position around capacity
+  std::unique_ptr<Cell[]> cells_;  //!< Storage for commands
+
+  //! Monotonic counters (kept in separate cache lines to avoid false sharing)
+  alignas(64) std::atomic<uint64_t> enqueue_;  //!< Next position to push (shared by producers)
+  alignas(64) uint64_t dequeue_;               //!< Next position to pop (owned by consumer)
+  alignas(64) std::atomic<bool> pending_;      //!< Queue may have some command to pop
+};
+
+}  // namespace audio
+#endif  // INCLUDE_AUDIO_COMMAND_QUEUE_H_
@@ -40,18 +40,28 @@ class DummyAnalyzer : public Analyzer {
   }
 
   /**
-   * @brief Run FFT on input vector to get information about audio in the frequency domain
+   * @brief Set sample rate from audio data received for analysis
    *
-   * @param in Input vector with audio raw data (signal amplitude)
-   * @param size Input vector size
+   * @param sample_rate Number of frames per second
+   */
+  error::Code SetSampleRate(int sample_rate) override { return error::kSuccess; }
+
+  /**
+   * @brief Run FFT on input to get information about audio in the frequency domain
+   *
+   * @param left Input samples from left channel (signal amplitude in signed 16-bit range)
+   * @param right Input samples from right channel (signal amplitude in signed 16-bit range)
+   * @param frames Number of samples per channel
    * @param out Output vector where each entry represents a frequency bar
    */
-  error::Code Execute(double *in, int size, double *out) override { return error::kSuccess; }
+  error::Code Execute(const float *left, const float *right, int frames, double *out) override {
+    return error::kSuccess;
+  }
 
   /**
    * @brief Get internal buffer size
    *
-   * @return Maximum size for input vector
+   * @return Maximum number of frames for input
    */
   int GetBufferSize() override { return kBufferSize; }
 
@@ -65,7 +75,7 @@ class DummyAnalyzer : public Analyzer {
   /* *********************************************************************************************/
   //! Default Constants
  private:
-  static constexpr int kBufferSize = 1024;  //!< Base size for buffers
+  static constexpr int kBufferSize = 512;  //!< Maximum number of frames for input
 
   /* ******************************************************************************************** */
   //! Variables
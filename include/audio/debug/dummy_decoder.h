@@ -6,7 +6,6 @@
 #ifndef INCLUDE_AUDIO_DEBUG_DUMMY_DECODER_H_
 #define INCLUDE_AUDIO_DEBUG_DUMMY_DECODER_H_
 
-#include <functional>
 #include <map>
 #include <vector>
 
@@ -36,12 +35,6 @@ class DummyDecoder : public Decoder {
   /* ******************************************************************************************** */
   //! Public API for Decoder
 
-  /**
-   * @brief Function invoked after resample is available.
-   * (for better understanding: take a look at Audio Loop from Player, and also Playback class)
-   */
-  using AudioCallback = std::function<bool(void*, int, int64_t&)>;
-
   /**
    * @brief Open file as input stream and check for codec compatibility for decoding
    * @param audio_info (In/Out) In case of success, this is filled with detailed audio information
@@ -60,13 +53,25 @@ class DummyDecoder : public Decoder {
   }
 
   /**
-   * @brief Decode and resample input stream to desired sample format/rate
-   * @param samples Maximum value of samples
-   * @param callback Pass resamples to this callback
+   * @brief Read next frames from input stream (as there is nothing to decode, song ends right away)
+   * @param buffer Destination for interleaved samples
+   * @param frames (In/Out) Maximum number of frames to read, and then, number of frames read
+   * @param position (Out) Position in song (in milliseconds) of the first frame read
    * @return error::Code Application error code
    */
-  error::Code Decode(int samples, AudioCallback callback) override {
-    callback((void*)nullptr, 0, position_);
+  error::Code Read(void* buffer, int& frames, int64_t& position) override {
+    frames = 0;
+    position = position_;
+    return error::kSuccess;
+  }
+
+  /**
+   * @brief Seek exact position in song
+   * @param position Position in song (in milliseconds)
+   * @return error::Code Application error code
+   */
+  error::Code Seek(int64_t position) override {
+    position_ = position;
     return error::kSuccess;
   }
 
@@ -75,6 +80,15 @@ class DummyDecoder : public Decoder {
    */
   void ClearCache() override {}
 
+  /**
+   * @brief Set audio format for decoded samples returned by Read
+   * @param format Audio format negotiated with playback
+   * @return error::Code Application error code
+   */
+  error::Code SetOutputFormat(const model::AudioFormat& format) override {
+    return error::kSuccess;
+  }
+
   /* ******************************************************************************************** */
   //! Public API for Equalizer
 
@@ -109,7 +123,7 @@ class DummyDecoder : public Decoder {
   //! Variables
  private:
   model::Volume volume_;  //!< Playback stream volume
-  int64_t position_;      //!< Audio position
+  int64_t position_ = 0;  //!< Audio position (in milliseconds)
 };
 
 }  // namespace driver
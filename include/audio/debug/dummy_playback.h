@@ -36,11 +36,20 @@ class DummyPlayback : public Playback {
    */
   error::Code CreatePlaybackStream() override { return error::kSuccess; }
 
+  /**
+   * @brief Get sample formats and sample rates supported by playback stream
+   * @return Capabilities Supported formats and rates
+   */
+  Capabilities GetCapabilities() override { return Capabilities{}; }
+
   /**
    * @brief Configure Playback Stream parameters (sample format, etc...)
+   * @param format Audio format for samples written into playback stream
    * @return error::Code Playback error converted to application error code
    */
-  error::Code ConfigureParameters() override { return error::kSuccess; }
+  error::Code ConfigureParameters(const model::AudioFormat& format) override {
+    return error::kSuccess;
+  }
 
   /**
    * @brief Make playback stream ready to play
@@ -54,12 +63,24 @@ class DummyPlayback : public Playback {
    */
   error::Code Pause() override { return error::kSuccess; }
 
+  /**
+   * @brief Resume current song on playback stream
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Resume() override { return error::kSuccess; }
+
   /**
    * @brief Stop playing song on playback stream
    * @return error::Code Playback error converted to application error code
    */
   error::Code Stop() override { return error::kSuccess; }
 
+  /**
+   * @brief Stop playing song on playback stream after all samples were played
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Drain() override { return error::kSuccess; }
+
   /**
    * @brief Directly write audio buffer to playback stream (this should be called by decoder)
    *
@@ -69,6 +90,28 @@ class DummyPlayback : public Playback {
    */
   error::Code AudioCallback(void* buffer, int size) override { return error::kSuccess; }
 
+  /**
+   * @brief Get direct access to playback stream buffer (not available)
+   *
+   * @param frames Maximum number of frames to write
+   * @return void* Always nullptr
+   */
+  void* BeginDirectWrite(int& frames) override { return nullptr; }
+
+  /**
+   * @brief Commit frames written into playback stream buffer
+   *
+   * @param frames Number of frames written
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code CommitDirectWrite(int frames) override { return error::kSuccess; }
+
+  /**
+   * @brief Get playback latency
+   * @return int Number of frames queued in playback stream
+   */
+  int GetDelay() override { return 0; }
+
   /**
    * @brief Set volume on playback stream
    *
@@ -89,6 +132,14 @@ class DummyPlayback : public Playback {
    */
   uint32_t GetPeriodSize() const override { return kPeriodSize; }
 
+  /**
+   * @brief Get settings from playback stream
+   * @return model::PlaybackSettings Playback settings
+   */
+  model::PlaybackSettings GetSettings() const override {
+    return model::PlaybackSettings{.period_size = kPeriodSize, .buffer_size = kPeriodSize * 4};
+  }
+
   /* ******************************************************************************************** */
   //! Constants
  private:
@@ -0,0 +1,267 @@
+/**
+ * \file
+ * \brief  Class for a pool of decoders warmed up in background
+ */
+
+#ifndef INCLUDE_AUDIO_DECODER_POOL_H_
+#define INCLUDE_AUDIO_DECODER_POOL_H_
+
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio/base/decoder.h"
+#include "model/audio_filter.h"
+#include "model/audio_format.h"
+#include "model/song.h"
+#include "model/volume.h"
+
+namespace {
+class DecoderPoolTest;
+class PlayerTest;
+}
+
+namespace audio {
+
+/**
+ * @brief Keep decoders opened in background for files that user will probably play next (like the
+ * ones next to the selected entry in file list). For each file, a worker thread opens input stream,
+ * probes it, configures decoder and filter chain, and decodes its first few hundred milliseconds.
+ * So when user actually plays one of them, Audio thread can start playing it right away.
+ *
+ * Memory usage is bounded by a budget, and least recently used entries are evicted first.
+ */
+class DecoderPool {
+ public:
+  //! Create a new decoder for a warm-up entry
+  using Factory = std::function<std::unique_ptr<driver::Decoder>()>;
+
+  //! Choose audio format to decode song (same logic used by Player)
+  using Negotiator = std::function<model::AudioFormat(const model::Song&)>;
+
+  //! Samples decoded in background, right from the start of song
+  struct Chunk {
+    std::vector<uint8_t> samples;  //!< Interleaved frames
+    int frames = 0;                //!< Number of frames
+    int64_t position = 0;          //!< Position in song of the first frame (in milliseconds)
+  };
+
+  //! Decoder warmed up for a single file
+  struct Entry {
+    std::string filepath;                      //!< Full path to file
+    std::unique_ptr<driver::Decoder> decoder;  //!< Decoder with file already opened
+    model::Song song;                          //!< Song information (filled by decoder)
+    model::AudioFormat format;                 //!< Format used for decoded samples
+    std::deque<Chunk> preroll;                 //!< Samples decoded from the start of song
+    size_t cost = 0;                           //!< Estimated memory usage (in bytes)
+    uint64_t generation = 0;                   //!< Volume/filters generation used to decode it
+  };
+
+  /**
+   * @brief Construct a new DecoderPool object
+   * @param factory Create a new decoder for each entry
+   * @param budget Maximum memory usage for all entries together (in bytes)
+   * @param overhead Estimated memory usage for an opened decoder, without preroll (in bytes)
+   */
+  DecoderPool(Factory factory, size_t budget, size_t overhead);
+
+  /**
+   * @brief Destroy the DecoderPool object
+   */
+  virtual ~DecoderPool();
+
+  //! Remove these
+  DecoderPool(const DecoderPool& other) = delete;             // copy constructor
+  DecoderPool(DecoderPool&& other) = delete;                  // move constructor
+  DecoderPool& operator=(const DecoderPool& other) = delete;  // copy assignment
+  DecoderPool& operator=(DecoderPool&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Spawn worker thread to warm up files in background
+   * @param negotiator Choose audio format for each song, once it is opened
+   */
+  void Start(Negotiator negotiator);
+
+  /**
+   * @brief Replace list of files waiting to be warmed up (in order of priority). Files already
+   * warmed up are kept, and become the most recently used ones
+   * @param filepaths List of full paths to files
+   */
+  void WarmUp(const std::vector<std::string>& filepaths);
+
+  /**
+   * @brief Reserve file to be played right after the current song, which is warmed up ahead of
+   * any other file (and kept as the most important entry until taken)
+   * @param filepath Full path to file (empty clears reservation)
+   */
+  void WarmUpNext(const std::string& filepath);
+
+  /**
+   * @brief Remove entry from pool, waiting for it in case that worker is opening this same file
+   * right now. In case that entry was not refreshed yet with the latest volume/filters, they are
+   * applied here and its preroll is dropped
+   * @param filepath Full path to file
+   * @param wait Wait for worker in case file is not warmed up yet (otherwise, it is kept pending)
+   * @return Entry warmed up, or nothing if file is not in pool
+   */
+  std::optional<Entry> Take(const std::string& filepath, bool wait = true);
+
+  /**
+   * @brief Set volume for all decoders (only recorded here, worker thread applies it and decodes
+   * preroll again for every entry)
+   * @param value Sound volume
+   */
+  void SetVolume(model::Volume value);
+
+  /**
+   * @brief Update audio filters for all decoders (only recorded here, worker thread applies them
+   * and decodes preroll again for every entry)
+   * @param filters Vector of audio filters
+   */
+  void UpdateFilters(const std::vector<model::AudioFilter>& filters);
+
+  /**
+   * @brief Get number of entries warmed up
+   * @return Number of entries
+   */
+  size_t Size() const;
+
+  /**
+   * @brief Get estimated memory usage from all entries
+   * @return Memory usage (in bytes)
+   */
+  size_t GetUsage() const;
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Main-loop function to warm up pending files, one at a time, and then to refresh entries
+   * decoded with outdated volume/filters
+   */
+  void Worker();
+
+  /**
+   * @brief Open file and decode its first samples (called without holding the lock)
+   * @param filepath Full path to file
+   * @param volume Sound volume to set on decoder (if any)
+   * @param filters Audio filters to set on decoder (if any)
+   * @return Entry warmed up, or nothing in case of error
+   */
+  std::optional<Entry> Open(const std::string& filepath,
+                            const std::optional<model::Volume>& volume,
+                            const std::optional<std::vector<model::AudioFilter>>& filters) const;
+
+  /**
+   * @brief Decode samples from the start of song into entry preroll, and update its cost
+   * @param entry Entry with file already opened
+   */
+  void Preroll(Entry& entry) const;
+
+  /**
+   * @brief Drop decoded samples from entry and rewind its decoder, so new settings take effect from
+   * the very first sample (decoder is released in case it cannot be rewound)
+   * @param entry Entry warmed up
+   */
+  void Rewind(Entry& entry) const;
+
+  /**
+   * @brief Apply volume/filters to entry and rewind it (called without holding the lock)
+   * @param entry Entry warmed up
+   * @param volume Sound volume to set on decoder (if any)
+   * @param filters Audio filters to set on decoder (if any)
+   */
+  void Apply(Entry& entry, const std::optional<model::Volume>& volume,
+             const std::optional<std::vector<model::AudioFilter>>& filters) const;
+
+  /**
+   * @brief Find first entry decoded with outdated volume/filters (called holding the lock)
+   * @return Iterator to entry, or end of list if all entries are up to date
+   */
+  std::list<Entry>::iterator FindStale();
+
+  /**
+   * @brief Insert entry in pool following its priority, and evict entries in case memory usage is
+   * over budget (called holding the lock)
+   * @param entry Entry warmed up
+   */
+  void Insert(Entry&& entry);
+
+  /**
+   * @brief Move next file to the front of pool, or to the front of pending files in case it is not
+   * warmed up yet (called holding the lock)
+   */
+  void PrioritizeNext();
+
+  /**
+   * @brief Get priority for file, based on the last request to warm up files (called holding the
+   * lock)
+   * @param filepath Full path to file
+   * @return Zero for next file, otherwise index in last request plus one (lower is more
+   * important), or request size plus one if file is not there
+   */
+  size_t GetRank(const std::string& filepath) const;
+
+  /**
+   * @brief Evict least recently used entries, until memory usage is within budget (called holding
+   * the lock)
+   */
+  void Evict();
+
+  /**
+   * @brief Block until worker has nothing else to do (for testing purpose)
+   */
+  void WaitUntilIdle();
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr std::chrono::milliseconds kPreroll{300};  //!< Duration to decode in advance
+  static constexpr int kChunkFrames = 1024;                  //!< Frames per read
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  Factory factory_;        //!< Create a new decoder for each entry
+  Negotiator negotiator_;  //!< Choose audio format for each song
+  size_t budget_;          //!< Maximum memory usage (in bytes)
+  size_t overhead_;        //!< Estimated memory usage for an opened decoder (in bytes)
+
+  mutable std::mutex mutex_;          //!< Control access for all variables below
+  std::condition_variable notifier_;  //!< Wake up worker (new files or exit)
+  std::condition_variable idle_;      //!< Wake up anyone waiting for worker to finish a file
+
+  std::string next_;                    //!< File to be played right after the current song
+  std::vector<std::string> requested_;  //!< Files from the last request (in order of priority)
+  std::deque<std::string> pending_;     //!< Files waiting to be warmed up
+  std::string in_flight_;               //!< File being warmed up right now by worker
+  std::list<Entry> entries_;            //!< Entries warmed up (most recently used first)
+  size_t usage_ = 0;                    //!< Estimated memory usage from all entries
+
+  std::optional<model::Volume> volume_;                     //!< Last volume set
+  std::optional<std::vector<model::AudioFilter>> filters_;  //!< Last audio filters set
+  uint64_t generation_ = 0;                                 //!< Incremented on every change
+
+  bool exit_ = false;   //!< Worker thread must finish
+  std::thread worker_;  //!< Execute warm-up function as a thread
+
+  /* ******************************************************************************************** */
+  //! Friend class for testing purpose
+  friend class ::DecoderPoolTest;
+  friend class ::PlayerTest;
+};
+
+}  // namespace audio
+#endif  // INCLUDE_AUDIO_DECODER_POOL_H_
@@ -0,0 +1,93 @@
+/**
+ * \file
+ * \brief  Class for converting interleaved audio samples into planar channels
+ */
+
+#ifndef INCLUDE_AUDIO_DEINTERLEAVER_H_
+#define INCLUDE_AUDIO_DEINTERLEAVER_H_
+
+#include <cstdint>
+
+#include "model/pcm_block.h"
+
+//! Forward declaration
+namespace {
+class DeinterleaverTest;
+}
+
+namespace audio {
+
+/**
+ * @brief Split interleaved samples into separate left and right planes of float, in a single pass
+ * and without any intermediate buffer. Output is always kept in the signed 16-bit range (as this
+ * is what audio analysis expects), whatever the sample format. Mono samples are copied to both
+ * planes, and only the first two channels are taken from multichannel audio.
+ *
+ * The most common case (signed 16-bit stereo) is vectorized when supported by CPU (AVX2 on x86-64
+ * and NEON on AArch64), otherwise it falls back to a scalar implementation.
+ */
+class Deinterleaver {
+ public:
+  /**
+   * @brief Construct a new Deinterleaver object
+   */
+  Deinterleaver();
+
+  /**
+   * @brief Destroy the Deinterleaver object
+   */
+  virtual ~Deinterleaver() = default;
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Convert samples from block into planar channels
+   * @param block Interleaved samples
+   * @param left Output for left channel (must have room for all frames from block)
+   * @param right Output for right channel (must have room for all frames from block)
+   */
+  void Process(const model::PcmBlock& block, float* left, float* right) const;
+
+  /* ******************************************************************************************** */
+  //! Internal declarations
+ private:
+  //! Signature for functions converting signed 16-bit stereo samples
+  using Kernel = void (*)(const int16_t* data, int frames, float* left, float* right);
+
+  //! Implementation using only scalar instructions (always available)
+  static void ConvertScalar(const int16_t* data, int frames, float* left, float* right);
+
+#if defined(__x86_64__)
+  //! Implementation converting eight frames at once using AVX2
+  static void ConvertAvx2(const int16_t* data, int frames, float* left, float* right);
+#endif
+
+#if defined(__aarch64__)
+  //! Implementation converting eight frames at once using NEON
+  static void ConvertNeon(const int16_t* data, int frames, float* left, float* right);
+#endif
+
+  //! Choose the best implementation supported by CPU
+  static Kernel SelectKernel();
+
+  /**
+   * @brief Convert any other sample format or number of channels (not performance critical)
+   * @param block Interleaved samples
+   * @param left Output for left channel
+   * @param right Output for right channel
+   */
+  static void ConvertGeneric(const model::PcmBlock& block, float* left, float* right);
+
+  /* ******************************************************************************************** */
+  //! Variables
+ private:
+  Kernel kernel_;  //!< Implementation used to convert signed 16-bit stereo samples
+
+  /* ******************************************************************************************** */
+  //! Friend class for testing purpose
+  friend class ::DeinterleaverTest;
+};
+
+}  // namespace audio
+#endif  // INCLUDE_AUDIO_DEINTERLEAVER_H_
@@ -9,9 +9,12 @@
 #include <alsa/asoundlib.h>
 
 #include <memory>
+#include <string>
+#include <vector>
 
 #include "audio/base/playback.h"
 #include "model/application_error.h"
+#include "model/playback_settings.h"
 
 namespace driver {
 
@@ -22,8 +25,9 @@ class Alsa : public Playback {
  public:
   /**
    * @brief Construct a new Alsa object
+   * @param settings Device name and latency profile to use for playback stream
    */
-  Alsa();
+  explicit Alsa(const model::PlaybackSettings& settings = model::PlaybackSettings{});
 
   /**
    * @brief Destroy the Alsa object
@@ -40,10 +44,18 @@ class Alsa : public Playback {
   error::Code CreatePlaybackStream() override;
 
   /**
-   * @brief Configure Playback Stream parameters (sample format, etc...) using ALSA API
+   * @brief Query ALSA API for sample formats and sample rates supported by playback stream
+   * @return Capabilities Supported formats and rates
+   */
+  Capabilities GetCapabilities() override;
+
+  /**
+   * @brief Configure Playback Stream parameters (sample format, period and buffer size based on
+   * latency profile) using ALSA API
+   * @param format Audio format for samples written into playback stream
    * @return error::Code Playback error converted to application error code
    */
-  error::Code ConfigureParameters() override;
+  error::Code ConfigureParameters(const model::AudioFormat& format) override;
 
   /**
    * @brief Ask ALSA API to make playback stream ready to play
@@ -52,17 +64,30 @@ class Alsa : public Playback {
   error::Code Prepare() override;
 
   /**
-   * @brief Pause current song on playback stream
+   * @brief Pause current song on playback stream, using hardware pause when supported by device.
+   * Otherwise, frames not played yet are held in memory before dropping them from stream
    * @return error::Code Playback error converted to application error code
    */
   error::Code Pause() override;
 
   /**
-   * @brief Stop playing song on playback stream
+   * @brief Resume current song on playback stream (writing held frames again, if necessary)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Resume() override;
+
+  /**
+   * @brief Stop playing song on playback stream immediately (frames not played yet are dropped)
    * @return error::Code Playback error converted to application error code
    */
   error::Code Stop() override;
 
+  /**
+   * @brief Stop playing song on playback stream after all frames in buffer were played (blocking)
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code Drain() override;
+
   /**
    * @brief Directly write audio buffer to playback stream (this should be called by decoder)
    *
@@ -72,6 +97,29 @@ class Alsa : public Playback {
    */
   error::Code AudioCallback(void* buffer, int size) override;
 
+  /**
+   * @brief Get direct access to memory-mapped buffer from playback stream (only available when
+   * stream was configured with mmap access)
+   *
+   * @param frames Maximum number of frames to write (updated with number of frames available)
+   * @return void* Address to write interleaved frames, or nullptr if not available
+   */
+  void* BeginDirectWrite(int& frames) override;
+
+  /**
+   * @brief Commit frames written into memory-mapped buffer, starting playback stream if necessary
+   *
+   * @param frames Number of frames written
+   * @return error::Code Playback error converted to application error code
+   */
+  error::Code CommitDirectWrite(int frames) override;
+
+  /**
+   * @brief Get playback latency from ALSA API (frames written but not played yet)
+   * @return int Number of frames queued in playback stream
+   */
+  int GetDelay() override;
+
   /**
    * @brief Set volume on playback stream
    *
@@ -90,7 +138,13 @@ class Alsa : public Playback {
    * @brief Get period size (previously filled by ALSA API)
    * @return uint32_t Period size
    */
-  uint32_t GetPeriodSize() const override { return (uint32_t)period_size_; }
+  uint32_t GetPeriodSize() const override { return settings_.period_size; }
+
+  /**
+   * @brief Get settings from playback stream (previously negotiated with ALSA API)
+   * @return model::PlaybackSettings Playback settings
+   */
+  model::PlaybackSettings GetSettings() const override { return settings_; }
 
   /* ******************************************************************************************** */
   //! Utility
@@ -101,21 +155,69 @@ class Alsa : public Playback {
    */
   snd_mixer_elem_t* GetMasterPlayback();
 
+  /**
+   * @brief Convert sample format to the equivalent one from ALSA API
+   * @param format Sample format
+   * @return snd_pcm_format_t ALSA sample format
+   */
+  static snd_pcm_format_t ToAlsaFormat(model::AudioFormat::SampleFormat format);
+
+  //! Period and buffer duration (in microseconds) requested to ALSA for a latency profile
+  struct LatencyTarget {
+    unsigned int period_time;
+    unsigned int buffer_time;
+  };
+
+  /**
+   * @brief Get period and buffer duration for the given latency profile
+   * @param latency Latency profile
+   * @return LatencyTarget Durations to request (device may choose the closest ones supported)
+   */
+  static LatencyTarget GetLatencyTarget(model::PlaybackSettings::Latency latency);
+
+  /**
+   * @brief Get device name to attach mixer, as it works with cards instead of PCM devices (e.g.
+   * "hw:1,0" or "plughw:1,0" becomes "hw:1")
+   * @param device PCM device name
+   * @return std::string Mixer device name
+   */
+  static std::string GetMixerDevice(const std::string& device);
+
+  /**
+   * @brief Keep a copy from the latest frames written into playback stream (only when device cannot
+   * pause), so the ones not played yet can be held while paused
+   * @param data Interleaved frames
+   * @param frames Number of frames
+   */
+  void KeepHistory(const void* data, int frames);
+
+  /**
+   * @brief Copy frames not played yet (based on stream delay) from history into held frames
+   */
+  void HoldPendingFrames();
+
   /* ******************************************************************************************** */
   //! Default Constants for Audio Parameters
  private:
-  static constexpr const char kDevice[] = "default";
   static constexpr const char kSelemName[] = "Master";
-  static constexpr int kChannels = 2;
-  static constexpr int kSampleRate = 44100;
-  static constexpr snd_pcm_format_t kSampleFormat = SND_PCM_FORMAT_S16_LE;
+  static constexpr int kWaitTimeout = 1000;  //!< Maximum time (in ms) to wait for space in buffer
+
+  //! Sample formats and sample rates to check for support on playback stream
+  static constexpr model::AudioFormat::SampleFormat kSampleFormats[] = {
+      model::AudioFormat::SampleFormat::S16,
+      model::AudioFormat::SampleFormat::S32,
+      model::AudioFormat::SampleFormat::Float,
+  };
+
+  static constexpr uint32_t kSampleRates[] = {44100, 48000, 88200, 96000, 176400, 192000};
 
   /* ******************************************************************************************** */
   //! Custom declarations with deleters
  private:
   struct PcmDeleter {
     void operator()(snd_pcm_t* p) const {
-      snd_pcm_drain(p);
+      // Do not block application exit waiting for buffer to be played
+      snd_pcm_drop(p);
       snd_pcm_close(p);
     }
   };
@@ -131,9 +233,22 @@ class Alsa : public Playback {
   /* ******************************************************************************************** */
   //! Variables
 
-  PcmPlayback playback_handle_;    //! Playback stream handled by ALSA API
-  MixerControl mixer_;             //! High level control interface from ALSA API (to manage volume)
-  snd_pcm_uframes_t period_size_;  //! Period size (necessary in order to discover buffer size)
+  PcmPlayback playback_handle_;       //! Playback stream handled by ALSA API
+  MixerControl mixer_;                //! High level control interface from ALSA API (for volume)
+  model::PlaybackSettings settings_;  //! Requested settings and values negotiated with device
+
+  bool mmap_requested_;                //! User asked for mmap access (it may not be supported)
+  void* mmap_area_;                    //! Address from the latest area returned by mmap_begin
+  snd_pcm_uframes_t mmap_offset_;      //! Offset from the latest area returned by mmap_begin
+  snd_pcm_uframes_t start_threshold_;  //! Stream starts once this number of frames is written
+
+  bool can_pause_;  //! Device supports pausing stream without dropping frames
+
+  //! Software hold (when device cannot pause)
+  std::vector<uint8_t> history_;  //! Latest frames written (circular buffer with buffer size)
+  int history_end_;               //! Index from the next frame to write into history
+  int history_size_;              //! Number of valid frames in history
+  std::vector<uint8_t> held_;     //! Frames not played yet when stream was paused
 };
 
 }  // namespace driver
@@ -17,12 +17,15 @@ extern "C" {
 #include <libavutil/version.h>
 }
 
-#include <map>
 #include <memory>
 #include <string>
+#include <vector>
 
 #include "audio/base/decoder.h"
+#include "audio/equalizer.h"
+#include "audio/file_input.h"
 #include "model/application_error.h"
+#include "model/input_settings.h"
 #include "model/song.h"
 #include "model/volume.h"
 
@@ -35,8 +38,9 @@ class FFmpeg : public Decoder {
  public:
   /**
    * @brief Construct a new FFmpeg object
+   * @param input Settings for reading and decoding local files (including which equalizer to use)
    */
-  FFmpeg();
+  explicit FFmpeg(const model::InputSettings& input = model::InputSettings{});
 
   /**
    * @brief Destroy the FFmpeg object
@@ -47,7 +51,25 @@ class FFmpeg : public Decoder {
   //! Internal operations
  private:
   error::Code OpenInputStream(const std::string& filepath);
+
+  /**
+   * @brief Create custom I/O context to read local file using FileInput (instead of letting
+   * FFmpeg read it with small buffered reads)
+   * @param filepath Path to local file
+   * @return error::Code Application error code
+   */
+  error::Code CreateInputContext(const std::string& filepath);
+
   error::Code ConfigureDecoder();
+
+  /**
+   * @brief Get number of threads to decode, based on thread budget from settings. When set to
+   * auto, it uses one thread per core, but capped (as audio frames are small, more threads than
+   * that would only add overhead)
+   * @param budget Thread budget (zero means auto)
+   * @return int Number of threads
+   */
+  static int GetThreadCount(uint32_t budget);
   error::Code ConfigureFilters();
 
   //! These are ffmpeg-specific filters
@@ -57,6 +79,72 @@ class FFmpeg : public Decoder {
   error::Code CreateFilterAbufferSink();
   error::Code CreateFilterEqualizer(const std::string& name, const model::AudioFilter& filter);
 
+  /**
+   * @brief Update parameters from an equalizer filter in the running filter graph
+   * @param index Equalizer position in the filter chain
+   * @param current Parameters currently in use by the equalizer filter
+   * @param updated New parameters for the equalizer filter
+   * @return error::Code Application error code
+   */
+  error::Code UpdateFilterEqualizer(size_t index, const model::AudioFilter& current,
+                                    const model::AudioFilter& updated);
+
+  /**
+   * @brief Send command to change an option from a filter in the running filter graph
+   * @param target Filter instance name
+   * @param command Option name
+   * @param value New value for option
+   * @return error::Code Application error code
+   */
+  error::Code SendFilterCommand(const std::string& target, const std::string& command,
+                                const std::string& value);
+
+  /**
+   * @brief Get name for equalizer filter instance (based on its position in the filter chain, so
+   * its parameters can change without renaming it)
+   * @param index Equalizer position in the filter chain
+   * @return Filter instance name
+   */
+  static std::string GetEqualizerName(size_t index) {
+    return std::string{kFilterEqualizer} + "_" + std::to_string(index);
+  }
+
+  /**
+   * @brief Get number of equalizer filters to create in the filter graph
+   * @return Zero when using native equalizer, otherwise, one for each audio filter
+   */
+  size_t GetEqualizerCount() const { return equalizer_ ? 0 : audio_filters_.size(); }
+
+  /**
+   * @brief Get number of channels from audio frame
+   * @param frame Audio frame
+   * @return Number of channels
+   */
+  static int GetChannels(const AVFrame* frame) {
+#if LIBAVUTIL_VERSION_MAJOR > 56
+    return frame->ch_layout.nb_channels;
+#else
+    return frame->channels;
+#endif
+  }
+
+  /**
+   * @brief Convert sample format to the equivalent one from FFmpeg (always interleaved)
+   * @param format Sample format
+   * @return AVSampleFormat FFmpeg sample format
+   */
+  static AVSampleFormat ToAVSampleFormat(model::AudioFormat::SampleFormat format) {
+    switch (format) {
+      case model::AudioFormat::SampleFormat::S32:
+        return AV_SAMPLE_FMT_S32;
+      case model::AudioFormat::SampleFormat::Float:
+        return AV_SAMPLE_FMT_FLT;
+      case model::AudioFormat::SampleFormat::S16:
+      default:
+        return AV_SAMPLE_FMT_S16;
+    }
+  }
+
   /**
    * @brief Connect all filters created in the filtergraph as a linear chain
    * P.S. in general, this is the filter chain:
@@ -68,10 +156,14 @@ class FFmpeg : public Decoder {
   error::Code ConnectFilters();
 
   /**
-   * @brief Extract all metadata from current song and fill the structure with it
+   * @brief Extract all metadata from opened input stream and fill the structure with it (tags are
+   * read from container, falling back to the audio stream itself, as used by some formats like OGG)
+   * @param context Format context from opened input stream
+   * @param stream_index Index of audio stream
    * @param audio_info Audio information structure
    */
-  void FillAudioInformation(model::Song& audio_info);
+  static void FillAudioInformation(const AVFormatContext* context, int stream_index,
+                                   model::Song& audio_info);
 
   /* ******************************************************************************************** */
  public:
@@ -83,18 +175,38 @@ class FFmpeg : public Decoder {
   error::Code OpenFile(model::Song& audio_info) override;
 
   /**
-   * @brief Decode and resample input stream to desired sample format/rate
-   * @param samples Maximum value of samples
-   * @param callback Pass resamples to this callback
+   * @brief Read next frames from input stream, already decoded, filtered and converted to the
+   * output audio format (frames left over from the last decoded chunk are kept in the carry-over
+   * buffer, to be returned by the next call)
+   * @param buffer Destination for interleaved samples (must fit the requested number of frames)
+   * @param frames (In/Out) Maximum number of frames to read, and then, number of frames read
+   * @param position (Out) Position in song (in milliseconds) of the first frame read
+   * @return error::Code Application error code
+   */
+  error::Code Read(void* buffer, int& frames, int64_t& position) override;
+
+  /**
+   * @brief Seek exact position in song. As seeking only lands on keyframes, samples before the
+   * exact position are discarded right after decoding. For a short jump ahead, it is cheaper to
+   * simply keep decoding and discard everything in between
+   * @param position Position in song (in milliseconds)
    * @return error::Code Application error code
    */
-  error::Code Decode(int samples, AudioCallback callback) override;
+  error::Code Seek(int64_t position) override;
 
   /**
    * @brief After file is opened and decoded, or when some error occurs, always clear internal cache
    */
   void ClearCache() override;
 
+  /**
+   * @brief Set audio format for decoded samples returned by Read (in case that some file is already
+   * opened, filter graph is recreated to use it)
+   * @param format Audio format negotiated with playback
+   * @return error::Code Decoder error converted to application error code
+   */
+  error::Code SetOutputFormat(const model::AudioFormat& format) override;
+
   /**
    * @brief Set volume on playback stream
    *
@@ -117,9 +229,34 @@ class FFmpeg : public Decoder {
    */
   error::Code UpdateFilters(const std::vector<model::AudioFilter>& filters) override;
 
+  /**
+   * @brief Get counters from reading the current (or last) opened file, like bytes read and
+   * syscalls issued (only filled for local files)
+   * @return Statistics for file
+   */
+  const audio::FileInput::Statistics& GetInputStatistics() const {
+    return file_input_.GetStatistics();
+  }
+
+  /**
+   * @brief Probe file only to extract its metadata, without configuring any decoder or filter. To
+   * keep it cheap, probing is limited to the first few hundred kilobytes of file
+   * @param audio_info (In/Out) Song with filepath, filled with detailed audio information
+   * @return error::Code Application error code
+   */
+  static error::Code ProbeFile(model::Song& audio_info);
+
   /* ******************************************************************************************** */
   //! Custom declarations with deleters
  private:
+  struct IOContextDeleter {
+    void operator()(AVIOContext* p) const {
+      // Buffer may have been reallocated internally, so it must be released from context itself
+      av_freep(&p->buffer);
+      avio_context_free(&p);
+    }
+  };
+
   struct FormatContextDeleter {
     void operator()(AVFormatContext* p) const { avformat_close_input(&p); }
   };
@@ -151,6 +288,7 @@ class FFmpeg : public Decoder {
     void operator()(AVFilterContext*) const noexcept {}
   };
 
+  using IOContext = std::unique_ptr<AVIOContext, IOContextDeleter>;
   using FormatContext = std::unique_ptr<AVFormatContext, FormatContextDeleter>;
   using CodecContext = std::unique_ptr<AVCodecContext, CodecContextDeleter>;
 
@@ -163,9 +301,7 @@ class FFmpeg : public Decoder {
   /* ******************************************************************************************** */
   //! Default Constants
 
-  static constexpr int kChannels = 2;                                 //!< Output number of channels
-  static constexpr int kSampleRate = 44100;                           //!< Output sample rate
-  static constexpr AVSampleFormat kSampleFormat = AV_SAMPLE_FMT_S16;  //!< Output sample format
+  static constexpr int kChannels = 2;  //!< Output number of channels
 
   //! All filters used from AVFilter library
   static constexpr char kFilterAbufferSrc[] = "abuffer";
@@ -177,6 +313,16 @@ class FFmpeg : public Decoder {
   static constexpr int kDefaultFilterCount =
       4;  //!< Number of filters without considering equalizer filters
   static constexpr int kResponseSize = 64;  //!< Response message size from AVFilter command
+  static constexpr int kInputBufferSize = 64 * 1024;  //!< Buffer size for custom I/O context
+  static constexpr int kMaxAutoThreads = 4;  //!< Maximum number of decoding threads when on auto
+  static constexpr int64_t kProbeSize = 256 * 1024;  //!< Maximum bytes read to probe a file
+  static constexpr int64_t kAnalyzeDuration = 500000;  //!< Maximum duration analyzed (in us)
+
+  //! Unit of time used for song position returned by Read
+  static constexpr AVRational kPositionTimeBase = {1, 1000};
+
+  static constexpr int64_t kMaxSeekDecodeAhead =
+      3000;  //!< Maximum distance (in ms) to seek forward by decoding, instead of seeking keyframe
 
   /* ******************************************************************************************** */
   //! Utilities
@@ -205,18 +351,25 @@ class FFmpeg : public Decoder {
   //! Decoding
 
   /**
-   * @brief An structure for shared use between Decode and ProcessFrame functions
+   * @brief An structure for shared use between all functions involved in reading decoded frames
    */
   struct DecodingData {
     AVRational time_base;  //!< Unit of time from input stream
-    int64_t position;      //!< Current audio position
+    int64_t position;      //!< Position from last decoded frame (in milliseconds)
+    int64_t timestamp;     //!< Timestamp right after last decoded frame (in time_base units)
+    int64_t seek_target;   //!< Discard decoded samples until this timestamp (in time_base units)
 
     Packet packet;         //!< Raw audio data read from input stream
     Frame frame_decoded;   //!< Frame received from decoder
     Frame frame_filtered;  //!< Frame received from filtergraph
 
+    std::vector<uint8_t> carry_over;  //!< Samples decoded (in output format) but not read yet
+    int carry_offset;                 //!< Number of frames from carry-over already read
+    int64_t carry_position;           //!< Position of the first frame in carry-over (in ms)
+
     error::Code err_code;  //!< Error code for decoding and equalizing audio
-    bool keep_playing;     //!< Control flag for playing audio
+    bool draining;         //!< Input stream has ended, so decoder is returning remaining frames
+    bool finished;         //!< Decoder has no frame left at all
     bool reset_filters;    //!< Control flag for resetting filter graph
 
     /**
@@ -232,27 +385,101 @@ class FFmpeg : public Decoder {
       av_frame_unref(frame_filtered.get());
     }
 
+    /**
+     * @brief Drop every sample from carry-over buffer
+     */
+    void ClearCarryOver() {
+      carry_over.clear();
+      carry_offset = 0;
+    }
+
     /**
      * @brief Check condition to keep executing audio decoding operation
      * @return true for all conditions are fine to keep decoding, false otherwise
      */
-    bool KeepDecoding() { return err_code == error::kSuccess && keep_playing; }
+    bool KeepDecoding() const { return err_code == error::kSuccess && !finished; }
 
     /**
      * @brief Check if internal structures are allocated correctly
      * @return true for correct allocation, false otherwise
      */
-    bool CheckAllocations() { return packet && frame_decoded && frame_filtered; }
+    bool CheckAllocations() const { return packet && frame_decoded && frame_filtered; }
   };
 
   /**
-   * @brief Receive decoded frame and send it to be processed by filter chain (filtergraph), if
-   * everything is fine, send output buffer to Player API callback
+   * @brief Allocate internal structures used to decode the opened input stream
+   * @return error::Code Application error code
+   */
+  error::Code CreateDecodingContext();
+
+  /**
+   * @brief Decode input stream until there is a new chunk of samples (in output format) in the
+   * carry-over buffer, replacing any previous content from it
+   * @return true if carry-over buffer was filled, false when stream has ended or on error
+   */
+  bool DecodeChunk();
+
+  /**
+   * @brief Read next packet from input stream and send it to decoder (when there is no packet
+   * left, start draining decoder to get the frames still buffered internally)
+   */
+  void SendNextPacket();
+
+  /**
+   * @brief Receive decoded frame and send it to be processed by filter chain (filtergraph). In
+   * case that filter chain would not change audio data at all, decoded frame is appended directly
+   * to carry-over buffer
+   */
+  void ProcessFrame();
+
+  /**
+   * @brief Pull a single filtered frame from filter chain and append it to carry-over buffer
+   * @return true if some frame was pulled, false if filter chain has nothing to output right now
+   */
+  bool PullFilteredFrame();
+
+  /**
+   * @brief Discard every frame already available in the output from filter chain
+   */
+  void DiscardFilteredFrames();
+
+  /**
+   * @brief Append samples (in output format) to carry-over buffer
+   * @param data Interleaved samples
+   * @param frames Number of frames
+   */
+  void AppendCarryOver(const uint8_t* data, int frames);
+
+  /**
+   * @brief Check if decoded frame can be sent directly to carry-over buffer, skipping filter chain.
+   * It is only possible when volume and all audio filters are neutral, and frame is already in the
+   * output sample rate and number of channels (only sample format conversion is allowed)
    *
-   * @param samples Maximum number of samples to send to Audio Player API callback
-   * @param callback Audio Player API callback
+   * @param frame Decoded frame
+   * @return true if filter chain would not change audio data, false otherwise
    */
-  void ProcessFrame(int samples, AudioCallback callback);
+  bool CanPassthrough(const AVFrame* frame) const;
+
+  /**
+   * @brief Convert frame to the output sample format (interleaved)
+   * @param frame Decoded frame (stereo and in one of the sample formats supported by passthrough)
+   * @return Pointer to interleaved samples (from frame itself or from internal buffer)
+   */
+  uint8_t* InterleaveSamples(const AVFrame* frame);
+
+  /**
+   * @brief Equalize samples in place using native equalizer
+   * @param buffer Interleaved samples in the output sample format
+   * @param frames Number of frames in buffer
+   */
+  void Equalize(uint8_t* buffer, int frames);
+
+  /**
+   * @brief Discard samples from decoded frame that come before the seek target (if any)
+   * @param frame Decoded frame (trimmed in place, in case that seek target is in the middle of it)
+   * @return true if frame still has samples to process, false if it should be entirely skipped
+   */
+  bool DiscardUntilSeekTarget(AVFrame* frame);
 
   /* ******************************************************************************************** */
   //! Variables
@@ -268,19 +495,28 @@ class FFmpeg : public Decoder {
   static constexpr int kChannelLayout = AV_CH_LAYOUT_STEREO;
 #endif
 
-  FormatContext input_stream_;  //!< Input stream from file
-  CodecContext decoder_;        //!< Specific codec compatible with the input stream
+  //! P.S.: declared in this order, so input stream is always released before its I/O context
+  audio::FileInput file_input_;  //!< Reader for local files
+  IOContext input_context_;      //!< Custom I/O context for input stream (only for local files)
+  FormatContext input_stream_;   //!< Input stream from file
+  CodecContext decoder_;         //!< Specific codec compatible with the input stream
+  int decoder_threads_;          //!< Number of threads to decode (if supported by codec)
 
   int stream_index_;  //!< Audio stream index read in input stream
 
   model::Volume volume_;  //!< Playback stream volume
 
+  model::AudioFormat output_format_;  //!< Audio format for samples returned by Read
+
   FilterGraph filter_graph_;      //!< Directed graph of connected filters
   FilterContext buffersrc_ctx_;   //!< Input buffer for audio frames in the filter chain
   FilterContext buffersink_ctx_;  //!< Output buffer from filter chain
 
-  using FilterName = std::string;
-  std::map<FilterName, model::AudioFilter> audio_filters_;  //!< Equalization filters
+  std::vector<model::AudioFilter> audio_filters_;  //!< Equalization filters (in chain order)
+  std::unique_ptr<audio::Equalizer> equalizer_;    //!< Native equalizer (optional)
+
+  bool passthrough_;                         //!< Decoded frames are skipping filter chain
+  std::vector<uint8_t> passthrough_buffer_;  //!< Samples converted to output sample format
 
   DecodingData shared_context_;  //!< Shared context for decoding and equalizing audio data
 };
@@ -8,12 +8,18 @@
 
 #include <fftw3.h>
 
+#include <filesystem>
 #include <memory>
 #include <vector>
 
 #include "audio/base/analyzer.h"
 #include "model/application_error.h"
 
+//! Forward declaration
+namespace {
+class FftwTest;
+}
+
 namespace driver {
 
 /**
@@ -23,8 +29,9 @@ class FFTW : public Analyzer {
  public:
   /**
    * @brief Construct a new FFTW object
+   * @param wisdom Path to file caching FFTW wisdom across executions (optional)
    */
-  FFTW();
+  explicit FFTW(const std::filesystem::path &wisdom = {});
 
   /**
    * @brief Destroy the FFTW object
@@ -35,27 +42,38 @@ class FFTW : public Analyzer {
   //! Public API
  public:
   /**
-   * @brief Initialize internal structures for audio analysis
+   * @brief Initialize internal structures for audio analysis. FFT plans are created only on the
+   * first call, as FFT sizes never change, so any later call only redistributes bars
    *
    * @param output_size Size for output vector from Execute
    */
   error::Code Init(int output_size) override;
 
   /**
-   * @brief Run FFT on input vector to get information about audio in the frequency domain
+   * @brief Set sample rate from audio data received for analysis (cut-off frequencies for each bar
+   * are recalculated, as they depend on it)
+   *
+   * @param sample_rate Number of frames per second
+   */
+  error::Code SetSampleRate(int sample_rate) override;
+
+  /**
+   * @brief Run FFT on input to get information about audio in the frequency domain
    *
-   * @param in Input vector with audio raw data (signal amplitude)
-   * @param size Input vector size
+   * @param left Input samples from left channel (signal amplitude in signed 16-bit range)
+   * @param right Input samples from right channel (signal amplitude in signed 16-bit range)
+   * @param frames Number of samples per channel
    * @param out Output vector where each entry represents a frequency bar
    */
-  error::Code Execute(double *in, int size, double *out) override;
+  error::Code Execute(const float *left, const float *right, int frames, double *out) override;
 
   /**
-   * @brief Get internal buffer size
+   * @brief Get internal buffer size (as only the most recent frames are analyzed, anything longer
+   * than the largest window would be discarded anyway)
    *
-   * @return Maximum size for input vector
+   * @return Maximum number of frames for input
    */
-  int GetBufferSize() override { return kBufferSize; }
+  int GetBufferSize() override { return input_size_; }
 
   /**
    * @brief Get output buffer size
@@ -68,44 +86,61 @@ class FFTW : public Analyzer {
   //! Custom declarations with deleters
  private:
   struct RealDeleter {
-    void operator()(double *p) const { fftw_free(p); }
+    void operator()(float *p) const { fftwf_free(p); }
   };
 
   struct ComplexDeleter {
-    void operator()(fftw_complex *p) const { fftw_free(p); }
+    void operator()(fftwf_complex *p) const { fftwf_free(p); }
   };
 
   struct PlanDeleter {
-    void operator()(fftw_plan_s *p) const { fftw_destroy_plan(p); }
+    void operator()(fftwf_plan_s *p) const { fftwf_destroy_plan(p); }
   };
 
-  using FFTReal = std::unique_ptr<double, RealDeleter>;
-  using FFTComplex = std::unique_ptr<fftw_complex, ComplexDeleter>;
-  using FFTPlan = std::unique_ptr<fftw_plan_s, PlanDeleter>;
+  using FFTReal = std::unique_ptr<float, RealDeleter>;
+  using FFTComplex = std::unique_ptr<fftwf_complex, ComplexDeleter>;
+  using FFTPlan = std::unique_ptr<fftwf_plan_s, PlanDeleter>;
 
   /**
-   * @brief Audio frequency analysis
+   * @brief Audio frequency analysis (using single precision, as it is more than enough to draw
+   * bars on terminal, while halving memory used by each buffer). Both channels are kept in the
+   * same buffer, one after the other, so a single plan transforms them at once.
    */
   struct FreqAnalysis {
-    int buffer_size;                    //!< Buffer size for this audio range analysis
-    FFTPlan plan_left, plan_right;      //!< FFTW Plan (define input and output size to perform DFT)
-    FFTComplex out_left, out_right;     //!< One-dimensional DFT output per channel
-    FFTReal multiplier;                 //!< Hanning Window
-    FFTReal in_raw_left, in_raw_right;  //!< Raw audio input data per channel
-    FFTReal in_left, in_right;          //!< Audio input data with windowing applied per channel
+    int buffer_size;     //!< Buffer size for this audio range analysis
+    FFTPlan plan;        //!< FFTW Plan (define input and output size to perform DFT)
+    FFTComplex out;      //!< One-dimensional DFT output (left channel followed by right channel)
+    FFTReal multiplier;  //!< Hanning Window
+    FFTReal in;          //!< Audio input data with windowing applied (left followed by right)
+
+    //! Number of complex values in DFT output per channel
+    int OutputSize() const { return buffer_size / 2 + 1; }
+
+    //! Access input/output per channel
+    float *InLeft() const { return in.get(); }
+    float *InRight() const { return in.get() + buffer_size; }
+    const fftwf_complex *OutLeft() const { return out.get(); }
+    const fftwf_complex *OutRight() const { return out.get() + OutputSize(); }
   };
 
   /* ******************************************************************************************** */
   //! Private methods
  private:
   // From init
+  void CreatePlans();
   void CreateHannWindow(FreqAnalysis &analysis);
   void CreateFftwStructure(FreqAnalysis &analysis);
   void CreateBuffers();
   void CalculateFrequencies();
 
+  // Wisdom accumulated by FFTW while creating plans
+  void ImportWisdom();
+  void ExportWisdom();
+
   // From execute
-  void FillInputBuffer(double *in, int &size, int &silence);
+  void FillInputBuffer(const float *left, const float *right, int &frames, int &silence);
+  void WriteInput(std::vector<float> &input, const float *data, int frames);
+  const float *ReadInput(const std::vector<float> &input, int frames) const;
   void ApplyFft(FreqAnalysis &analysis);
   void SeparateFreqBands(double *out);
   void AdjustResults(double *out, int silence);
@@ -120,7 +155,7 @@ class FFTW : public Analyzer {
   static constexpr int kLowCutOff = 50;      //!< Low frequency to cut off (in Hz)
   static constexpr int kHighCutOff = 10000;  //!< High frequency to cut off (in Hz)
 
-  static constexpr int kSampleRate = 44100;  //!< Audio data sample rate
+  static constexpr int kSampleRate = 44100;  //!< Default audio data sample rate
 
   static constexpr float kNoiseReduction =
       0.77f;  //!< Adjusts the integral and gravity filters to keep the signal smooth
@@ -128,11 +163,16 @@ class FFTW : public Analyzer {
   /* ******************************************************************************************** */
   //! Variables
  private:
+  std::filesystem::path wisdom_;  //!< File caching FFTW wisdom, to skip measuring on next run
+
   FreqAnalysis bass_, mid_, treble_;  //!< Split audio spectrum analysis between three audio ranges
 
-  //! Input data
-  double input_size_;          //!< Maximum size for input buffer
-  std::vector<double> input_;  //!< Input buffer with raw audio data
+  //! Input data (planar circular buffers, where each frame is stored twice, one input_size_ apart,
+  //! so the most recent frames can always be read as a contiguous slice, whatever the position)
+  int input_size_;                  //!< Maximum number of frames kept per channel
+  int input_position_;              //!< Position where the next frame will be written
+  std::vector<float> input_left_;   //!< Input buffer with raw audio data from left channel
+  std::vector<float> input_right_;  //!< Input buffer with raw audio data from right channel
 
   //! To smooth results after applying FFT
   std::vector<double> previous_output_, memory_, peak_;
@@ -157,6 +197,12 @@ class FFTW : public Analyzer {
 
   int bars_per_channel_;  //!< Maximum number of bars per channel
   int output_size_;       //!< Maximum output size from audio analysis
+
+  int sample_rate_;  //!< Audio data sample rate
+
+  /* ******************************************************************************************** */
+  //! Friend class for testing purpose
+  friend class ::FftwTest;
 };
 
 }  // namespace driver
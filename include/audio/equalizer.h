@@ -0,0 +1,182 @@
+/**
+ * \file
+ * \brief  Class for equalizing audio samples using a cascade of biquad filters
+ */
+
+#ifndef INCLUDE_AUDIO_EQUALIZER_H_
+#define INCLUDE_AUDIO_EQUALIZER_H_
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+#include "model/audio_filter.h"
+
+//! Forward declaration
+namespace {
+class EqualizerTest;
+}
+
+namespace audio {
+
+/**
+ * @brief Equalize interleaved stereo samples in a single pass, running all bands as a cascade of
+ * peaking biquad filters (same transfer function as the "equalizer" filter from libavfilter). When
+ * supported by CPU, filters are vectorized (AVX2 on x86-64 and NEON on AArch64), otherwise it
+ * falls back to a scalar implementation.
+ *
+ * P.S.: SetFilters and Process may run on different threads, but neither of them may be called
+ * concurrently with itself (e.g. writer side may only move to another thread through some lock).
+ * Coefficients are exchanged without locking (using a triple buffer), so updating filters never
+ * blocks audio processing. All buffers are allocated up front, so processing never allocates.
+ */
+class Equalizer {
+ public:
+  /**
+   * @brief Construct a new Equalizer object
+   * @param sample_rate Sample rate from audio samples to equalize
+   */
+  explicit Equalizer(int sample_rate = kSampleRate);
+
+  /**
+   * @brief Destroy the Equalizer object
+   */
+  virtual ~Equalizer() = default;
+
+  //! Remove these
+  Equalizer(const Equalizer& other) = delete;             // copy constructor
+  Equalizer(Equalizer&& other) = delete;                  // move constructor
+  Equalizer& operator=(const Equalizer& other) = delete;  // copy assignment
+  Equalizer& operator=(Equalizer&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Calculate coefficients for the given filters and publish them to be used on the next
+   * call to Process (filter state is preserved, unless the number of bands changes)
+   * @param filters Audio filters (one for each band, bands beyond kMaxBands are ignored)
+   */
+  void SetFilters(const std::vector<model::AudioFilter>& filters);
+
+  /**
+   * @brief Change sample rate from audio samples, recalculating coefficients for the latest
+   * filters (must be called from the same thread as SetFilters)
+   * @param sample_rate Sample rate from audio samples to equalize
+   */
+  void SetSampleRate(int sample_rate);
+
+  /**
+   * @brief Equalize audio samples in place
+   * @param buffer Interleaved stereo samples (signed 16-bit, signed 32-bit or 32-bit float)
+   * @param frames Number of frames in buffer
+   */
+  void Process(int16_t* buffer, int frames);
+  void Process(int32_t* buffer, int frames);
+  void Process(float* buffer, int frames);
+
+  /**
+   * @brief Clear filter state (e.g. before processing a new stream), must be called from the same
+   * thread as Process
+   */
+  void Reset();
+
+  /* ******************************************************************************************** */
+  //! Internal structures
+ private:
+  static constexpr int kSampleRate = 44100;  //!< Default sample rate
+  static constexpr int kChannels = 2;        //!< Only stereo audio is supported
+  static constexpr int kMaxBands = 64;       //!< Maximum number of bands
+  static constexpr int kMaxFrames = 1024;    //!< Frames converted to double at once
+
+  //! Normalized coefficients for a single biquad filter (a0 is always 1)
+  struct Coefficients {
+    double b0, b1, b2, a1, a2;
+  };
+
+  //! Filter state for a single band, for both channels (transposed direct form II)
+  struct alignas(16) State {
+    double z1[kChannels];
+    double z2[kChannels];
+  };
+
+  //! Signature for functions processing all bands over samples converted to double
+  using Kernel = void (*)(const Coefficients* coefficients, State* state, int bands, double* data,
+                          int frames);
+
+  /**
+   * @brief Calculate coefficients for a peaking equalizer, based on the Audio EQ Cookbook
+   * @param filter Audio filter
+   * @param sample_rate Sample rate
+   * @return Filter coefficients
+   */
+  static Coefficients Calculate(const model::AudioFilter& filter, int sample_rate);
+
+  //! Implementation using only scalar instructions (always available)
+  static void ProcessScalar(const Coefficients* coefficients, State* state, int bands,
+                            double* data, int frames);
+
+#if defined(__x86_64__)
+  //! Implementation running two bands at once (pipelined by one frame) using AVX2 and FMA
+  static void ProcessAvx2(const Coefficients* coefficients, State* state, int bands, double* data,
+                          int frames);
+#endif
+
+#if defined(__aarch64__)
+  //! Implementation running both channels at once using NEON
+  static void ProcessNeon(const Coefficients* coefficients, State* state, int bands, double* data,
+                          int frames);
+#endif
+
+  //! Choose the best implementation supported by CPU
+  static Kernel SelectKernel();
+
+  /**
+   * @brief Prepare internal structures to process samples (must be called by reader before
+   * converting samples)
+   * @return Number of bands to process (zero means that there is nothing to do)
+   */
+  int Acquire();
+
+  /**
+   * @brief Equalize samples in blocks of kMaxFrames, converting them to double and back
+   * @param buffer Interleaved stereo samples
+   * @param frames Number of frames in buffer
+   * @param load Convert a single sample to double
+   * @param store Convert a single sample back from double
+   */
+  template <typename T, typename Load, typename Store>
+  void Run(T* buffer, int frames, Load load, Store store);
+
+  //! Publish coefficients calculated from filters, using the current sample rate
+  void Publish();
+
+  /* ******************************************************************************************** */
+  //! Variables
+ private:
+  int sample_rate_;                          //!< Sample rate from audio samples (owned by writer)
+  std::vector<model::AudioFilter> filters_;  //!< Latest filters received (owned by writer)
+
+  //! Triple buffer for coefficients: writer fills back slot, reader uses front slot, and both
+  //! exchange their slot with the middle one through an atomic index
+  static constexpr int kDirty = 0x4;  //!< Flag to mark middle slot as updated by writer
+
+  std::array<std::vector<Coefficients>, 3> slots_;  //!< Coefficients for all bands
+  int back_;                                        //!< Slot owned by writer (SetFilters)
+  int front_;                                       //!< Slot owned by reader (Process)
+  std::atomic<int> middle_;                         //!< Slot waiting to be exchanged
+
+  std::vector<State> state_;  //!< Filter state for each band (owned by reader)
+  int bands_;                 //!< Number of bands from the last processed samples (owned by reader)
+  std::vector<double> data_;  //!< Samples converted to double (owned by reader)
+
+  Kernel kernel_;  //!< Implementation used to process samples
+
+  /* ******************************************************************************************** */
+  //! Friend class for testing purpose
+  friend class ::EqualizerTest;
+};
+
+}  // namespace audio
+#endif  // INCLUDE_AUDIO_EQUALIZER_H_
@@ -0,0 +1,157 @@
+/**
+ * \file
+ * \brief  Class for reading local files to be decoded
+ */
+
+#ifndef INCLUDE_AUDIO_FILE_INPUT_H_
+#define INCLUDE_AUDIO_FILE_INPUT_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "model/input_settings.h"
+
+namespace audio {
+
+/**
+ * @brief Read content from a local file on behalf of decoder, using one of these access modes:
+ * - Stream: file is read sequentially in large chunks into a read-ahead buffer, while kernel is
+ *   advised to prefetch the next chunk. So demuxer small reads (and short seeks while probing)
+ *   are served from memory, instead of turning each one of them into a syscall
+ * - Mmap: whole file is mapped into memory, so reading it issues no syscall at all (only page
+ *   faults, handled by kernel read-ahead)
+ *
+ * Statistics are kept for every opened file, to verify how many bytes and syscalls were needed.
+ */
+class FileInput {
+ public:
+  /**
+   * @brief Construct a new FileInput object
+   * @param settings Access mode and read-ahead size
+   */
+  explicit FileInput(const model::InputSettings& settings = model::InputSettings{});
+
+  /**
+   * @brief Destroy the FileInput object
+   */
+  virtual ~FileInput();
+
+  //! Remove these
+  FileInput(const FileInput& other) = delete;             // copy constructor
+  FileInput(FileInput&& other) = delete;                  // move constructor
+  FileInput& operator=(const FileInput& other) = delete;  // copy assignment
+  FileInput& operator=(FileInput&& other) = delete;       // move assignment
+
+  //! Counters from the current (or last) opened file
+  struct Statistics {
+    uint64_t bytes_read = 0;  //!< Bytes read from file
+    uint64_t syscalls = 0;    //!< System calls issued (open, read, advise, map, close...)
+  };
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Open file for reading (closing the previous one, if any) and reset statistics
+   * @param filepath Path to local file
+   * @return true if file was opened, false otherwise
+   */
+  bool Open(const std::string& filepath);
+
+  /**
+   * @brief Close file and release all resources from it (statistics are kept)
+   */
+  void Close();
+
+  /**
+   * @brief Read content from current offset, moving it forward
+   * @param buffer Destination for file content
+   * @param size Maximum number of bytes to read
+   * @return Number of bytes read, zero at the end of file or -1 on error
+   */
+  int Read(uint8_t* buffer, int size);
+
+  /**
+   * @brief Move current offset (no syscall is issued, as it is only used by the next read)
+   * @param offset Offset in bytes, relative to whence
+   * @param whence SEEK_SET, SEEK_CUR or SEEK_END
+   * @return New offset from the beginning of file, or -1 if it would be invalid
+   */
+  int64_t Seek(int64_t offset, int whence);
+
+  /**
+   * @brief Check if there is some file opened
+   * @return true if file is opened, false otherwise
+   */
+  bool IsOpen() const { return size_ >= 0; }
+
+  /**
+   * @brief Get file size
+   * @return Size in bytes, or -1 if there is no file opened
+   */
+  int64_t GetSize() const { return size_; }
+
+  /**
+   * @brief Get counters from the current (or last) opened file
+   * @return Statistics for file
+   */
+  const Statistics& GetStatistics() const { return statistics_; }
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  /**
+   * @brief Map whole file into memory and advise kernel about sequential access
+   * @return true if file was mapped, false otherwise
+   */
+  bool Map();
+
+  /**
+   * @brief Fill read-ahead buffer with content starting from current offset, and advise kernel
+   * to prefetch the next chunk in background
+   * @return true if buffer has some content, false at the end of file or on error
+   */
+  bool Refill();
+
+  /**
+   * @brief Copy content from file mapped into memory
+   * @param buffer Destination for file content
+   * @param size Maximum number of bytes to read
+   * @return Number of bytes read
+   */
+  int ReadFromMapping(uint8_t* buffer, int size);
+
+  /**
+   * @brief Copy content from read-ahead buffer, refilling it whenever necessary
+   * @param buffer Destination for file content
+   * @param size Maximum number of bytes to read
+   * @return Number of bytes read, or -1 on error
+   */
+  int ReadFromStream(uint8_t* buffer, int size);
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr uint32_t kMinReadAhead = 64 * 1024;  //!< Minimum read-ahead size (in bytes)
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  model::InputSettings settings_;  //!< Access mode and read-ahead size
+
+  int fd_;          //!< File descriptor (kept open only for stream access)
+  int64_t size_;    //!< File size (in bytes)
+  int64_t offset_;  //!< Current offset for next read
+
+  uint8_t* mapping_;  //!< File mapped into memory (only for mmap access)
+
+  std::vector<uint8_t> buffer_;  //!< Read-ahead buffer (only for stream access)
+  int64_t window_start_;         //!< File offset for the first byte in read-ahead buffer
+  int64_t window_size_;          //!< Number of valid bytes in read-ahead buffer
+
+  Statistics statistics_;  //!< Counters from the current (or last) opened file
+};
+
+}  // namespace audio
+#endif  // INCLUDE_AUDIO_FILE_INPUT_H_
@@ -0,0 +1,162 @@
+/**
+ * \file
+ * \brief  Class for a lock-free ring buffer holding decoded PCM frames
+ */
+
+#ifndef INCLUDE_AUDIO_PCM_RING_H_
+#define INCLUDE_AUDIO_PCM_RING_H_
+
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace audio {
+
+/**
+ * @brief Bounded single-producer/single-consumer ring buffer for interleaved PCM frames. Audio
+ * thread (producer) writes decoded frames while playback writer thread (consumer) reads them, and
+ * none of these operations will ever block on each other.
+ */
+class PcmRing {
+ public:
+  /**
+   * @brief Construct a new PcmRing object
+   * @param capacity Maximum number of frames to hold
+   * @param frame_size Size in bytes for a single frame (considering all channels)
+   */
+  PcmRing(int capacity, int frame_size)
+      : capacity_{capacity},
+        frame_size_{frame_size},
+        buffer_(static_cast<size_t>(capacity) * frame_size),
+        write_index_{0},
+        read_index_{0} {}
+
+  /**
+   * @brief Utility to calculate how many frames fit in the given duration
+   * @param duration Buffer duration
+   * @param sample_rate Number of frames per second
+   * @return int Number of frames
+   */
+  static int FramesFor(std::chrono::milliseconds duration, int sample_rate) {
+    return static_cast<int>(duration.count() * sample_rate / 1000);
+  }
+
+  /**
+   * @brief Destroy the PcmRing object
+   */
+  virtual ~PcmRing() = default;
+
+  //! Remove these
+  PcmRing(const PcmRing& other) = delete;             // copy constructor
+  PcmRing(PcmRing&& other) = delete;                  // move constructor
+  PcmRing& operator=(const PcmRing& other) = delete;  // copy assignment
+  PcmRing& operator=(PcmRing&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Producer side
+
+  /**
+   * @brief Copy as many frames as possible into ring buffer (must be called only by producer)
+   * @param data Interleaved audio frames
+   * @param frames Number of frames to write
+   * @return int Number of frames written (may be less than requested when buffer is full)
+   */
+  int Write(const void* data, int frames) {
+    uint64_t write = write_index_.load(std::memory_order_relaxed);
+    uint64_t read = read_index_.load(std::memory_order_acquire);
+
+    int count = std::min(frames, capacity_ - static_cast<int>(write - read));
+    if (count <= 0) return 0;
+
+    CopyIn(static_cast<const uint8_t*>(data), static_cast<int>(write % capacity_), count);
+
+    write_index_.store(write + count, std::memory_order_release);
+    return count;
+  }
+
+  /* ******************************************************************************************** */
+  //! Consumer side
+
+  /**
+   * @brief Copy as many frames as possible from ring buffer (must be called only by consumer)
+   * @param data Output buffer for interleaved audio frames
+   * @param frames Maximum number of frames to read
+   * @return int Number of frames read
+   */
+  int Read(void* data, int frames) {
+    uint64_t read = read_index_.load(std::memory_order_relaxed);
+    uint64_t write = write_index_.load(std::memory_order_acquire);
+
+    int count = std::min(frames, static_cast<int>(write - read));
+    if (count <= 0) return 0;
+
+    CopyOut(static_cast<uint8_t*>(data), static_cast<int>(read % capacity_), count);
+
+    read_index_.store(read + count, std::memory_order_release);
+    return count;
+  }
+
+  /**
+   * @brief Discard all frames from ring buffer (must be called only by consumer, or while consumer
+   * is known to be idle)
+   */
+  void Clear() {
+    read_index_.store(write_index_.load(std::memory_order_acquire), std::memory_order_release);
+  }
+
+  /* ******************************************************************************************** */
+  //! Getters (safe to call from any thread)
+
+  //! Number of frames currently stored in ring buffer
+  int Size() const {
+    return static_cast<int>(write_index_.load(std::memory_order_acquire) -
+                            read_index_.load(std::memory_order_acquire));
+  }
+
+  //! Maximum number of frames
+  int Capacity() const { return capacity_; }
+
+  //! Size in bytes for a single frame
+  int FrameSize() const { return frame_size_; }
+
+  //! Check if there is no frame stored
+  bool Empty() const { return Size() == 0; }
+
+  //! Check if there is no space left to store a frame
+  bool Full() const { return Size() >= capacity_; }
+
+  /* ******************************************************************************************** */
+  //! Utilities
+ private:
+  //! Copy frames into ring buffer, wrapping around when reaching the end
+  void CopyIn(const uint8_t* src, int offset, int count) {
+    int first = std::min(count, capacity_ - offset);
+    std::memcpy(&buffer_[offset * frame_size_], src, first * frame_size_);
+    std::memcpy(&buffer_[0], src + first * frame_size_, (count - first) * frame_size_);
+  }
+
+  //! Copy frames from ring buffer, wrapping around when reaching the end
+  void CopyOut(uint8_t* dst, int offset, int count) const {
+    int first = std::min(count, capacity_ - offset);
+    std::memcpy(dst, &buffer_[offset * frame_size_], first * frame_size_);
+    std::memcpy(dst + first * frame_size_, &buffer_[0], (count - first) * frame_size_);
+  }
+
+  /* ******************************************************************************************** */
+  //! Variables
+ private:
+  const int capacity_;    //!< Maximum number of frames
+  const int frame_size_;  //!< Size in bytes for a single frame
+
+  std::vector<uint8_t> buffer_;  //!< Raw storage for frames
+
+  //! Monotonic frame counters (kept in separate cache lines to avoid false sharing)
+  alignas(64) std::atomic<uint64_t> write_index_;  //!< Total frames written by producer
+  alignas(64) std::atomic<uint64_t> read_index_;   //!< Total frames read by consumer
+};
+
+}  // namespace audio
+#endif  // INCLUDE_AUDIO_PCM_RING_H_
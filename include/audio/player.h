@@ -7,19 +7,29 @@
 #define INCLUDE_AUDIO_PLAYER_H_
 
 #include <atomic>
+#include <chrono>
 #include <condition_variable>
 #include <deque>
 #include <memory>
 #include <mutex>
+#include <optional>
 #include <string>
 #include <thread>
+#include <utility>
 #include <vector>
 
 #include "audio/base/decoder.h"
 #include "audio/base/playback.h"
 #include "audio/command.h"
+#include "audio/command_queue.h"
+#include "audio/decoder_pool.h"
+#include "audio/pcm_ring.h"
 #include "model/application_error.h"
 #include "model/audio_filter.h"
+#include "model/audio_format.h"
+#include "model/input_settings.h"
+#include "model/pcm_block.h"
+#include "model/playback_settings.h"
 #include "model/song.h"
 #include "model/volume.h"
 #include "util/logger.h"
@@ -47,7 +57,10 @@ class AudioControl {
   virtual model::Volume GetAudioVolume() const = 0;
   virtual void SeekForwardPosition(int value) = 0;
   virtual void SeekBackwardPosition(int value) = 0;
+  virtual void SeekTo(std::chrono::milliseconds position) = 0;
   virtual void ApplyAudioFilters(const std::vector<model::AudioFilter>& filters) = 0;
+  virtual void SetNextSong(const std::string& filepath) = 0;
+  virtual void WarmUp(const std::vector<std::string>& filepaths) = 0;
   virtual void Exit() = 0;
 };
 
@@ -60,9 +73,13 @@ class Player : public AudioControl {
    * @brief Construct a new Player object
    * @param playback Pointer to playback interface
    * @param decoder Pointer to decoder interface
+   * @param next_decoder Pointer to decoder interface (used to pre-open next song)
+   * @param warm_up Pointer to pool of decoders warmed up in background (optional)
    */
   explicit Player(std::unique_ptr<driver::Playback>&& playback,
-                  std::unique_ptr<driver::Decoder>&& decoder);
+                  std::unique_ptr<driver::Decoder>&& decoder,
+                  std::unique_ptr<driver::Decoder>&& next_decoder,
+                  std::unique_ptr<DecoderPool>&& warm_up);
 
  public:
   /**
@@ -70,11 +87,25 @@ class Player : public AudioControl {
    * @param playback Pass playback to be used within Audio thread (optional)
    * @param decoder Pass decoder to be used within Audio thread (optional)
    * @param asynchronous Run Audio Player as a thread (default is true)
+   * @param next_decoder Pass decoder to pre-open next song within Audio thread (optional)
+   * @param warm_up Pass pool to open files in background before they are played (optional)
    * @return std::shared_ptr<Player> Player instance
    */
   static std::shared_ptr<Player> Create(driver::Playback* playback = nullptr,
                                         driver::Decoder* decoder = nullptr,
-                                        bool asynchronous = true);
+                                        bool asynchronous = true,
+                                        driver::Decoder* next_decoder = nullptr,
+                                        DecoderPool* warm_up = nullptr);
+
+  /**
+   * @brief Factory method: Create Player using custom settings for playback stream and decoders
+   * @param settings Device name and latency profile for playback stream
+   * @param input Access mode and read-ahead size for reading local files to decode
+   * @return std::shared_ptr<Player> Player instance
+   */
+  static std::shared_ptr<Player> Create(
+      const model::PlaybackSettings& settings,
+      const model::InputSettings& input = model::InputSettings{});
 
   /**
    * @brief Destroy the Player object
@@ -103,21 +134,152 @@ class Player : public AudioControl {
    */
   void ResetMediaControl(error::Code result, bool error_parsing = false);
 
+  /**
+   * @brief Keep reading decoded samples from current song and handling commands from internal
+   * queue, until song reaches its end or some command interrupts it
+   * @return error::Code Application error code
+   */
+  error::Code ReadSong();
+
   /**
    * @brief Handle an audio command from internal queue
    * @param buffer Audio buffer
    * @param size Buffer size
-   * @param new_position Latest position in the song (in seconds)
-   * @param last_position Last position to control when current position has changed
+   * @param position Position in the song of the first frame in buffer (in milliseconds)
+   * @param last_position Last position notified to UI (in milliseconds, negative to force update)
    * @return True if player should keep playing audio, False if not
    */
-  bool HandleCommand(void* buffer, int size, int64_t& new_position, int& last_position);
+  bool HandleCommand(void* buffer, int size, int64_t position, int64_t& last_position);
+
+  /**
+   * @brief Change current position in song (only if it is within song duration)
+   * @param target Desired position in song
+   * @param last_position (Out) Last position notified to UI, reset to notify the new position
+   * @return True if position has changed, False if not
+   */
+  bool SeekPosition(std::chrono::milliseconds target, int64_t& last_position);
+
+  /**
+   * @brief Update audio filters for both decoders, notifying UI in case of error (must be called
+   * only from Audio thread, as decoders may be equalizing samples right now)
+   * @param filters Vector of audio filters
+   */
+  void UpdateDecoderFilters(const std::vector<model::AudioFilter>& filters);
+
+  /**
+   * @brief Apply volume and audio filters received while Audio thread was blocked waiting for
+   * some command (if any)
+   */
+  void ApplyDeferredSettings();
+
+  /**
+   * @brief Convert song position to seconds
+   * @param position Position in song (in milliseconds)
+   * @return Position in song (in seconds)
+   */
+  static int64_t ToSeconds(int64_t position) {
+    return std::chrono::duration_cast<std::chrono::seconds>(std::chrono::milliseconds{position})
+        .count();
+  }
+
+  /**
+   * @brief Set song to be played right after the current one (discarding any previous one), and
+   * start opening it in background (in case that there is a warm-up thread)
+   * @param filepath Full path to file (empty clears it)
+   */
+  void SetNextSongInternal(const std::string& filepath);
+
+  /**
+   * @brief Make next song (if any) ready to be decoded as soon as current song finishes. Decoder
+   * opened by warm-up thread is taken whenever available, otherwise file is opened right now by
+   * the spare decoder
+   * @param wait Block until next song is ready (otherwise, just check if warm-up thread is done)
+   */
+  void PreloadNextSong(bool wait);
+
+  /**
+   * @brief Swap decoders to continue decoding the pre-opened next song, keeping playback stream
+   * open (so there is no gap between songs)
+   * @return True if there was a next song to play, False if not
+   */
+  bool SwitchToNextSong();
+
+  /**
+   * @brief Discard next song (closing it in case it was already opened by spare decoder)
+   */
+  void ClearNextSong();
+
+  /**
+   * @brief Replace decoder by the one warmed up in background for current song (if any), so there
+   * is no need to open it again. Samples already decoded by it are kept to be played first
+   * @return Audio format used by decoder warmed up, or nothing if there was none for this song
+   */
+  std::optional<model::AudioFormat> TakeWarmedUp();
+
+  /**
+   * @brief Choose audio format to play song, based on song properties and on what playback stream
+   * supports (keeping song sample rate and bit depth whenever possible, to avoid conversions)
+   * @param song Song information (filled by decoder)
+   * @return Audio format to use for decoded samples
+   */
+  model::AudioFormat NegotiateFormat(const model::Song& song) const;
+
+  /**
+   * @brief Change audio format used by decoders and playback stream (must be called only while
+   * playback stream is stopped). In case that playback stream does not accept it, current format
+   * is kept
+   * @param format Audio format
+   * @return error::Code Application error code
+   */
+  error::Code ConfigureOutput(const model::AudioFormat& format);
 
   /**
    * @brief Main-loop function to decode input stream and write to playback stream
    */
   void AudioHandler();
 
+  /**
+   * @brief Main-loop function to drain decoded audio from ring buffer into playback stream (only
+   * executed when Player runs asynchronously)
+   */
+  void PlaybackWriter();
+
+  /**
+   * @brief Keep a copy from samples just written into playback stream, and send to interface (for
+   * audio analysis) only those that are being heard right now (called only from writer thread)
+   * @param data Interleaved frames written into playback stream
+   * @param frames Number of frames
+   * @param format Audio format used by frames
+   */
+  void ReleaseAnalysis(const void* data, int frames, const model::AudioFormat& format);
+
+  /* ******************************************************************************************** */
+  //! Decode-ahead control (all of these are called only from Audio thread)
+ private:
+  /**
+   * @brief Send decoded samples to playback, either directly or through the decode-ahead buffer
+   * (blocking only while buffer is full)
+   * @param buffer Audio buffer
+   * @param size Buffer size (in frames)
+   */
+  void WritePlayback(void* buffer, int size);
+
+  /**
+   * @brief Start (or resume) writing buffered samples into playback stream
+   */
+  void ResumePlayback();
+
+  /**
+   * @brief Block until writer thread is idle, so it is safe to change playback stream state
+   * @param drop Discard samples still waiting in the decode-ahead buffer
+   */
+  void HoldPlayback(bool drop);
+
+  /**
+   * @brief Block until writer thread has written all buffered samples into playback stream
+   */
+  void FlushPlayback();
+
   /* ******************************************************************************************** */
   //! Binds and registrations
  public:
@@ -170,17 +332,55 @@ class Player : public AudioControl {
    */
   void SeekBackwardPosition(int value) override;
 
+  /**
+   * @brief Inform audio loop to seek an absolute position on current playing song
+   * @param position Exact position in song
+   */
+  void SeekTo(std::chrono::milliseconds position) override;
+
   /**
    * @brief Inform audio loop to update audio filters in the filter chain
    * @param frequencies Vector of audio filters
    */
   void ApplyAudioFilters(const std::vector<model::AudioFilter>& filters) override;
 
+  /**
+   * @brief Inform audio loop which song should be played right after the current one, without any
+   * gap between them (empty filepath clears it)
+   * @param filepath Full path to file
+   */
+  void SetNextSong(const std::string& filepath) override;
+
+  /**
+   * @brief Open these files in background, as user will probably play one of them soon (first one
+   * has the highest priority)
+   * @param filepaths List of full paths to files
+   */
+  void WarmUp(const std::vector<std::string>& filepaths) override;
+
   /**
    * @brief Exit from Audio loop
    */
   void Exit() override;
 
+  /* ******************************************************************************************** */
+  //! Decode-ahead status
+ public:
+  /**
+   * @brief Snapshot from decode-ahead buffer (all values are in frames)
+   */
+  struct BufferStatus {
+    int capacity;        //!< Maximum number of frames in buffer
+    int filled;          //!< Frames waiting to be written into playback
+    uint64_t underruns;  //!< Number of times the writer found buffer empty while playing
+  };
+
+  /**
+   * @brief Get current status from decode-ahead buffer (safe to call from any thread)
+   * @return Buffer status (zeroed when Player is not running asynchronously)
+   */
+  BufferStatus GetBufferStatus() const;
+
   /* ******************************************************************************************** */
   //! Custom class for blocking actions
  private:
@@ -230,67 +430,97 @@ class Player : public AudioControl {
    * audio when it is paused)
    */
   struct MediaControlSynced {
-    std::mutex mutex;                  //!< Control access for internal resources
+    std::mutex mutex;                  //!< Used only to block thread while waiting for commands
     std::condition_variable notifier;  //!< Conditional variable to block thread
 
-    std::deque<Command> queue;  //!< Queue with media control commands
-    std::atomic<State> state;   //!< Current state
+    CommandQueue queue{CommandQueue::kDefaultCapacity};  //!< Lock-free queue with media commands
+    std::atomic<State> state;                            //!< Current state
+
+    //! Next song received while blocked on WaitFor (used only by Audio thread)
+    std::optional<std::string> next_song;
+
+    //! Audio filters received while blocked on WaitFor (used only by Audio thread)
+    std::optional<std::vector<model::AudioFilter>> filters;
+
+    //! Volume received while blocked on WaitFor (used only by Audio thread)
+    std::optional<model::Volume> volume;
 
     /**
-     * @brief Reset media controls
+     * @brief Reset media controls (must be called only from Audio thread)
      */
     void Reset() {
-      // Copy queue and clear it
-      std::deque<Command> dummy;
-      dummy.swap(queue);
+      if (state == State::Exit) {
+        queue.Clear();
+        return;
+      }
 
-      if (state != State::Exit) {
-        // Set state to idle
-        state = State::Idle;
+      // Set state to idle
+      state = State::Idle;
 
-        // Re-add to queue only new requests to play song
-        std::copy_if(dummy.begin(), dummy.end(), std::back_inserter(queue),
-                     [](Command c) { return c == Command::Identifier::Play; });
-      }
+      // Keep in queue only new requests to play song (and which one should come next), besides
+      // audio filters and volume, which must still be applied to decoders
+      queue.Retain([](const Command& c) {
+        return c == Command::Identifier::Play || c == Command::Identifier::SetNextSong ||
+               c == Command::Identifier::UpdateAudioFilters || c == Command::Identifier::SetVolume;
+      });
     }
 
     /**
-     * @brief Push command to media control queue
+     * @brief Push command to media control queue (without blocking)
      * @param cmd Media command
      */
-    void Push(const Command& cmd) {
-      {
-        std::unique_lock<std::mutex> lock(mutex);
-
-        // Clear queue in case of exit request
-        if (cmd == Command::Identifier::Exit) {
-          std::deque<Command>().swap(queue);
-          state = State::Exit;
-        }
+    void Push(Command cmd) {
+      // Exit must never be lost, so state is updated right away (and Audio thread will ignore
+      // anything else left in queue)
+      if (cmd == Command::Identifier::Exit) state = State::Exit;
 
-        queue.push_back(std::move(cmd));
+      if (!queue.Push(std::move(cmd))) {
+        ERROR("Media control queue is full, discarding command");
       }
+
+      // Taking the lock avoids a lost wake-up against WaitFor
+      { std::scoped_lock<std::mutex> lock(mutex); }
       notifier.notify_one();
     }
 
     /**
-     * @brief Pop command from media control queue
+     * @brief Pop command from media control queue (must be called only from Audio thread)
      * @return Media command
      */
     Command Pop() {
-      std::unique_lock<std::mutex> lock(mutex);
-      if (queue.empty()) return Command::None();
+      // Cheap check, as this is called for every chunk of decoded samples
+      if (!queue.Pending()) return Command::None();
+
+      return queue.Pop();
+    }
 
-      auto cmd = queue.front();
-      queue.pop_front();
+    /**
+     * @brief Take next song received while blocked on WaitFor (must be called only from Audio
+     * thread)
+     * @return Full path to file, or nothing if no next song was received
+     */
+    std::optional<std::string> TakeNextSong() { return std::exchange(next_song, std::nullopt); }
 
-      return cmd;
+    /**
+     * @brief Take audio filters received while blocked on WaitFor (must be called only from Audio
+     * thread)
+     * @return Vector of audio filters, or nothing if no update was received
+     */
+    std::optional<std::vector<model::AudioFilter>> TakeFilters() {
+      return std::exchange(filters, std::nullopt);
     }
 
+    /**
+     * @brief Take volume received while blocked on WaitFor (must be called only from Audio thread)
+     * @return Sound volume, or nothing if no update was received
+     */
+    std::optional<model::Volume> TakeVolume() { return std::exchange(volume, std::nullopt); }
+
     /**
      * @brief Block thread until user interface sends events matching the expected command(s). As
      * this is a blocking operation, when one of the expected commands matches with the one from
-     * queue, media control state is updated.
+     * queue, media control state is updated. Any other command is discarded, except for next song,
+     * audio filters and volume (kept to be taken afterwards).
      *
      * @tparam Args Media command
      * @param cmds Command list
@@ -306,24 +536,33 @@ class Player : public AudioControl {
 
         // Pop commands from queue
         std::vector<Command> expected = {cmds...};
-        while (!queue.empty()) {
-          Command current = queue.front();
-          LOG("Received command:", current);
+        while (Command* current = queue.Peek()) {
+          LOG("Received command:", *current);
 
-          if (current == Command::Exit()) {
+          if (*current == Command::Exit()) {
             // In case of exit, update state
-            state = TranslateCommand(current);
+            state = TranslateCommand(*current);
             return true;
           }
 
           // Check if it matches with some command from list
-          if (std::find(expected.begin(), expected.end(), current) != expected.end()) {
+          if (std::find(expected.begin(), expected.end(), *current) != expected.end()) {
             // Found expected command, now unblock thread
             return true;
           }
 
+          // Next song, audio filters and volume must not be lost, keep the latest ones to be
+          // applied after waiting
+          if (*current == Command::Identifier::SetNextSong) {
+            next_song = current->GetContent<std::string>();
+          } else if (*current == Command::Identifier::UpdateAudioFilters) {
+            filters = current->GetContent<std::vector<model::AudioFilter>>();
+          } else if (*current == Command::Identifier::SetVolume) {
+            volume = current->GetContent<model::Volume>();
+          }
+
           // Pop command from queue
-          queue.pop_front();
+          queue.Discard();
         }
 
         // No command in queue or didn't match expect command in list
@@ -334,22 +573,114 @@ class Player : public AudioControl {
     }
   };
 
+  /**
+   * @brief An structure to synchronize Audio thread (producer) with playback writer thread
+   * (consumer). Samples are exchanged through a lock-free ring buffer, while the mutex is used only
+   * to change writer state or to sleep while there is nothing to do.
+   */
+  struct DecodeAheadSynced {
+    mutable std::mutex mutex;          //!< Control access for writer state
+    std::condition_variable notifier;  //!< Wake up writer (new samples or state changed)
+    std::condition_variable space;     //!< Wake up Audio thread (samples consumed or writer idle)
+
+    //! Decoded samples waiting to be written into playback (replaced only while writer is on hold)
+    std::unique_ptr<PcmRing> ring;
+
+    bool running = false;   //!< Writer is allowed to write into playback stream
+    bool writing = false;   //!< Writer is currently writing into playback stream
+    bool primed = false;    //!< Writer has written something since last resume
+    bool flushing = false;  //!< Decoder has finished, writer is consuming remaining samples
+    bool exit = false;      //!< Writer thread must finish
+
+    std::atomic<uint64_t> underruns{0};  //!< Buffer found empty while playing
+
+    /**
+     * @brief Wake up writer thread (taking the lock avoids a lost wake-up against its wait)
+     */
+    void Notify() {
+      { std::scoped_lock<std::mutex> lock(mutex); }
+      notifier.notify_one();
+    }
+  };
+
+  /**
+   * @brief Samples already written into playback stream, but held back from audio analysis until
+   * they are actually heard (otherwise, spectrum would run ahead of music by the playback latency).
+   * Used only by writer thread, or by Audio thread while writer is on hold.
+   */
+  struct AnalysisDelay {
+    //! Chunk of samples written at once into playback stream
+    struct Chunk {
+      uint64_t start = 0;            //!< Position (in frames written) of its first frame
+      int frames = 0;                //!< Number of frames
+      model::AudioFormat format;     //!< Audio format used by frames
+      std::vector<uint8_t> samples;  //!< Interleaved frames
+    };
+
+    std::deque<Chunk> pending;  //!< Chunks not heard yet (oldest first)
+    std::vector<Chunk> spare;   //!< Chunks already released, kept to reuse their memory
+    uint64_t written = 0;       //!< Total frames written since playback stream was prepared
+
+    /**
+     * @brief Discard pending chunks (must be called whenever playback stream is prepared again)
+     */
+    void Reset() {
+      for (auto& chunk : pending) spare.push_back(std::move(chunk));
+      pending.clear();
+      written = 0;
+    }
+  };
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+ private:
+  static constexpr int kWriterPeriod = 1024;  //!< Frames per read/write, if period size is unknown
+
+  //! Amount of decoded audio kept ahead of playback
+  static constexpr std::chrono::milliseconds kDecodeAhead{500};
+
+  //! Remaining time (in seconds) from current song to start opening next song
+  static constexpr int kPreloadNextSong = 5;
+
+  //! Memory budget for decoders warmed up in background (in bytes)
+  static constexpr size_t kWarmUpBudget = 16 * 1024 * 1024;
+
+  //! Estimated memory usage for an opened decoder, besides its read-ahead buffer (in bytes)
+  static constexpr size_t kWarmUpOverhead = 1024 * 1024;
+
   /* ******************************************************************************************** */
   //! Variables
  private:
-  std::unique_ptr<driver::Playback> playback_;  //!< Handle playback stream
-  std::unique_ptr<driver::Decoder> decoder_;    //!< Open file as input stream and parse samples
+  std::unique_ptr<driver::Playback> playback_;     //!< Handle playback stream
+  std::unique_ptr<driver::Decoder> decoder_;       //!< Open file as input stream and parse samples
+  std::unique_ptr<driver::Decoder> next_decoder_;  //!< Spare decoder to pre-open next song
+  std::unique_ptr<DecoderPool> warm_up_;           //!< Decoders opened in background
 
-  std::thread audio_loop_;  //!< Execute audio-loop function as a thread
+  std::thread audio_loop_;    //!< Execute audio-loop function as a thread
+  std::thread audio_writer_;  //!< Execute playback writer function as a thread
 
   MediaControlSynced media_control_;  // Controls the media (play, pause/resume and stop)
+  DecodeAheadSynced decode_ahead_;    // Decoded samples waiting for playback
+  AnalysisDelay analysis_delay_;      // Samples waiting to be heard before audio analysis
 
   std::unique_ptr<model::Song> curr_song_;  //!< Current song playing
+  std::unique_ptr<model::Song> next_song_;  //!< Song to play right after the current one
+  bool next_song_ready_;                    //!< Next song is already opened by spare decoder
+  std::optional<model::AudioFormat> next_format_;  //!< Format used to warm up next song (if so)
+
+  std::deque<DecoderPool::Chunk> preroll_;       //!< Samples decoded in background for current song
+  std::deque<DecoderPool::Chunk> next_preroll_;  //!< Samples decoded in background for next song
 
   std::weak_ptr<interface::Notifier> notifier_;  //!< Send notifications to interface
 
   int period_size_;  //!< Period size from Playback driver
 
+  driver::Playback::Capabilities capabilities_;  //!< Formats and rates supported by playback
+  model::AudioFormat format_;                    //!< Current format for decoded samples
+  model::PlaybackSettings settings_;             //!< Values negotiated with playback device
+
+  std::atomic<model::Volume> volume_;  //!< Last volume set (applied to decoders by Audio thread)
+
   /* ******************************************************************************************** */
   //! Friend class for testing purpose
   friend class ::PlayerTest;
@@ -15,8 +15,10 @@
 
 #include "audio/base/analyzer.h"
 #include "audio/base/notifier.h"
+#include "audio/analysis_ring.h"
 #include "audio/player.h"
 #include "model/application_error.h"
+#include "model/pcm_block.h"
 #include "model/song.h"
 #include "view/base/event_dispatcher.h"
 #include "view/base/notifier.h"
@@ -45,6 +47,15 @@ namespace middleware {
  * Audio Notifier (UI->Player) and Interface Notifier (Player->UI).
  */
 class MediaController : public audio::Notifier, public interface::Notifier {
+ public:
+  //! Statistics from audio analysis
+  struct AnalysisStatistics {
+    double rate = 0;       //!< Effective number of analyses per second
+    uint64_t skipped = 0;  //!< Frames received but never analyzed, as a newer window was available
+    uint64_t dropped = 0;  //!< Frames overwritten before analysis thread could read them
+  };
+
+ private:
   /**
    * @brief Construct a new MediaController object
    * @param dispatcher Event dispatcher for Interface
@@ -79,6 +90,19 @@ class MediaController : public audio::Notifier, public interface::Notifier {
    */
   void Exit();
 
+  /**
+   * @brief Set target rate for audio analysis (any frames received in between are analyzed all
+   * at once, as a single update to UI)
+   * @param rate Maximum number of analyses per second
+   */
+  void SetAnalysisRate(int rate);
+
+  /**
+   * @brief Get statistics from audio analysis (safe to call from any thread)
+   * @return Analysis statistics
+   */
+  AnalysisStatistics GetAnalysisStatistics() const;
+
   /* ******************************************************************************************** */
   //! Internal operations
  private:
@@ -143,12 +167,30 @@ class MediaController : public audio::Notifier, public interface::Notifier {
    */
   void SeekBackwardPosition(int value) override;
 
+  /**
+   * @brief Notify Audio Player to seek an absolute position in current playing song
+   * @param position Exact position in song
+   */
+  void SeekTo(std::chrono::milliseconds position) override;
+
   /**
    * @brief Notify Audio Player to apply audio filters in the audio chain
    * @param frequencies Vector of audio filters
    */
   void ApplyAudioFilters(const std::vector<model::AudioFilter>& frequencies) override;
 
+  /**
+   * @brief Notify Audio Player to open these files in background
+   * @param files List of full paths to files
+   */
+  void WarmUpFiles(const std::vector<std::filesystem::path>& files) override;
+
+  /**
+   * @brief Notify Audio Player about file to be played right after the current song
+   * @param file Full path to file (empty to clear it)
+   */
+  void SetNextSong(const std::filesystem::path& file) override;
+
   /* ******************************************************************************************** */
   //! Actions received from Player and sent to UI
 
@@ -172,10 +214,21 @@ class MediaController : public audio::Notifier, public interface::Notifier {
 
   /**
    * @brief Send raw audio samples to UI
-   * @param buffer Audio samples
-   * @param buff_size Sample count
+   * @param block Audio samples (only valid during this call)
+   */
+  void SendAudioRaw(const model::PcmBlock& block) override;
+
+  /**
+   * @brief Update audio analysis to consider audio format from samples sent by Audio player
+   * @param format Audio format negotiated between decoder and playback
    */
-  void SendAudioRaw(uint8_t* buffer, int buffer_size) override;
+  void NotifyAudioFormat(const model::AudioFormat& format) override;
+
+  /**
+   * @brief Notify UI with settings negotiated with playback device (e.g. latency)
+   * @param settings Playback settings
+   */
+  void NotifyPlaybackSettings(const model::PlaybackSettings& settings) override;
 
   /**
    * @brief Notify UI with error code from some background operation
@@ -196,6 +249,8 @@ class MediaController : public audio::Notifier, public interface::Notifier {
     RunClearAnimationWithoutRegain = 10003,
     RunRegainAnimation = 10004,
     Exit = 10005,
+    SetSampleRate = 10006,
+    ResizeOutput = 10007,
   };
 
   /**
@@ -207,41 +262,57 @@ class MediaController : public audio::Notifier, public interface::Notifier {
     std::condition_variable notifier;  //!< Conditional variable to block thread
 
     std::queue<Command> queue;  //!< Queue with media control commands
+    bool analysis_pending = false;  //!< Command to analyze audio data is already in queue
+    int sample_rate = 0;            //!< Latest sample rate received from Audio Player
+    int output_size = 0;            //!< Latest output size requested by UI
+
+    //! Frames kept for audio analysis (more than enough for the largest FFT window)
+    static constexpr int kCapacity = 16384;
 
-    std::vector<double> buffer;  //!< Input buffer with raw audio data
+    audio::AnalysisRing ring{kCapacity};  //!< Input buffer with raw audio data per channel
 
     /**
-     * @brief Get a slice from raw audio data to run frequency analysis
+     * @brief Get the most recent slice from raw audio data to run frequency analysis, skipping
+     * anything older than that (ring buffer is read without locking, as only analysis thread does
+     * it)
      *
-     * @param size Chunk size
-     * @return Vector containing raw audio data
+     * @param frames Maximum number of frames
+     * @param left Output with raw audio data from left channel
+     * @param right Output with raw audio data from right channel
+     * @param skipped Incremented by the number of frames skipped
+     * @return Number of frames
      */
-    const std::vector<double> GetBuffer(int size) {
-      std::unique_lock<std::mutex> lock(mutex);
-      if (size > buffer.size()) size = (int)buffer.size();
-
-      std::vector<double>::const_iterator first = buffer.begin();
-      std::vector<double>::const_iterator last = buffer.begin() + size;
-
-      std::vector<double> output(first, last);
-      buffer.erase(first, last);
+    int GetBuffer(int frames, float* left, float* right, uint64_t& skipped) {
+      {
+        // From now on, any data appended needs a new command to be analyzed
+        std::unique_lock<std::mutex> lock(mutex);
+        analysis_pending = false;
+      }
 
-      return output;
+      skipped += ring.Keep(frames);
+      return ring.Read(left, right, frames);
     }
 
     /**
-     * @brief Append raw audio data sent by Audio Player to internal buffer
+     * @brief Append raw audio data sent by Audio Player to internal buffer (samples are converted
+     * straight into planar channels, in the same layout used by audio analysis). A command to
+     * analyze them is pushed only if there is none waiting already, so any backlog is collapsed
+     * into a single analysis.
      *
-     * @param input Array with raw data
-     * @param size Array size
+     * @param block Audio samples
      */
-    void Append(uint8_t* input, int size) {
-      std::unique_lock<std::mutex> lock(mutex);
-      std::vector<double>::const_iterator end = buffer.end();
+    void Append(const model::PcmBlock& block) {
+      if (block.frames <= 0) return;
 
-      buffer.insert(end, (int*)input, (int*)input + size);
+      ring.Write(block);
 
-      queue.push(Command::Analyze);
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        if (analysis_pending) return;
+
+        analysis_pending = true;
+        queue.push(Command::Analyze);
+      }
       notifier.notify_one();
     }
 
@@ -256,6 +327,7 @@ class MediaController : public audio::Notifier, public interface::Notifier {
         // Clear queue in case of exit request
         if (cmd == Command::Exit) {
           std::queue<Command>().swap(queue);
+          analysis_pending = false;
         }
 
         queue.push(std::move(cmd));
@@ -263,6 +335,52 @@ class MediaController : public audio::Notifier, public interface::Notifier {
       notifier.notify_one();
     }
 
+    /**
+     * @brief Keep sample rate received from Audio Player and push command to apply it, so analyzer
+     * is only changed by analysis thread (between two analyses)
+     * @param value Sample rate
+     */
+    void SetSampleRate(int value) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        sample_rate = value;
+        queue.push(Command::SetSampleRate);
+      }
+      notifier.notify_one();
+    }
+
+    /**
+     * @brief Get latest sample rate received from Audio Player
+     * @return Sample rate
+     */
+    int GetSampleRate() {
+      std::unique_lock<std::mutex> lock(mutex);
+      return sample_rate;
+    }
+
+    /**
+     * @brief Keep output size requested by UI and push command to apply it, so analyzer is only
+     * re-initialized by analysis thread (between two analyses)
+     * @param value Output size (number of bars)
+     */
+    void ResizeOutput(int value) {
+      {
+        std::unique_lock<std::mutex> lock(mutex);
+        output_size = value;
+        queue.push(Command::ResizeOutput);
+      }
+      notifier.notify_one();
+    }
+
+    /**
+     * @brief Get latest output size requested by UI
+     * @return Output size (number of bars)
+     */
+    int GetOutputSize() {
+      std::unique_lock<std::mutex> lock(mutex);
+      return output_size;
+    }
+
     /**
      * @brief Pop command from media controller queue
      * @return Command
@@ -300,12 +418,12 @@ class MediaController : public audio::Notifier, public interface::Notifier {
 
     /**
      * @brief Block thread until player sends a command or reaches timeout
-     * @param timeout Timestamp deadline
+     * @param timeout Timestamp deadline (on steady clock, not affected by wall clock changes)
      *
      * @return True if thread unlocked by command, False if reached timeout
      */
     bool WaitForCommandOrUntil(
-        const std::chrono::time_point<std::chrono::system_clock,
+        const std::chrono::time_point<std::chrono::steady_clock,
                                       std::chrono::duration<long double, std::nano>>& timeout) {
       std::unique_lock<std::mutex> lock(mutex);
       notifier.wait_until(lock, timeout, [&]() {
@@ -319,6 +437,11 @@ class MediaController : public audio::Notifier, public interface::Notifier {
     }
   };
 
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr int kAnalysisRate = 60;  //!< Target rate for audio analysis (in Hz)
+
   /* ******************************************************************************************** */
   //! Utility
 
@@ -337,6 +460,10 @@ class MediaController : public audio::Notifier, public interface::Notifier {
 
   AnalysisDataSynced sync_data_;  //!< Controls the audio data synchronization
 
+  std::atomic<int> analysis_rate_;        //!< Target rate for audio analysis (in Hz)
+  std::atomic<double> effective_rate_;    //!< Measured rate for audio analysis (in Hz)
+  std::atomic<uint64_t> skipped_frames_;  //!< Frames skipped by audio analysis
+
   /* ******************************************************************************************** */
   //! Friend class for testing purpose
   friend class ::MediaControllerTest;
@@ -0,0 +1,197 @@
+/**
+ * \file
+ * \brief  Class for media library index
+ */
+
+#ifndef INCLUDE_MIDDLEWARE_MEDIA_LIBRARY_H_
+#define INCLUDE_MIDDLEWARE_MEDIA_LIBRARY_H_
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <shared_mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include "model/application_error.h"
+#include "model/song.h"
+
+namespace middleware {
+
+/**
+ * @brief Persistent index with metadata from all files found under a music directory. Scanning
+ * walks the directory tree in background, and a pool of worker threads probes every new or modified
+ * file (as probing is mostly waiting for I/O). Files are identified by path, and only probed again
+ * when their size or modification time changes, so a rescan of a large library is cheap.
+ *
+ * Index is kept in memory for constant time lookups (so UI can show song information without
+ * opening any file), and saved to disk in a compact binary format after each scan.
+ */
+class MediaLibrary {
+ public:
+  //! Extract metadata from file (filepath is already set on song)
+  using Probe = std::function<error::Code(model::Song&)>;
+
+  //! Counters from the last scan
+  struct Statistics {
+    size_t files = 0;      //!< Regular files found in directory tree
+    size_t probed = 0;     //!< Files probed (new or modified since last scan)
+    size_t unchanged = 0;  //!< Files skipped, as index is already up-to-date for them
+    size_t failed = 0;     //!< Files probed but not supported
+    size_t removed = 0;    //!< Entries removed from index, as files do not exist anymore
+
+    //! Overloaded operators
+    bool operator==(const Statistics& other) const;
+  };
+
+ private:
+  /**
+   * @brief Construct a new MediaLibrary object
+   * @param index_path Path to index file on disk
+   * @param probe Function to extract metadata from file
+   * @param workers Number of worker threads to probe files
+   */
+  MediaLibrary(const std::filesystem::path& index_path, Probe probe, unsigned workers);
+
+ public:
+  /**
+   * @brief Factory method: Create library and load index from disk (if there is any)
+   * @param index_path Path to index file on disk
+   * @param probe Function to extract metadata from file (optional, default is FFmpeg)
+   * @param workers Number of worker threads to probe files (zero means one for each core)
+   * @return std::unique_ptr<MediaLibrary> MediaLibrary instance
+   */
+  static std::unique_ptr<MediaLibrary> Create(const std::filesystem::path& index_path,
+                                              Probe probe = nullptr, unsigned workers = 0);
+
+  /**
+   * @brief Destroy the MediaLibrary object (cancelling any scan in progress)
+   */
+  virtual ~MediaLibrary();
+
+  //! Remove these
+  MediaLibrary(const MediaLibrary& other) = delete;             // copy constructor
+  MediaLibrary(MediaLibrary&& other) = delete;                  // move constructor
+  MediaLibrary& operator=(const MediaLibrary& other) = delete;  // copy assignment
+  MediaLibrary& operator=(MediaLibrary&& other) = delete;       // move assignment
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Load index from disk, replacing the one in memory
+   * @return error::Code Application error code
+   */
+  error::Code Load();
+
+  /**
+   * @brief Save index to disk (written to a temporary file first, so a crash never leaves a
+   * truncated index behind)
+   * @return error::Code Application error code
+   */
+  error::Code Save() const;
+
+  /**
+   * @brief Start scanning directory tree in background (cancelling any scan in progress). Once
+   * finished, entries for files that do not exist anymore are removed and index is saved to disk
+   * @param root Root directory to scan
+   */
+  void Scan(const std::filesystem::path& root);
+
+  /**
+   * @brief Cancel scan in progress (files already probed are kept and saved to disk)
+   */
+  void Cancel();
+
+  /**
+   * @brief Block until scan in progress is finished
+   */
+  void Wait();
+
+  /**
+   * @brief Check if there is some scan in progress
+   * @return true if scanning, otherwise false
+   */
+  bool IsScanning() const { return scanning_; }
+
+  /**
+   * @brief Find metadata for file
+   * @param filepath Full path to file
+   * @return Song information, or nothing if file is not indexed or not supported
+   */
+  std::optional<model::Song> Find(const std::filesystem::path& filepath) const;
+
+  /**
+   * @brief Get number of entries in index (including files not supported)
+   * @return Number of entries
+   */
+  size_t Size() const;
+
+  /**
+   * @brief Get counters from the last scan
+   * @return Statistics for scan
+   */
+  Statistics GetStatistics() const;
+
+  /* ******************************************************************************************** */
+  //! Internal operations
+ private:
+  //! Entry in index for a single file
+  struct Record {
+    uint64_t size = 0;       //!< File size (in bytes)
+    int64_t mtime = 0;       //!< Last modification time (in file clock ticks)
+    bool supported = false;  //!< File was probed successfully
+    model::Song song;        //!< Song information (only filled if supported)
+  };
+
+  //! File waiting to be probed
+  struct Pending {
+    std::string filepath;  //!< Full path to file
+    uint64_t size;         //!< File size (in bytes)
+    int64_t mtime;         //!< Last modification time (in file clock ticks)
+  };
+
+  /**
+   * @brief Main function for scan thread: walk directory tree, probe files in parallel and remove
+   * stale entries
+   * @param root Root directory to scan
+   */
+  void Walk(const std::filesystem::path& root);
+
+  /**
+   * @brief Main function for worker threads: probe files until there is nothing left
+   * @param queue Files to probe
+   * @param next Index for the next file to probe (shared among workers)
+   */
+  void Worker(const std::vector<Pending>& queue, std::atomic<size_t>& next);
+
+  /* ******************************************************************************************** */
+  //! Default Constants
+
+  static constexpr uint32_t kMagic = 0x4c505353;  //!< Index file identifier ("SSPL")
+  static constexpr uint32_t kVersion = 1;         //!< Index file format version
+  static constexpr unsigned kMaxWorkers = 8;      //!< Maximum number of workers when on auto
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  std::filesystem::path index_path_;  //!< Path to index file on disk
+  Probe probe_;                       //!< Extract metadata from file
+  unsigned workers_;                  //!< Number of worker threads to probe files
+
+  mutable std::shared_mutex mutex_;                  //!< Control access for index and statistics
+  std::unordered_map<std::string, Record> records_;  //!< Index, where key is the full path
+  Statistics statistics_;                            //!< Counters from the last scan
+
+  std::atomic<bool> cancel_ = false;    //!< Scan in progress must finish as soon as possible
+  std::atomic<bool> scanning_ = false;  //!< Scan in progress
+  std::thread scanner_;                 //!< Execute scan function as a thread
+};
+
+}  // namespace middleware
+#endif  // INCLUDE_MIDDLEWARE_MEDIA_LIBRARY_H_
@@ -0,0 +1,50 @@
+/**
+ * \file
+ * \brief  Base class for an audio format
+ */
+
+#ifndef INCLUDE_MODEL_AUDIO_FORMAT_H_
+#define INCLUDE_MODEL_AUDIO_FORMAT_H_
+
+#include <cstdint>
+#include <ostream>
+
+namespace model {
+
+/**
+ * @brief Format used for interleaved audio samples exchanged between decoder and playback (it is
+ * negotiated for each song, based on song properties and on what playback device supports)
+ */
+struct AudioFormat {
+  //! Sample format (always interleaved and native endianness)
+  enum class SampleFormat {
+    S16 = 3001,    //!< Signed 16-bit
+    S32 = 3002,    //!< Signed 32-bit
+    Float = 3003,  //!< 32-bit float
+  };
+
+  SampleFormat sample_format = SampleFormat::S16;  //!< Sample format
+  uint32_t sample_rate = 44100;                    //!< Number of frames per second
+  uint16_t channels = 2;                           //!< Number of channels
+
+  /**
+   * @brief Get size in bytes for a single sample
+   * @return Sample size
+   */
+  int GetSampleSize() const { return sample_format == SampleFormat::S16 ? 2 : 4; }
+
+  /**
+   * @brief Get size in bytes for a single frame (considering all channels)
+   * @return Frame size
+   */
+  int GetFrameSize() const { return GetSampleSize() * channels; }
+
+  //! Overloaded operators
+  friend std::ostream& operator<<(std::ostream& out, const SampleFormat& s);
+  friend std::ostream& operator<<(std::ostream& out, const AudioFormat& a);
+  bool operator==(const AudioFormat& other) const;
+  bool operator!=(const AudioFormat& other) const;
+};
+
+}  // namespace model
+#endif  // INCLUDE_MODEL_AUDIO_FORMAT_H_
@@ -0,0 +1,62 @@
+/**
+ * \file
+ * \brief  Base class for input settings
+ */
+
+#ifndef INCLUDE_MODEL_INPUT_SETTINGS_H_
+#define INCLUDE_MODEL_INPUT_SETTINGS_H_
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+
+namespace model {
+
+/**
+ * @brief Settings for reading and decoding local files, chosen by user
+ */
+struct InputSettings {
+  //! Strategy to read file content
+  enum class Access {
+    Stream = 5001,  //!< Default value, sequential reads using a large read-ahead buffer
+    Mmap = 5002,    //!< Map whole file into memory, so reading it issues no syscall at all
+  };
+
+  //! Implementation used to equalize decoded samples
+  enum class Equalizer {
+    Filter = 5101,  //!< Default value, one "equalizer" filter from libavfilter for each band
+    Native = 5102,  //!< Cascade of biquad filters running all bands in a single pass
+  };
+
+  static constexpr uint32_t kDefaultReadAhead = 1024 * 1024;  //!< Default read-ahead (in bytes)
+
+  Access access = Access::Stream;          //!< Access mode
+  uint32_t read_ahead = kDefaultReadAhead;  //!< Read-ahead buffer size for stream (in bytes)
+  uint32_t threads = 0;                     //!< Thread budget for decoder (zero means auto)
+  Equalizer equalizer = Equalizer::Filter;  //!< Equalizer implementation
+
+  //! Overloaded operators
+  friend std::ostream& operator<<(std::ostream& out, const Access& a);
+  friend std::ostream& operator<<(std::ostream& out, const Equalizer& e);
+  friend std::ostream& operator<<(std::ostream& out, const InputSettings& s);
+  bool operator==(const InputSettings& other) const;
+  bool operator!=(const InputSettings& other) const;
+};
+
+/**
+ * @brief Util method to parse access mode from its name (as used in command-line)
+ * @param name Access mode name ("stream" or "mmap")
+ * @return Access mode, or nothing in case of unknown name
+ */
+std::optional<InputSettings::Access> to_access(const std::string& name);
+
+/**
+ * @brief Util method to parse equalizer implementation from its name (as used in command-line)
+ * @param name Equalizer name ("filter" or "native")
+ * @return Equalizer implementation, or nothing in case of unknown name
+ */
+std::optional<InputSettings::Equalizer> to_equalizer(const std::string& name);
+
+}  // namespace model
+#endif  // INCLUDE_MODEL_INPUT_SETTINGS_H_
@@ -0,0 +1,29 @@
+/**
+ * \file
+ * \brief  Base class for a block of audio samples
+ */
+
+#ifndef INCLUDE_MODEL_PCM_BLOCK_H_
+#define INCLUDE_MODEL_PCM_BLOCK_H_
+
+#include <chrono>
+
+#include "model/audio_format.h"
+
+namespace model {
+
+/**
+ * @brief Describe a block of interleaved audio samples sent for audio analysis. It does not own
+ * samples, so they are only valid while the notification carrying this block is running.
+ */
+struct PcmBlock {
+  using Clock = std::chrono::steady_clock;
+
+  const void* data = nullptr;   //!< Interleaved samples
+  AudioFormat format;           //!< Format used by samples
+  int frames = 0;               //!< Number of frames (each one with a sample per channel)
+  Clock::time_point timestamp;  //!< Moment when samples started to be heard
+};
+
+}  // namespace model
+#endif  // INCLUDE_MODEL_PCM_BLOCK_H_
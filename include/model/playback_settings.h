@@ -0,0 +1,69 @@
+/**
+ * \file
+ * \brief  Base class for playback settings
+ */
+
+#ifndef INCLUDE_MODEL_PLAYBACK_SETTINGS_H_
+#define INCLUDE_MODEL_PLAYBACK_SETTINGS_H_
+
+#include <cstdint>
+#include <optional>
+#include <ostream>
+#include <string>
+
+#include "model/audio_format.h"
+
+namespace model {
+
+/**
+ * @brief Settings for playback stream: device and latency profile are chosen by user, while the
+ * remaining values are negotiated with device when configuring the stream
+ */
+struct PlaybackSettings {
+  //! Trade-off between responsiveness (pause, seek, equalizer) and power consumption
+  enum class Latency {
+    Low = 4001,          //!< Short periods, so user actions are heard almost immediately
+    Balanced = 4002,     //!< Default value
+    PowerSaving = 4003,  //!< Large buffer, so CPU wakes up less often to refill it
+  };
+
+  std::string device = "default";       //!< Device name used to open playback stream
+  Latency latency = Latency::Balanced;  //!< Latency profile
+  bool mmap = false;                    //!< Write directly into device buffer (if supported)
+
+  AudioFormat format;        //!< Negotiated audio format
+  uint32_t period_size = 0;  //!< Negotiated period size (in frames)
+  uint32_t buffer_size = 0;  //!< Negotiated buffer size (in frames)
+
+  /**
+   * @brief Convert frames to milliseconds, using negotiated sample rate
+   * @param frames Number of frames
+   * @return Duration in milliseconds
+   */
+  double ToMilliseconds(uint32_t frames) const {
+    return format.sample_rate > 0 ? 1000.0 * frames / format.sample_rate : 0;
+  }
+
+  //! Overloaded operators
+  friend std::ostream& operator<<(std::ostream& out, const Latency& l);
+  friend std::ostream& operator<<(std::ostream& out, const PlaybackSettings& s);
+  bool operator==(const PlaybackSettings& other) const;
+  bool operator!=(const PlaybackSettings& other) const;
+};
+
+/**
+ * @brief Util method to parse latency profile from its name (as used in command-line)
+ * @param name Profile name ("low", "balanced" or "power-saving")
+ * @return Latency profile, or nothing in case of unknown name
+ */
+std::optional<PlaybackSettings::Latency> to_latency(const std::string& name);
+
+/**
+ * @brief Util method to pretty print negotiated values from PlaybackSettings structure
+ * @param arg PlaybackSettings struct
+ * @return std::string Formatted string with properties from PlaybackSettings
+ */
+std::string to_string(const PlaybackSettings& arg);
+
+}  // namespace model
+#endif  // INCLUDE_MODEL_PLAYBACK_SETTINGS_H_
@@ -37,8 +37,9 @@ struct Song {
   };
 
   struct CurrentInformation {
-    MediaState state;   //!< Current song state
-    uint32_t position;  //!< Current position (in seconds) of the audio
+    MediaState state;      //!< Current song state
+    uint32_t position;     //!< Current position (in seconds) of the audio
+    uint32_t position_ms;  //!< Current position (in milliseconds) of the audio, for accuracy
 
     //! Overloaded operators
     bool operator==(const CurrentInformation& other) const;
@@ -0,0 +1,179 @@
+/**
+ * \file
+ * \brief  Class for a compact table of file paths
+ */
+
+#ifndef INCLUDE_UTIL_PATH_TABLE_H_
+#define INCLUDE_UTIL_PATH_TABLE_H_
+
+#include <algorithm>
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace util {
+
+/**
+ * @brief Store a list of file paths packed into a single character buffer (an arena), instead of
+ * one heap allocation for each path. Each entry is a small fixed-size slot pointing into the arena,
+ * so sorting only moves slots around, and lists derived from it (like search results) can be kept
+ * as vectors of indexes instead of copying paths all over again.
+ *
+ * API resembles a std::vector of paths, so it can replace one with almost no changes.
+ */
+class PathTable {
+ public:
+  using Index = uint32_t;  //!< Index for an entry in table
+
+  /* ******************************************************************************************** */
+  //! Public API
+
+  /**
+   * @brief Reserve memory in advance, to avoid reallocations while filling table
+   * @param entries Number of entries
+   * @param bytes Total length from all paths together
+   */
+  void reserve(size_t entries, size_t bytes);
+
+  /**
+   * @brief Append entry from directory listing (type is taken from directory entry, which is
+   * usually cached while listing, so there is no need for an extra syscall)
+   * @param entry Directory entry
+   */
+  void emplace_back(const std::filesystem::directory_entry& entry);
+
+  /**
+   * @brief Append entry (checking on filesystem if it is a directory)
+   * @param path Path to file
+   */
+  void emplace_back(const std::filesystem::path& path);
+
+  /**
+   * @brief Append entry with known type
+   * @param path Path to file
+   * @param directory Entry is a directory
+   */
+  void emplace_back(std::string_view path, bool directory);
+
+  /**
+   * @brief Insert entry at the beginning of table
+   * @param path Path to file
+   * @param directory Entry is a directory
+   */
+  void emplace_front(std::string_view path, bool directory);
+
+  /**
+   * @brief Release memory reserved but not used (as arena grows geometrically, this may be up to
+   * half of it)
+   */
+  void shrink_to_fit();
+
+  /**
+   * @brief Remove all entries (memory is kept for reuse)
+   */
+  void clear();
+
+  /**
+   * @brief Get number of entries
+   * @return Number of entries
+   */
+  size_t size() const { return slots_.size(); }
+
+  /**
+   * @brief Check if table is empty
+   * @return true if there is no entry, otherwise false
+   */
+  bool empty() const { return slots_.empty(); }
+
+  /**
+   * @brief Create path for entry (throws std::out_of_range for an invalid index)
+   * @param index Entry index
+   * @return Path to file
+   */
+  std::filesystem::path at(size_t index) const;
+
+  /**
+   * @brief Get full path for entry, without any allocation
+   * @param index Entry index
+   * @return View to path in arena
+   */
+  std::string_view native(size_t index) const;
+
+  /**
+   * @brief Get filename for entry (last component from path), without any allocation
+   * @param index Entry index
+   * @return View to filename in arena
+   */
+  std::string_view filename(size_t index) const;
+
+  /**
+   * @brief Check if entry is a directory (as it was when entry was added)
+   * @param index Entry index
+   * @return true if it is a directory, otherwise false
+   */
+  bool is_directory(size_t index) const { return slots_.at(index).directory; }
+
+  /**
+   * @brief Sort entries by filename
+   * @param compare Compare two filenames, returning true if the first one goes before
+   */
+  template <typename Compare>
+  void sort(Compare compare) {
+    std::sort(slots_.begin(), slots_.end(), [&](const Slot& a, const Slot& b) {
+      return compare(GetFilename(a), GetFilename(b));
+    });
+  }
+
+  /**
+   * @brief Find entries whose filename contains text (case insensitive, only for ASCII letters)
+   * @param text Text to search
+   * @return Indexes for matching entries (all of them in case of empty text)
+   */
+  std::vector<Index> find(std::string_view text) const;
+
+  /* ******************************************************************************************** */
+  //! Internal declarations
+ private:
+  //! Entry pointing to path inside arena
+  struct Slot {
+    size_t offset;    //!< Offset for path in arena
+    uint32_t length;  //!< Path length
+    uint16_t name;    //!< Offset for filename inside path
+    bool directory;   //!< Entry is a directory
+  };
+
+  /**
+   * @brief Convert ASCII letter to lowercase (cheaper than std::tolower, which depends on locale)
+   * @param c Character
+   * @return Lowercase character
+   */
+  static char ToLower(char c) { return c >= 'A' && c <= 'Z' ? static_cast<char>(c + 32) : c; }
+
+  /**
+   * @brief Copy path to the end of arena and create a slot for it
+   * @param path Path to file
+   * @param directory Entry is a directory
+   * @return Slot for path
+   */
+  Slot Append(std::string_view path, bool directory);
+
+  /**
+   * @brief Get filename from slot
+   * @param slot Entry slot
+   * @return View to filename in arena
+   */
+  std::string_view GetFilename(const Slot& slot) const {
+    return std::string_view{arena_}.substr(slot.offset + slot.name, slot.length - slot.name);
+  }
+
+  /* ******************************************************************************************** */
+  //! Variables
+
+  std::string arena_;        //!< All paths, one right after the other
+  std::vector<Slot> slots_;  //!< Entries (in order)
+};
+
+}  // namespace util
+#endif  // INCLUDE_UTIL_PATH_TABLE_H_
@@ -6,6 +6,7 @@
 #ifndef INCLUDE_VIEW_BASE_CUSTOM_EVENT_H_
 #define INCLUDE_VIEW_BASE_CUSTOM_EVENT_H_
 
+#include <chrono>
 #include <filesystem>
 #include <variant>
 #include <vector>
@@ -13,6 +14,7 @@
 #include "model/audio_filter.h"
 #include "model/bar_animation.h"
 #include "model/block_identifier.h"
+#include "model/playback_settings.h"
 #include "model/song.h"
 #include "model/volume.h"
 
@@ -38,6 +40,7 @@ struct CustomEvent {
     UpdateSongInfo = 50002,
     UpdateSongState = 50003,
     DrawAudioSpectrum = 50004,
+    UpdatePlaybackSettings = 50005,
     // Events from interface to audio thread
     NotifyFileSelection = 60000,
     PauseOrResumeSong = 60001,
@@ -48,6 +51,9 @@ struct CustomEvent {
     SeekForwardPosition = 60006,
     SeekBackwardPosition = 60007,
     ApplyAudioFilters = 60008,
+    SeekToPosition = 60009,
+    WarmUpFiles = 60010,
+    SetNextSong = 60011,
     // Events from interface to interface
     Refresh = 70000,
     ChangeBarAnimation = 70001,
@@ -75,6 +81,7 @@ struct CustomEvent {
   static CustomEvent UpdateSongInfo(const model::Song& info);
   static CustomEvent UpdateSongState(const model::Song::CurrentInformation& new_state);
   static CustomEvent DrawAudioSpectrum(const std::vector<double>& data);
+  static CustomEvent UpdatePlaybackSettings(const model::PlaybackSettings& settings);
 
   //! Possible events (from interface to audio thread)
   static CustomEvent NotifyFileSelection(const std::filesystem::path file_path);
@@ -85,7 +92,10 @@ struct CustomEvent {
   static CustomEvent ResizeAnalysis(int bars);
   static CustomEvent SeekForwardPosition(int offset);
   static CustomEvent SeekBackwardPosition(int offset);
+  static CustomEvent SeekToPosition(std::chrono::milliseconds position);
   static CustomEvent ApplyAudioFilters(const std::vector<model::AudioFilter> filters);
+  static CustomEvent WarmUpFiles(const std::vector<std::filesystem::path>& files);
+  static CustomEvent SetNextSong(const std::filesystem::path& file_path);
 
   //! Possible events (from interface to interface)
   static CustomEvent Refresh();
@@ -103,7 +113,8 @@ struct CustomEvent {
   using Content =
       std::variant<std::monostate, model::Song, model::Volume, model::Song::CurrentInformation,
                    std::filesystem::path, std::vector<double>, int, std::vector<model::AudioFilter>,
-                   model::BarAnimation, model::BlockIdentifier>;
+                   model::BarAnimation, model::BlockIdentifier, model::PlaybackSettings,
+                   std::chrono::milliseconds, std::vector<std::filesystem::path>>;
 
   //! Getter for event identifier
   Identifier GetId() const { return id; }
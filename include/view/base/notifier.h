@@ -7,6 +7,9 @@
 #define INCLUDE_VIEW_BASE_NOTIFIER_H_
 
 #include "model/application_error.h"
+#include "model/audio_format.h"
+#include "model/pcm_block.h"
+#include "model/playback_settings.h"
 #include "model/song.h"
 
 namespace interface {
@@ -49,10 +52,21 @@ class Notifier {
 
   /**
    * @brief Send raw audio samples to UI
-   * @param buffer Audio samples
-   * @param buff_size Sample count
+   * @param block Audio samples (only valid during this call)
    */
-  virtual void SendAudioRaw(uint8_t* buffer, int buffer_size) = 0;
+  virtual void SendAudioRaw(const model::PcmBlock& block) = 0;
+
+  /**
+   * @brief Notify audio format used by audio samples sent to UI
+   * @param format Audio format negotiated between decoder and playback
+   */
+  virtual void NotifyAudioFormat(const model::AudioFormat& format) = 0;
+
+  /**
+   * @brief Notify UI with settings negotiated with playback device (e.g. latency)
+   * @param settings Playback settings
+   */
+  virtual void NotifyPlaybackSettings(const model::PlaybackSettings& settings) = 0;
 
   /**
    * @brief Notify UI with error code from some background operation
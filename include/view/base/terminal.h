@@ -18,6 +18,7 @@
 #include "view/base/block.h"
 #include "view/base/custom_event.h"
 #include "view/base/event_dispatcher.h"
+#include "view/block/list_directory.h"
 #include "view/element/error_dialog.h"
 #include "view/element/help.h"
 
@@ -45,9 +46,10 @@ class Terminal : public EventDispatcher, public ftxui::ComponentBase {
  public:
   /**
    * @brief Factory method: Create, initialize internal components and return Terminal object
+   * @param lookup Find song information for files listed (optional)
    * @return std::shared_ptr<Terminal> Terminal instance
    */
-  static std::shared_ptr<Terminal> Create();
+  static std::shared_ptr<Terminal> Create(SongLookup lookup = nullptr);
 
   /**
    * @brief Destroy the Terminal object
@@ -65,8 +67,9 @@ class Terminal : public EventDispatcher, public ftxui::ComponentBase {
  private:
   /**
    * @brief Initialize internal components for Terminal object
+   * @param lookup Find song information for files listed
    */
-  void Init();
+  void Init(SongLookup lookup);
 
   /**
    * @brief Force application to exit
@@ -11,6 +11,7 @@
 
 #include "ftxui/component/captured_mouse.hpp"  // for ftxui
 #include "ftxui/dom/elements.hpp"              // for Element
+#include "model/playback_settings.h"           // for PlaybackSettings
 #include "model/song.h"                        // for Song
 #include "view/base/block.h"                   // for Block, BlockEvent (ptr...
 
@@ -56,7 +57,8 @@ class FileInfo : public Block {
 
   /* ******************************************************************************************* */
  private:
-  model::Song audio_info_;  //!< Audio information from current song
+  model::Song audio_info_;                     //!< Audio information from current song
+  model::PlaybackSettings playback_settings_;  //!< Values negotiated with playback device
 };
 
 }  // namespace interface
@@ -11,6 +11,7 @@
 #include <atomic>
 #include <condition_variable>
 #include <filesystem>  // for path
+#include <functional>  // for function
 #include <memory>      // for shared_ptr
 #include <mutex>
 #include <optional>  // for optional
@@ -22,6 +23,8 @@
 #include "ftxui/component/component_options.hpp"  // for MenuEntryOption
 #include "ftxui/dom/elements.hpp"                 // for Element
 #include "ftxui/screen/box.hpp"                   // for Box
+#include "model/song.h"                           // for Song
+#include "util/path_table.h"                      // for PathTable
 #include "view/base/block.h"                      // for Block, BlockEvent...
 
 //! Forward declaration
@@ -36,7 +39,10 @@ namespace interface {
 
 //! For better readability
 using File = std::filesystem::path;  //!< Single file path
-using Files = std::vector<File>;     //!< List of file paths
+using Files = util::PathTable;       //!< List of file paths
+
+//! Find song information for file without opening it (e.g. from media library index)
+using SongLookup = std::function<std::optional<model::Song>(const File&)>;
 
 //! Custom style for menu entry
 struct MenuEntryOption {
@@ -50,17 +56,19 @@ struct MenuEntryOption {
  * @brief Component to list files from given directory
  */
 class ListDirectory : public Block {
-  static constexpr int kMaxColumns = 30;     //!< Maximum columns for Component
-  static constexpr int kMaxIconColumns = 2;  //!< Maximum columns for Icon
+  static constexpr int kMaxColumns = 30;       //!< Maximum columns for Component
+  static constexpr int kMaxIconColumns = 2;    //!< Maximum columns for Icon
+  static constexpr int kWarmUpNeighbours = 1;  //!< Entries on each side of selected to warm up
 
  public:
   /**
    * @brief Construct a new List Directory object
    * @param dispatcher Block event dispatcher
    * @param optional_path List files from custom path instead of the current one
+   * @param lookup Find song information to show instead of filename (optional)
    */
   explicit ListDirectory(const std::shared_ptr<EventDispatcher>& dispatcher,
-                         const std::string& optional_path = "");
+                         const std::string& optional_path = "", SongLookup lookup = nullptr);
 
   /**
    * @brief Destroy the List Directory object
@@ -110,19 +118,24 @@ class ListDirectory : public Block {
   int* GetSelected() { return mode_search_ ? &mode_search_->selected : &selected_; }
   //! Getter for focused index
   int* GetFocused() { return mode_search_ ? &mode_search_->focused : &focused_; }
+  //! Getter for index in files list from entry at informed index
+  int GetIndex(int i) const { return mode_search_ ? mode_search_->entries.at(i) : i; }
   //! Getter for entry at informed index
-  File& GetEntry(int i) { return mode_search_ ? mode_search_->entries.at(i) : entries_.at(i); }
+  File GetEntry(int i) const { return entries_.at(GetIndex(i)); }
   //! Getter for active entry (focused/selected)
-  File* GetActiveEntry() {
-    if (!Size()) return nullptr;
+  std::optional<File> GetActiveEntry() {
+    if (!Size()) return std::nullopt;
 
-    return mode_search_ ? &mode_search_->entries.at(mode_search_->selected)
-                        : &entries_.at(selected_);
+    return GetEntry(*GetSelected());
   }
 
   //! Clamp both selected and focused indexes
   void Clamp();
 
+  //! Getter for text to show for entry at informed index in files list (artist and title for
+  //! songs found by lookup, otherwise filename)
+  std::string GetText(Files::Index index) const;
+
   //! Getter for Title (for testing purposes, may be overridden)
   virtual std::string GetTitle();
 
@@ -145,6 +158,19 @@ class ListDirectory : public Block {
    */
   void UpdateActiveEntry();
 
+  /**
+   * @brief Notify player about selected entry and its neighbours, so it can open them in
+   * background before user actually plays one of them (directories are skipped)
+   * @param index Index of selected entry
+   */
+  void WarmUpEntries(int index);
+
+  /**
+   * @brief Notify player about the file right after the one playing (directories are skipped), so
+   * it is played next without any gap between them
+   */
+  void QueueNextSong();
+
   /* ******************************************************************************************** */
  protected:
   std::filesystem::path curr_dir_;                     //!< Current directory
@@ -152,10 +178,10 @@ class ListDirectory : public Block {
 
   //! Parameters for when search mode is enabled
   struct Search {
-    std::string text_to_search;  //!< Text to search in file entries
-    Files entries;          //!< List containing only files from current directory matching the text
-    int selected, focused;  //!< Entry indexes in files list
-    int position;           //!< Cursor position for text to search
+    std::string text_to_search;         //!< Text to search in file entries
+    std::vector<Files::Index> entries;  //!< Indexes in files list for entries matching the text
+    int selected, focused;              //!< Entry indexes in search list
+    int position;                       //!< Cursor position for text to search
   };
 
   //! Put together all possible styles for an entry in this component
@@ -233,6 +259,8 @@ class ListDirectory : public Block {
 
   TextAnimation animation_;  //!< Text animation for selected entry
 
+  SongLookup lookup_;  //!< Find song information for file entries
+
   /* ******************************************************************************************** */
   //! Friend test
   FRIEND_TEST(::ListDirectoryTest, RunTextAnimation);
@@ -29,9 +29,15 @@ std::ostream& operator<<(std::ostream& out, const Command::Identifier& i) {
     case Command::Identifier::UpdateAudioFilters:
       out << " UpdateAudioFilter ";
       break;
+    case Command::Identifier::SetNextSong:
+      out << " SetNextSong ";
+      break;
     case Command::Identifier::Exit:
       out << " Exit ";
       break;
+    case Command::Identifier::SeekTo:
+      out << " SeekTo ";
+      break;
   }
 
   return out;
@@ -102,6 +108,16 @@ Command Command::SeekBackward(int offset) {
 
 /* ********************************************************************************************** */
 
+// Static
+Command Command::SeekTo(std::chrono::milliseconds position) {
+  return Command{
+      .id = Identifier::SeekTo,
+      .content = position,
+  };
+}
+
+/* ********************************************************************************************** */
+
 // Static
 Command Command::SetVolume(const model::Volume& value) {
   return Command{
@@ -122,6 +138,16 @@ Command Command::UpdateAudioFilters(const std::vector<model::AudioFilter>& filte
 
 /* ********************************************************************************************** */
 
+// Static
+Command Command::SetNextSong(const std::string& filepath) {
+  return Command{
+      .id = Identifier::SetNextSong,
+      .content = filepath,
+  };
+}
+
+/* ********************************************************************************************** */
+
 // Static
 Command Command::Exit() {
   return Command{
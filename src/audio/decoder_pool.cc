@@ -0,0 +1,355 @@
+#include "audio/decoder_pool.h"
+
+#include <algorithm>
+#include <iomanip>
+
+#include "util/logger.h"
+
+namespace audio {
+
+DecoderPool::DecoderPool(Factory factory, size_t budget, size_t overhead)
+    : factory_{std::move(factory)}, negotiator_{}, budget_{budget}, overhead_{overhead} {}
+
+/* ********************************************************************************************** */
+
+DecoderPool::~DecoderPool() {
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    exit_ = true;
+  }
+  notifier_.notify_one();
+
+  if (worker_.joinable()) {
+    worker_.join();
+  }
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::Start(Negotiator negotiator) {
+  LOG("Start decoder warm-up thread with budget=", budget_, " bytes");
+  negotiator_ = std::move(negotiator);
+  worker_ = std::thread(&DecoderPool::Worker, this);
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::WarmUp(const std::vector<std::string>& filepaths) {
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    requested_ = filepaths;
+    pending_.clear();
+
+    // Iterate in reverse, so the first file ends up as the most recently used one
+    for (auto it = filepaths.rbegin(); it != filepaths.rend(); ++it) {
+      auto entry = std::find_if(entries_.begin(), entries_.end(),
+                                [&](const Entry& e) { return e.filepath == *it; });
+
+      if (entry != entries_.end()) {
+        entries_.splice(entries_.begin(), entries_, entry);
+      } else if (*it != in_flight_) {
+        pending_.push_front(*it);
+      }
+    }
+
+    // Next file is still the most important one
+    PrioritizeNext();
+  }
+
+  notifier_.notify_one();
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::WarmUpNext(const std::string& filepath) {
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    next_ = filepath;
+    PrioritizeNext();
+  }
+
+  notifier_.notify_one();
+}
+
+/* ********************************************************************************************** */
+
+std::optional<DecoderPool::Entry> DecoderPool::Take(const std::string& filepath, bool wait) {
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  if (wait) {
+    pending_.erase(std::remove(pending_.begin(), pending_.end(), filepath), pending_.end());
+
+    // Worker is already opening it, and it will certainly be done before opening it all over again
+    idle_.wait(lock, [&] { return in_flight_ != filepath; });
+  }
+
+  auto entry = std::find_if(entries_.begin(), entries_.end(),
+                            [&](const Entry& e) { return e.filepath == filepath; });
+
+  if (entry == entries_.end()) {
+    // Caller is going to open it by itself, so it is not reserved anymore
+    if (wait && filepath == next_) next_.clear();
+    return std::nullopt;
+  }
+
+  if (filepath == next_) next_.clear();
+
+  LOG("Take decoder warmed up for filepath=", std::quoted(filepath));
+  std::optional<Entry> result{std::move(*entry)};
+  usage_ -= result->cost;
+  entries_.erase(entry);
+
+  if (result->generation == generation_) return result;
+
+  // Worker did not refresh it yet, so apply latest settings right now (only to this entry)
+  auto volume = volume_;
+  auto filters = filters_;
+  lock.unlock();
+
+  Apply(*result, volume, filters);
+  if (!result->decoder) return std::nullopt;
+
+  return result;
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::SetVolume(model::Volume value) {
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    volume_ = value;
+    generation_++;
+  }
+
+  // Decoders are only touched by worker thread, so caller never waits for file I/O
+  notifier_.notify_one();
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::UpdateFilters(const std::vector<model::AudioFilter>& filters) {
+  {
+    std::scoped_lock<std::mutex> lock(mutex_);
+    filters_ = filters;
+    generation_++;
+  }
+
+  notifier_.notify_one();
+}
+
+/* ********************************************************************************************** */
+
+size_t DecoderPool::Size() const {
+  std::scoped_lock<std::mutex> lock(mutex_);
+  return entries_.size();
+}
+
+/* ********************************************************************************************** */
+
+size_t DecoderPool::GetUsage() const {
+  std::scoped_lock<std::mutex> lock(mutex_);
+  return usage_;
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::Worker() {
+  LOG("Start decoder warm-up thread");
+  std::unique_lock<std::mutex> lock(mutex_);
+
+  while (true) {
+    notifier_.wait(
+        lock, [&] { return exit_ || !pending_.empty() || FindStale() != entries_.end(); });
+    if (exit_) break;
+
+    uint64_t generation = generation_;
+    auto volume = volume_;
+    auto filters = filters_;
+    std::optional<Entry> entry;
+
+    if (!pending_.empty()) {
+      in_flight_ = std::move(pending_.front());
+      pending_.pop_front();
+
+      // Opening file may take a while, so do not block anyone meanwhile
+      lock.unlock();
+      entry = Open(in_flight_, volume, filters);
+      lock.lock();
+    } else {
+      // Volume or filters changed after entry was decoded, so decode its preroll again
+      auto stale = FindStale();
+      in_flight_ = stale->filepath;
+      entry = std::move(*stale);
+      usage_ -= entry->cost;
+      entries_.erase(stale);
+
+      lock.unlock();
+      Apply(*entry, volume, filters);
+      if (entry->decoder) Preroll(*entry);
+      lock.lock();
+    }
+
+    // In case that volume or filters changed meanwhile, it will be refreshed on a next iteration
+    if (entry && entry->decoder) {
+      entry->generation = generation;
+      Insert(std::move(*entry));
+    }
+
+    in_flight_.clear();
+    idle_.notify_all();
+  }
+
+  LOG("Finish decoder warm-up thread");
+}
+
+/* ********************************************************************************************** */
+
+std::optional<DecoderPool::Entry> DecoderPool::Open(
+    const std::string& filepath, const std::optional<model::Volume>& volume,
+    const std::optional<std::vector<model::AudioFilter>>& filters) const {
+  LOG("Warm up decoder for filepath=", std::quoted(filepath));
+
+  Entry entry{
+      .filepath = filepath,
+      .decoder = factory_(),
+      .song = model::Song{.filepath = filepath},
+  };
+
+  if (volume) entry.decoder->SetVolume(*volume);
+  if (filters) entry.decoder->UpdateFilters(*filters);
+
+  // Probe file and configure decoder, which is the slowest part before playing a song
+  if (entry.decoder->OpenFile(entry.song) != error::kSuccess) {
+    LOG("Cannot warm up decoder, file is not supported");
+    return std::nullopt;
+  }
+
+  entry.format = negotiator_(entry.song);
+
+  if (entry.decoder->SetOutputFormat(entry.format) != error::kSuccess) {
+    ERROR("Cannot set output format for decoder warmed up");
+    return std::nullopt;
+  }
+
+  Preroll(entry);
+  return entry;
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::Preroll(Entry& entry) const {
+  const int frame_size = entry.format.GetFrameSize();
+  int remaining = static_cast<int>(kPreroll.count() * entry.format.sample_rate / 1000);
+
+  entry.cost = overhead_;
+
+  while (remaining > 0) {
+    Chunk chunk;
+    chunk.frames = std::min(remaining, kChunkFrames);
+    chunk.samples.resize(static_cast<size_t>(chunk.frames) * frame_size);
+
+    error::Code result = entry.decoder->Read(chunk.samples.data(), chunk.frames, chunk.position);
+    if (result != error::kSuccess || chunk.frames == 0) break;
+
+    chunk.samples.resize(static_cast<size_t>(chunk.frames) * frame_size);
+    remaining -= chunk.frames;
+
+    entry.cost += chunk.samples.size();
+    entry.preroll.push_back(std::move(chunk));
+  }
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::Rewind(Entry& entry) const {
+  if (entry.preroll.empty()) return;
+
+  entry.preroll.clear();
+  entry.cost = overhead_;
+
+  // In case that it cannot go back to the start of song, it is better to open it all over again
+  if (entry.decoder->Seek(0) != error::kSuccess) {
+    ERROR("Cannot rewind decoder warmed up for filepath=", std::quoted(entry.filepath));
+    entry.decoder.reset();
+  }
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::Apply(Entry& entry, const std::optional<model::Volume>& volume,
+                        const std::optional<std::vector<model::AudioFilter>>& filters) const {
+  LOG("Apply latest settings to decoder warmed up for filepath=", std::quoted(entry.filepath));
+
+  if (volume) entry.decoder->SetVolume(*volume);
+  if (filters) entry.decoder->UpdateFilters(*filters);
+  Rewind(entry);
+}
+
+/* ********************************************************************************************** */
+
+std::list<DecoderPool::Entry>::iterator DecoderPool::FindStale() {
+  return std::find_if(entries_.begin(), entries_.end(),
+                      [&](const Entry& e) { return e.generation != generation_; });
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::Insert(Entry&& entry) {
+  // Files from the last request are kept in order of priority, ahead of older ones
+  size_t rank = GetRank(entry.filepath);
+  auto position = std::find_if(entries_.begin(), entries_.end(),
+                               [&](const Entry& e) { return GetRank(e.filepath) > rank; });
+
+  usage_ += entry.cost;
+  entries_.insert(position, std::move(entry));
+  Evict();
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::PrioritizeNext() {
+  if (next_.empty()) return;
+
+  auto entry = std::find_if(entries_.begin(), entries_.end(),
+                            [&](const Entry& e) { return e.filepath == next_; });
+
+  if (entry != entries_.end()) {
+    entries_.splice(entries_.begin(), entries_, entry);
+    return;
+  }
+
+  if (next_ == in_flight_) return;
+
+  pending_.erase(std::remove(pending_.begin(), pending_.end(), next_), pending_.end());
+  pending_.push_front(next_);
+}
+
+/* ********************************************************************************************** */
+
+size_t DecoderPool::GetRank(const std::string& filepath) const {
+  if (!next_.empty() && filepath == next_) return 0;
+
+  auto it = std::find(requested_.begin(), requested_.end(), filepath);
+  return static_cast<size_t>(std::distance(requested_.begin(), it)) + 1;
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::Evict() {
+  while (usage_ > budget_ && !entries_.empty()) {
+    LOG("Evict decoder warmed up for filepath=", std::quoted(entries_.back().filepath));
+    usage_ -= entries_.back().cost;
+    entries_.pop_back();
+  }
+}
+
+/* ********************************************************************************************** */
+
+void DecoderPool::WaitUntilIdle() {
+  std::unique_lock<std::mutex> lock(mutex_);
+  idle_.wait(lock, [&] {
+    return pending_.empty() && in_flight_.empty() && FindStale() == entries_.end();
+  });
+}
+
+}  // namespace audio
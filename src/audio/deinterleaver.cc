@@ -0,0 +1,141 @@
+#include "audio/deinterleaver.h"
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "util/logger.h"
+
+namespace audio {
+
+Deinterleaver::Deinterleaver() : kernel_{SelectKernel()} {}
+
+/* ********************************************************************************************** */
+
+Deinterleaver::Kernel Deinterleaver::SelectKernel() {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("avx2")) {
+    LOG("Deinterleaver using AVX2 implementation");
+    return &Deinterleaver::ConvertAvx2;
+  }
+#elif defined(__aarch64__)
+  LOG("Deinterleaver using NEON implementation");
+  return &Deinterleaver::ConvertNeon;
+#endif
+
+  LOG("Deinterleaver using scalar implementation");
+  return &Deinterleaver::ConvertScalar;
+}
+
+/* ********************************************************************************************** */
+
+void Deinterleaver::Process(const model::PcmBlock& block, float* left, float* right) const {
+  if (block.data == nullptr || block.frames <= 0) return;
+
+  if (block.format.sample_format == model::AudioFormat::SampleFormat::S16 &&
+      block.format.channels == 2) {
+    kernel_(static_cast<const int16_t*>(block.data), block.frames, left, right);
+    return;
+  }
+
+  ConvertGeneric(block, left, right);
+}
+
+/* ********************************************************************************************** */
+
+void Deinterleaver::ConvertGeneric(const model::PcmBlock& block, float* left, float* right) {
+  using SampleFormat = model::AudioFormat::SampleFormat;
+
+  int channels = block.format.channels;
+  if (channels <= 0) return;
+
+  // Mono is copied to both channels
+  int other = channels > 1 ? 1 : 0;
+
+  switch (block.format.sample_format) {
+    case SampleFormat::S16: {
+      auto data = static_cast<const int16_t*>(block.data);
+      for (int i = 0; i < block.frames; i++, data += channels) {
+        left[i] = data[0];
+        right[i] = data[other];
+      }
+    } break;
+
+    case SampleFormat::S32: {
+      // Keep only the 16 most significant bits
+      constexpr float kScale = 1.0f / 65536.0f;
+      auto data = static_cast<const int32_t*>(block.data);
+      for (int i = 0; i < block.frames; i++, data += channels) {
+        left[i] = static_cast<float>(data[0]) * kScale;
+        right[i] = static_cast<float>(data[other]) * kScale;
+      }
+    } break;
+
+    case SampleFormat::Float: {
+      constexpr float kScale = 32768.0f;
+      auto data = static_cast<const float*>(block.data);
+      for (int i = 0; i < block.frames; i++, data += channels) {
+        left[i] = data[0] * kScale;
+        right[i] = data[other] * kScale;
+      }
+    } break;
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Deinterleaver::ConvertScalar(const int16_t* data, int frames, float* left, float* right) {
+  for (int i = 0; i < frames; i++) {
+    left[i] = data[2 * i];
+    right[i] = data[2 * i + 1];
+  }
+}
+
+/* ********************************************************************************************** */
+
+#if defined(__x86_64__)
+__attribute__((target("avx2"))) void Deinterleaver::ConvertAvx2(const int16_t* data, int frames,
+                                                                float* left, float* right) {
+  int i = 0;
+
+  // Each 32-bit lane holds a whole frame: left sample in its lower half and right in the upper
+  // one, so both channels are extracted (and sign-extended) using only arithmetic shifts
+  for (; i + 8 <= frames; i += 8) {
+    __m256i in = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(data + 2 * i));
+
+    __m256i l = _mm256_srai_epi32(_mm256_slli_epi32(in, 16), 16);
+    __m256i r = _mm256_srai_epi32(in, 16);
+
+    _mm256_storeu_ps(left + i, _mm256_cvtepi32_ps(l));
+    _mm256_storeu_ps(right + i, _mm256_cvtepi32_ps(r));
+  }
+
+  // Remaining frames
+  ConvertScalar(data + 2 * i, frames - i, left + i, right + i);
+}
+#endif
+
+/* ********************************************************************************************** */
+
+#if defined(__aarch64__)
+void Deinterleaver::ConvertNeon(const int16_t* data, int frames, float* left, float* right) {
+  int i = 0;
+
+  // Structured load already splits channels into separate vectors
+  for (; i + 8 <= frames; i += 8) {
+    int16x8x2_t in = vld2q_s16(data + 2 * i);
+
+    vst1q_f32(left + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(in.val[0]))));
+    vst1q_f32(left + i + 4, vcvtq_f32_s32(vmovl_high_s16(in.val[0])));
+    vst1q_f32(right + i, vcvtq_f32_s32(vmovl_s16(vget_low_s16(in.val[1]))));
+    vst1q_f32(right + i + 4, vcvtq_f32_s32(vmovl_high_s16(in.val[1])));
+  }
+
+  // Remaining frames
+  ConvertScalar(data + 2 * i, frames - i, left + i, right + i);
+}
+#endif
+
+}  // namespace audio
@@ -3,22 +3,38 @@
 #include <alsa/mixer.h>
 #include <math.h>
 
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+
 #include "model/application_error.h"
 #include "util/logger.h"
 
 namespace driver {
 
-Alsa::Alsa() : playback_handle_{}, mixer_{}, period_size_{} {}
+Alsa::Alsa(const model::PlaybackSettings &settings)
+    : playback_handle_{},
+      mixer_{},
+      settings_{settings},
+      mmap_requested_{settings.mmap},
+      mmap_area_{},
+      mmap_offset_{},
+      start_threshold_{},
+      can_pause_{},
+      history_{},
+      history_end_{},
+      history_size_{},
+      held_{} {}
 
 /* ********************************************************************************************** */
 
 error::Code Alsa::CreatePlaybackStream() {
-  LOG("Create new playback stream");
+  LOG("Create new playback stream on device=", settings_.device);
 
   // Create playback stream on ALSA
   snd_pcm_t *pcm_handle = nullptr;
-  if (snd_pcm_open(&pcm_handle, kDevice, SND_PCM_STREAM_PLAYBACK, 0) < 0) {
-    ERROR("Cannot open playback stream");
+  if (snd_pcm_open(&pcm_handle, settings_.device.c_str(), SND_PCM_STREAM_PLAYBACK, 0) < 0) {
+    ERROR("Cannot open playback stream on device=", settings_.device);
     return error::kUnknownError;
   }
 
@@ -28,7 +44,7 @@ error::Code Alsa::CreatePlaybackStream() {
   snd_mixer_t *mixer_handle = nullptr;
 
   snd_mixer_open(&mixer_handle, 0);
-  snd_mixer_attach(mixer_handle, kDevice);
+  snd_mixer_attach(mixer_handle, GetMixerDevice(settings_.device).c_str());
   snd_mixer_selem_register(mixer_handle, nullptr, nullptr);
 
   if (snd_mixer_load(mixer_handle) < 0) {
@@ -43,22 +59,134 @@ error::Code Alsa::CreatePlaybackStream() {
 
 /* ********************************************************************************************** */
 
-error::Code Alsa::ConfigureParameters() {
-  LOG("Configure parameters on playback stream");
+Playback::Capabilities Alsa::GetCapabilities() {
+  LOG("Query capabilities from playback stream");
+  Capabilities capabilities;
+
+  snd_pcm_t *pcm = playback_handle_.get();
+
+  snd_pcm_hw_params_t *params = nullptr;
+  snd_pcm_hw_params_alloca(&params);
+
+  // Fill configuration space with all possible values for this device
+  if (snd_pcm_hw_params_any(pcm, params) < 0) {
+    ERROR("Cannot get configuration space from playback stream");
+    return capabilities;
+  }
+
+  // Restrict configuration space the same way as ConfigureParameters does, otherwise a plugin
+  // device would report every rate as supported, as it is still allowed to resample them
+  bool mmap = mmap_requested_ &&
+              snd_pcm_hw_params_set_access(pcm, params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+
+  if ((!mmap && snd_pcm_hw_params_set_access(pcm, params, SND_PCM_ACCESS_RW_INTERLEAVED) < 0) ||
+      snd_pcm_hw_params_set_rate_resample(pcm, params, 0) < 0 ||
+      snd_pcm_hw_params_set_channels(pcm, params, model::AudioFormat{}.channels) < 0) {
+    ERROR("Cannot restrict configuration space from playback stream");
+    return capabilities;
+  }
+
+  for (const auto &format : kSampleFormats) {
+    if (snd_pcm_hw_params_test_format(pcm, params, ToAlsaFormat(format)) == 0) {
+      LOG("Playback stream supports sample format=", format);
+      capabilities.sample_formats.push_back(format);
+    }
+  }
+
+  for (const auto &rate : kSampleRates) {
+    if (snd_pcm_hw_params_test_rate(pcm, params, rate, 0) == 0) {
+      LOG("Playback stream supports sample rate=", rate);
+      capabilities.sample_rates.push_back(rate);
+    }
+  }
+
+  return capabilities;
+}
+
+/* ********************************************************************************************** */
+
+error::Code Alsa::ConfigureParameters(const model::AudioFormat &format) {
+  LOG("Configure parameters on playback stream with format=", format,
+      " and latency=", settings_.latency);
 
-  // with latency as 92900us, we get a period size equal to 1024
-  if (snd_pcm_set_params(playback_handle_.get(), kSampleFormat, SND_PCM_ACCESS_RW_INTERLEAVED,
-                         kChannels, kSampleRate, 0, 92900) < 0) {
-    ERROR("Cannot set parameters on playback stream");
+  snd_pcm_t *pcm = playback_handle_.get();
+
+  snd_pcm_hw_params_t *hw_params = nullptr;
+  snd_pcm_hw_params_alloca(&hw_params);
+
+  if (snd_pcm_hw_params_any(pcm, hw_params) < 0) {
+    ERROR("Cannot get configuration space from playback stream");
+    return error::kUnknownError;
+  }
+
+  // Prefer writing directly into device buffer, but not every device (or plugin) supports it
+  bool mmap = mmap_requested_ &&
+              snd_pcm_hw_params_set_access(pcm, hw_params, SND_PCM_ACCESS_MMAP_INTERLEAVED) == 0;
+
+  if (mmap_requested_ && !mmap) {
+    LOG("Playback stream does not support mmap access, fall back to regular writes");
+  }
+
+  // Restrict configuration space to the desired audio format (without resampling it)
+  if ((!mmap &&
+       snd_pcm_hw_params_set_access(pcm, hw_params, SND_PCM_ACCESS_RW_INTERLEAVED) < 0) ||
+      snd_pcm_hw_params_set_rate_resample(pcm, hw_params, 0) < 0 ||
+      snd_pcm_hw_params_set_format(pcm, hw_params, ToAlsaFormat(format.sample_format)) < 0 ||
+      snd_pcm_hw_params_set_channels(pcm, hw_params, format.channels) < 0 ||
+      snd_pcm_hw_params_set_rate(pcm, hw_params, format.sample_rate, 0) < 0) {
+    ERROR("Cannot set audio format on playback stream");
+    return error::kUnknownError;
+  }
+
+  // Set buffer time before period time, so device won't limit buffer to only a couple of periods
+  LatencyTarget target = GetLatencyTarget(settings_.latency);
+
+  if (snd_pcm_hw_params_set_buffer_time_near(pcm, hw_params, &target.buffer_time, nullptr) < 0 ||
+      snd_pcm_hw_params_set_period_time_near(pcm, hw_params, &target.period_time, nullptr) < 0 ||
+      snd_pcm_hw_params(pcm, hw_params) < 0) {
+    ERROR("Cannot set period and buffer size on playback stream");
     return error::kUnknownError;
   }
 
-  snd_pcm_uframes_t buffer_size = 0;
-  if (snd_pcm_get_params(playback_handle_.get(), &buffer_size, &period_size_) < 0) {
-    ERROR("Cannot get parameters from playback stream");
+  snd_pcm_uframes_t period_size = 0, buffer_size = 0;
+  if (snd_pcm_hw_params_get_period_size(hw_params, &period_size, nullptr) < 0 ||
+      snd_pcm_hw_params_get_buffer_size(hw_params, &buffer_size) < 0) {
+    ERROR("Cannot get period and buffer size from playback stream");
     return error::kUnknownError;
   }
 
+  snd_pcm_sw_params_t *sw_params = nullptr;
+  snd_pcm_sw_params_alloca(&sw_params);
+
+  // Start playing only when buffer is filled, and wake up writer as soon as a period is available
+  start_threshold_ = (buffer_size / period_size) * period_size;
+
+  if (snd_pcm_sw_params_current(pcm, sw_params) < 0 ||
+      snd_pcm_sw_params_set_start_threshold(pcm, sw_params, start_threshold_) < 0 ||
+      snd_pcm_sw_params_set_avail_min(pcm, sw_params, period_size) < 0 ||
+      snd_pcm_sw_params(pcm, sw_params) < 0) {
+    ERROR("Cannot set software parameters on playback stream");
+    return error::kUnknownError;
+  }
+
+  settings_.mmap = mmap;
+  settings_.format = format;
+  settings_.period_size = static_cast<uint32_t>(period_size);
+  settings_.buffer_size = static_cast<uint32_t>(buffer_size);
+
+  // Without hardware pause, keep history from frames written to hold them while paused
+  can_pause_ = snd_pcm_hw_params_can_pause(hw_params) == 1;
+  LOG("Playback stream ", can_pause_ ? "supports" : "does not support", " hardware pause");
+
+  history_.assign(can_pause_ ? 0 : buffer_size * format.GetFrameSize(), 0);
+  history_end_ = 0;
+  history_size_ = 0;
+  held_.clear();
+
+  LOG("Negotiated parameters on playback stream with period=", settings_.period_size,
+      " frames (", settings_.ToMilliseconds(settings_.period_size), "ms) and buffer=",
+      settings_.buffer_size, " frames (", settings_.ToMilliseconds(settings_.buffer_size), "ms)");
+
   return error::kSuccess;
 }
 
@@ -67,6 +195,10 @@ error::Code Alsa::ConfigureParameters() {
 error::Code Alsa::Prepare() {
   LOG("Prepare playback stream to play audio");
 
+  // Starting from scratch, so there is nothing to resume
+  history_size_ = 0;
+  held_.clear();
+
   if (snd_pcm_prepare(playback_handle_.get()) < 0) {
     ERROR("Cannot prepare playback stream");
     return error::kUnknownError;
@@ -79,8 +211,24 @@ error::Code Alsa::Prepare() {
 
 error::Code Alsa::Pause() {
   LOG("Pause playback stream");
+  snd_pcm_t *pcm = playback_handle_.get();
 
-  if (snd_pcm_drop(playback_handle_.get()) < 0) {
+  // Stream did not start yet, so frames already written will simply stay in buffer
+  if (snd_pcm_state(pcm) != SND_PCM_STATE_RUNNING) return error::kSuccess;
+
+  if (can_pause_) {
+    if (snd_pcm_pause(pcm, 1) < 0) {
+      ERROR("Cannot pause playback stream");
+      return error::kUnknownError;
+    }
+
+    return error::kSuccess;
+  }
+
+  // Device cannot pause, so keep a copy from frames not played yet before dropping them
+  HoldPendingFrames();
+
+  if (snd_pcm_drop(pcm) < 0) {
     ERROR("Cannot pause playback stream and clear remaining frames on buffer");
     return error::kUnknownError;
   }
@@ -90,8 +238,63 @@ error::Code Alsa::Pause() {
 
 /* ********************************************************************************************** */
 
+error::Code Alsa::Resume() {
+  LOG("Resume playback stream");
+  snd_pcm_t *pcm = playback_handle_.get();
+
+  switch (snd_pcm_state(pcm)) {
+    case SND_PCM_STATE_PAUSED:
+      if (snd_pcm_pause(pcm, 0) < 0) {
+        ERROR("Cannot resume playback stream");
+        return error::kUnknownError;
+      }
+      return error::kSuccess;
+
+    case SND_PCM_STATE_PREPARED:
+    case SND_PCM_STATE_RUNNING:
+      // Nothing was dropped, so just keep writing into it
+      return error::kSuccess;
+
+    default:
+      break;
+  }
+
+  if (snd_pcm_prepare(pcm) < 0) {
+    ERROR("Cannot prepare playback stream");
+    return error::kUnknownError;
+  }
+
+  // Write again frames that were not played before pausing
+  if (!held_.empty()) {
+    std::vector<uint8_t> held;
+    held.swap(held_);
+
+    LOG("Write frames held while paused, size=", held.size());
+    AudioCallback(held.data(), static_cast<int>(held.size() / settings_.format.GetFrameSize()));
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
 error::Code Alsa::Stop() {
   LOG("Stop playback stream");
+  held_.clear();
+
+  if (snd_pcm_drop(playback_handle_.get()) < 0) {
+    ERROR("Cannot stop playback stream and clear remaining frames on buffer");
+    return error::kUnknownError;
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code Alsa::Drain() {
+  LOG("Drain playback stream");
+  held_.clear();
 
   if (snd_pcm_drain(playback_handle_.get()) < 0) {
     ERROR("Cannot stop playback stream and preserve remaining frames on buffer");
@@ -105,7 +308,10 @@ error::Code Alsa::Stop() {
 
 error::Code Alsa::AudioCallback(void *buffer, int size) {
   // As this is called multiple times, LOG will not be called here in the beginning
-  int ret = snd_pcm_writei(playback_handle_.get(), buffer, size);
+  int ret = settings_.mmap ? snd_pcm_mmap_writei(playback_handle_.get(), buffer, size)
+                           : snd_pcm_writei(playback_handle_.get(), buffer, size);
+
+  if (ret > 0) KeepHistory(buffer, ret);
 
   if (ret < 0) {
     ERROR("Cannot write buffer to playback stream, received error=", ret);
@@ -120,6 +326,176 @@ error::Code Alsa::AudioCallback(void *buffer, int size) {
 
 /* ********************************************************************************************** */
 
+void *Alsa::BeginDirectWrite(int &frames) {
+  if (!settings_.mmap || frames <= 0) return nullptr;
+
+  snd_pcm_t *pcm = playback_handle_.get();
+  auto wanted = std::min(static_cast<snd_pcm_sframes_t>(frames),
+                         static_cast<snd_pcm_sframes_t>(settings_.period_size));
+
+  // Block until device has consumed enough frames from buffer
+  snd_pcm_sframes_t available = snd_pcm_avail_update(pcm);
+
+  while (available >= 0 && available < wanted) {
+    if (snd_pcm_wait(pcm, kWaitTimeout) < 0) return nullptr;
+    available = snd_pcm_avail_update(pcm);
+  }
+
+  // In case of error (e.g. underrun), let AudioCallback recover stream
+  if (available < 0) return nullptr;
+
+  const snd_pcm_channel_area_t *areas = nullptr;
+  snd_pcm_uframes_t offset = 0, size = static_cast<snd_pcm_uframes_t>(frames);
+
+  if (snd_pcm_mmap_begin(pcm, &areas, &offset, &size) < 0 || size == 0) return nullptr;
+
+  // As samples are interleaved, all channels share the same area (first and step are in bits)
+  mmap_area_ =
+      static_cast<uint8_t *>(areas[0].addr) + (areas[0].first + offset * areas[0].step) / 8;
+  mmap_offset_ = offset;
+  frames = static_cast<int>(size);
+
+  return mmap_area_;
+}
+
+/* ********************************************************************************************** */
+
+error::Code Alsa::CommitDirectWrite(int frames) {
+  snd_pcm_t *pcm = playback_handle_.get();
+  snd_pcm_sframes_t ret = snd_pcm_mmap_commit(pcm, mmap_offset_, frames);
+
+  if (ret < 0 || ret != frames) {
+    ERROR("Cannot commit frames to playback stream, received error=", ret);
+    snd_pcm_recover(pcm, ret < 0 ? static_cast<int>(ret) : -EPIPE, 1);
+    return error::kUnknownError;
+  }
+
+  KeepHistory(mmap_area_, frames);
+
+  // Unlike snd_pcm_writei, committing frames does not start stream automatically
+  if (snd_pcm_state(pcm) == SND_PCM_STATE_PREPARED) {
+    snd_pcm_sframes_t available = snd_pcm_avail_update(pcm);
+
+    if (available >= 0 &&
+        static_cast<snd_pcm_uframes_t>(settings_.buffer_size - available) >= start_threshold_) {
+      snd_pcm_start(pcm);
+    }
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+int Alsa::GetDelay() {
+  // As this is called multiple times, LOG will not be called here
+  snd_pcm_sframes_t delay = 0;
+
+  // Stream is in a bad state (e.g. underrun), so nothing queued will be heard
+  if (snd_pcm_delay(playback_handle_.get(), &delay) < 0 || delay < 0) return 0;
+
+  return static_cast<int>(delay);
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::KeepHistory(const void *data, int frames) {
+  if (history_.empty() || frames <= 0) return;
+
+  const int frame_size = settings_.format.GetFrameSize();
+  const int capacity = static_cast<int>(settings_.buffer_size);
+  auto src = static_cast<const uint8_t *>(data);
+
+  // Frames older than buffer size were certainly played already
+  if (frames > capacity) {
+    src += static_cast<size_t>(frames - capacity) * frame_size;
+    frames = capacity;
+  }
+
+  int first = std::min(frames, capacity - history_end_);
+  std::memcpy(&history_[history_end_ * frame_size], src, first * frame_size);
+  std::memcpy(&history_[0], src + first * frame_size, (frames - first) * frame_size);
+
+  history_end_ = (history_end_ + frames) % capacity;
+  history_size_ = std::min(history_size_ + frames, capacity);
+}
+
+/* ********************************************************************************************** */
+
+void Alsa::HoldPendingFrames() {
+  held_.clear();
+
+  // Delay is the number of frames written but not played yet
+  snd_pcm_sframes_t delay = 0;
+  if (history_.empty() || snd_pcm_delay(playback_handle_.get(), &delay) < 0 || delay <= 0) return;
+
+  const int frame_size = settings_.format.GetFrameSize();
+  const int capacity = static_cast<int>(settings_.buffer_size);
+  const int pending = std::min(static_cast<int>(delay), history_size_);
+
+  // Pending frames are the latest ones in history
+  int start = (history_end_ - pending + capacity) % capacity;
+  int first = std::min(pending, capacity - start);
+
+  held_.resize(static_cast<size_t>(pending) * frame_size);
+  std::memcpy(held_.data(), &history_[start * frame_size], first * frame_size);
+  std::memcpy(held_.data() + first * frame_size, &history_[0], (pending - first) * frame_size);
+
+  history_size_ = 0;
+  LOG("Hold frames not played yet, count=", pending);
+}
+
+/* ********************************************************************************************** */
+
+snd_pcm_format_t Alsa::ToAlsaFormat(model::AudioFormat::SampleFormat format) {
+  switch (format) {
+    case model::AudioFormat::SampleFormat::S32:
+      return SND_PCM_FORMAT_S32_LE;
+
+    case model::AudioFormat::SampleFormat::Float:
+      return SND_PCM_FORMAT_FLOAT_LE;
+
+    case model::AudioFormat::SampleFormat::S16:
+    default:
+      return SND_PCM_FORMAT_S16_LE;
+  }
+}
+
+/* ********************************************************************************************** */
+
+Alsa::LatencyTarget Alsa::GetLatencyTarget(model::PlaybackSettings::Latency latency) {
+  switch (latency) {
+    case model::PlaybackSettings::Latency::Low:
+      // Around 10ms periods, so pause/seek/equalizer changes are heard almost immediately
+      return LatencyTarget{.period_time = 10000, .buffer_time = 40000};
+
+    case model::PlaybackSettings::Latency::PowerSaving:
+      // Large buffer, so writer thread (and CPU) wakes up only a few times per second
+      return LatencyTarget{.period_time = 125000, .buffer_time = 500000};
+
+    case model::PlaybackSettings::Latency::Balanced:
+    default:
+      // With these values, period size is equal to 1024 frames (considering 44100Hz)
+      return LatencyTarget{.period_time = 23220, .buffer_time = 92900};
+  }
+}
+
+/* ********************************************************************************************** */
+
+std::string Alsa::GetMixerDevice(const std::string &device) {
+  std::string mixer = device;
+
+  // Plugin layer is not relevant for mixer
+  if (mixer.rfind("plughw:", 0) == 0) mixer.erase(0, 4);
+
+  // Remove PCM device index (e.g. "hw:1,0" or "hw:CARD=PCH,DEV=0")
+  if (mixer.rfind("hw:", 0) == 0) mixer = mixer.substr(0, mixer.find(','));
+
+  return mixer;
+}
+
+/* ********************************************************************************************** */
+
 snd_mixer_elem_t *Alsa::GetMasterPlayback() {
   LOG("Use mixer to get master playback");
 
@@ -1,7 +1,12 @@
 #include "audio/driver/ffmpeg.h"
 
+#include <algorithm>
+#include <cerrno>
+#include <cmath>
+#include <cstring>
 #include <iomanip>
 #include <iterator>
+#include <thread>
 
 #include "util/logger.h"
 
@@ -20,15 +25,44 @@ static void log_callback(void *ptr, int level, const char *fmt, va_list vargs) {
   LOG("[LOG_CALLBACK] ", message);
 }
 
-FFmpeg::FFmpeg()
-    : input_stream_{},
+static int read_input(void *opaque, uint8_t *buffer, int size) {
+  auto input = static_cast<audio::FileInput *>(opaque);
+  int result = input->Read(buffer, size);
+
+  if (result < 0) return AVERROR(EIO);
+  return result == 0 ? AVERROR_EOF : result;
+}
+
+static int64_t seek_input(void *opaque, int64_t offset, int whence) {
+  auto input = static_cast<audio::FileInput *>(opaque);
+
+  // Only asking for file size
+  if (whence & AVSEEK_SIZE) return input->GetSize();
+
+  int64_t result = input->Seek(offset, whence & ~AVSEEK_FORCE);
+  return result < 0 ? AVERROR(EINVAL) : result;
+}
+
+/* ********************************************************************************************** */
+
+FFmpeg::FFmpeg(const model::InputSettings &input)
+    : file_input_{input},
+      input_context_{},
+      input_stream_{},
       decoder_{},
+      decoder_threads_{GetThreadCount(input.threads)},
       stream_index_{},
       volume_{1.f},
+      output_format_{},
       filter_graph_{},
       buffersrc_ctx_{},
       buffersink_ctx_{},
-      audio_filters_{} {
+      audio_filters_{},
+      equalizer_{input.equalizer == model::InputSettings::Equalizer::Native
+                     ? std::make_unique<audio::Equalizer>(output_format_.sample_rate)
+                     : nullptr},
+      passthrough_{false},
+      passthrough_buffer_{} {
 #if LIBAVUTIL_VERSION_MAJOR > 56
   ch_layout_.reset(new AVChannelLayout{});
   // Set output channel layout to stereo (2-channel)
@@ -46,8 +80,27 @@ FFmpeg::FFmpeg()
 
 error::Code FFmpeg::OpenInputStream(const std::string &filepath) {
   LOG("Open input stream from filepath=", std::quoted(filepath));
-  AVFormatContext *ptr = nullptr;
+  AVFormatContext *ptr = avformat_alloc_context();
 
+  if (!ptr) {
+    ERROR("Cannot allocate format context");
+    return error::kUnknownError;
+  }
+
+  // Local files are read using custom I/O, everything else (like URLs) is left for FFmpeg itself
+  if (filepath.find("://") == std::string::npos) {
+    error::Code code = CreateInputContext(filepath);
+
+    if (code != error::kSuccess) {
+      avformat_free_context(ptr);
+      return code;
+    }
+
+    ptr->pb = input_context_.get();
+    ptr->flags |= AVFMT_FLAG_CUSTOM_IO;
+  }
+
+  // P.S.: in case of error, format context is released by FFmpeg
   int result = avformat_open_input(&ptr, filepath.c_str(), nullptr, nullptr);
   if (result < 0) {
     ERROR("Cannot open input stream, error=", result);
@@ -67,6 +120,32 @@ error::Code FFmpeg::OpenInputStream(const std::string &filepath) {
 
 /* ********************************************************************************************** */
 
+error::Code FFmpeg::CreateInputContext(const std::string &filepath) {
+  LOG("Create custom I/O context for local file");
+
+  if (!file_input_.Open(filepath)) return error::kFileNotSupported;
+
+  auto buffer = static_cast<uint8_t *>(av_malloc(kInputBufferSize));
+
+  if (!buffer) {
+    ERROR("Cannot allocate buffer for I/O context");
+    return error::kUnknownError;
+  }
+
+  input_context_.reset(avio_alloc_context(buffer, kInputBufferSize, 0, &file_input_, read_input,
+                                          nullptr, seek_input));
+
+  if (!input_context_) {
+    ERROR("Cannot allocate I/O context");
+    av_free(buffer);
+    return error::kUnknownError;
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
 error::Code FFmpeg::ConfigureDecoder() {
   LOG("Configure audio decoder for opened input stream");
 
@@ -114,17 +193,37 @@ error::Code FFmpeg::ConfigureDecoder() {
   }
 #endif
 
+  // Heavy formats (like high-resolution FLAC, WavPack and DSD) would otherwise decode on a single
+  // core, shared with filter chain. Codec chooses which threading type to use from the ones set
+  if (codec->capabilities & (AV_CODEC_CAP_FRAME_THREADS | AV_CODEC_CAP_SLICE_THREADS)) {
+    decoder_->thread_count = decoder_threads_;
+    decoder_->thread_type = FF_THREAD_FRAME | FF_THREAD_SLICE;
+  }
+
   result = avcodec_open2(decoder_.get(), codec, nullptr);
   if (result < 0) {
     ERROR("Cannot initialize audio decoder, error=", result);
     return error::kUnknownError;
   }
 
+  LOG("Initialized audio decoder with codec=", codec->name, " threads=", decoder_->thread_count,
+      " thread_type=", decoder_->active_thread_type);
+
   return error::kSuccess;
 }
 
 /* ********************************************************************************************** */
 
+int FFmpeg::GetThreadCount(uint32_t budget) {
+  if (budget > 0) return static_cast<int>(budget);
+
+  // P.S.: hardware concurrency may be zero, when it is not computable
+  int cores = static_cast<int>(std::thread::hardware_concurrency());
+  return std::clamp(cores, 1, kMaxAutoThreads);
+}
+
+/* ********************************************************************************************** */
+
 error::Code FFmpeg::ConfigureFilters() {
   LOG("Configure filter chain");
 
@@ -143,13 +242,16 @@ error::Code FFmpeg::ConfigureFilters() {
   result = CreateFilterVolume();
   if (result != error::kSuccess) return result;
 
-  // Create and configure all equalizer filters
-  LOG("Create new equalizer filters, size=", audio_filters_.size());
-  for (const auto &entry : audio_filters_) {
-    result = CreateFilterEqualizer(entry.first, entry.second);
+  // Create and configure all equalizer filters (unless using native equalizer)
+  LOG("Create new equalizer filters, size=", GetEqualizerCount());
+  for (size_t i = 0; i < GetEqualizerCount(); i++) {
+    result = CreateFilterEqualizer(GetEqualizerName(i), audio_filters_[i]);
     if (result != error::kSuccess) return result;
   }
 
+  // Filter graph was created again, so there is no history to keep from previous samples
+  if (equalizer_) equalizer_->Reset();
+
   // Create and configure aformat filter
   result = CreateFilterAformat();
   if (result != error::kSuccess) return result;
@@ -284,9 +386,10 @@ error::Code FFmpeg::CreateFilterAformat() {
 
   // Set filter options through the AVOptions API
   av_opt_set(aformat_ctx, "channel_layout", ch_layout, AV_OPT_SEARCH_CHILDREN);
-  av_opt_set(aformat_ctx, "sample_fmts", av_get_sample_fmt_name(AV_SAMPLE_FMT_S16),
+  av_opt_set(aformat_ctx, "sample_fmts",
+             av_get_sample_fmt_name(ToAVSampleFormat(output_format_.sample_format)),
              AV_OPT_SEARCH_CHILDREN);
-  av_opt_set_int(aformat_ctx, "sample_rate", kSampleRate, AV_OPT_SEARCH_CHILDREN);
+  av_opt_set_int(aformat_ctx, "sample_rate", output_format_.sample_rate, AV_OPT_SEARCH_CHILDREN);
 
   // Initialize filter
   int result = avfilter_init_str(aformat_ctx, nullptr);
@@ -379,14 +482,15 @@ error::Code FFmpeg::ConnectFilters() {
 
   // Filters will be linked considering the ordination in this vector
   std::vector<AVFilterContext *> filters_to_link;
-  filters_to_link.reserve(kDefaultFilterCount + audio_filters_.size());
+  filters_to_link.reserve(kDefaultFilterCount + GetEqualizerCount());
 
   // Add both abuffer and volume filters
   filters_to_link.insert(filters_to_link.end(), {buffersrc_ctx_.get(), volume_ctx});
 
   // Add equalizer filters
-  for (const auto &entry : audio_filters_) {
-    filters_to_link.push_back(avfilter_graph_get_filter(filter_graph_.get(), entry.first.c_str()));
+  for (size_t i = 0; i < GetEqualizerCount(); i++) {
+    filters_to_link.push_back(
+        avfilter_graph_get_filter(filter_graph_.get(), GetEqualizerName(i).c_str()));
   }
 
   // Add aformat and abuffersink filters
@@ -420,24 +524,28 @@ error::Code FFmpeg::ConnectFilters() {
 
 /* ********************************************************************************************** */
 
-void FFmpeg::FillAudioInformation(model::Song &audio_info) {
+void FFmpeg::FillAudioInformation(const AVFormatContext *context, int stream_index,
+                                  model::Song &audio_info) {
   LOG("Fill song structure with audio information");
 
   // use this to get all metadata associated to this audio file
   //   const AVDictionaryEntry *tag = nullptr;
-  //   while ((tag = av_dict_get(input_stream_->metadata, "", tag, AV_DICT_IGNORE_SUFFIX)))
+  //   while ((tag = av_dict_get(context->metadata, "", tag, AV_DICT_IGNORE_SUFFIX)))
   //     LOG("key=", tag->key," value=", tag->value);
-  const AVDictionaryEntry *tag = nullptr;
+  const AVStream *stream = context->streams[stream_index];
 
-  // Get track name
-  tag = av_dict_get(input_stream_->metadata, "title", tag, AV_DICT_IGNORE_SUFFIX);
-  if (tag) audio_info.title = std::string{tag->value};
+  // Each tag is searched from the beginning of dictionary, first in container and then in stream
+  auto get_tag = [&](const char *key) -> std::string {
+    const AVDictionaryEntry *tag = av_dict_get(context->metadata, key, nullptr, 0);
+    if (!tag) tag = av_dict_get(stream->metadata, key, nullptr, 0);
 
-  // Get artist name
-  tag = av_dict_get(input_stream_->metadata, "artist", tag, AV_DICT_IGNORE_SUFFIX);
-  if (tag) audio_info.artist = std::string{tag->value};
+    return tag ? std::string{tag->value} : std::string{};
+  };
+
+  audio_info.title = get_tag("title");
+  audio_info.artist = get_tag("artist");
 
-  const AVCodecParameters *audio_stream = input_stream_->streams[stream_index_]->codecpar;
+  const AVCodecParameters *audio_stream = stream->codecpar;
 
 #if LIBAVUTIL_VERSION_MAJOR > 56
   audio_info.num_channels = (uint16_t)audio_stream->ch_layout.nb_channels;
@@ -446,8 +554,12 @@ void FFmpeg::FillAudioInformation(model::Song &audio_info) {
 #endif
   audio_info.sample_rate = (uint32_t)audio_stream->sample_rate;
   audio_info.bit_rate = (uint32_t)audio_stream->bit_rate;
-  audio_info.bit_depth = (uint32_t)sample_fmt_info[audio_stream->format].bits;
-  audio_info.duration = (uint32_t)(input_stream_->duration / AV_TIME_BASE);
+  audio_info.duration = (uint32_t)(context->duration / AV_TIME_BASE);
+
+  // Probed streams may not have a known sample format (e.g. AV_SAMPLE_FMT_NONE)
+  int format = audio_stream->format;
+  bool valid = format >= 0 && format < AV_SAMPLE_FMT_NB;
+  audio_info.bit_depth = valid ? (uint32_t)sample_fmt_info[format].bits : 0;
 }
 
 /* ********************************************************************************************** */
@@ -468,26 +580,81 @@ error::Code FFmpeg::OpenFile(model::Song &audio_info) {
   result = ConfigureFilters();
   if (result != error::kSuccess) return clean_up_and_return(result);
 
+  result = CreateDecodingContext();
+  if (result != error::kSuccess) return clean_up_and_return(result);
+
   // At this point, we can get detailed information about the song
-  FillAudioInformation(audio_info);
+  FillAudioInformation(input_stream_.get(), stream_index_, audio_info);
 
   return result;
 }
 
 /* ********************************************************************************************** */
 
-error::Code FFmpeg::Decode(int samples, AudioCallback callback) {
-  LOG("Decode song using maximum sample=", samples);
+error::Code FFmpeg::ProbeFile(model::Song &audio_info) {
+  LOG("Probe file to extract metadata from filepath=", std::quoted(audio_info.filepath));
+
+  // Limit how much is read and analyzed, as only the stream parameters and tags are needed
+  AVDictionary *options = nullptr;
+  av_dict_set_int(&options, "probesize", kProbeSize, 0);
+  av_dict_set_int(&options, "analyzeduration", kAnalyzeDuration, 0);
+
+  // P.S.: in case of error, format context is released by FFmpeg
+  AVFormatContext *ptr = nullptr;
+  int result = avformat_open_input(&ptr, audio_info.filepath.c_str(), nullptr, &options);
+  av_dict_free(&options);
+
+  if (result < 0) {
+    ERROR("Cannot open file to probe, error=", result);
+    return error::kFileNotSupported;
+  }
+
+  FormatContext context{ptr};
+
+  result = avformat_find_stream_info(context.get(), nullptr);
+  if (result < 0) {
+    ERROR("Cannot find stream info about probed file, error=", result);
+    return error::kFileNotSupported;
+  }
+
+#if LIBAVFORMAT_VERSION_MAJOR > 58
+  const AVCodec *codec = nullptr;
+#else
+  AVCodec *codec = nullptr;
+#endif
+
+  // Same as when opening file, song is only listed if there is a decoder for its audio stream
+  int stream_index = av_find_best_stream(context.get(), AVMEDIA_TYPE_AUDIO, -1, -1, &codec, 0);
+
+  if (stream_index < 0 || !codec) {
+    ERROR("Cannot find audio decoder to probed file");
+    return error::kFileNotSupported;
+  }
+
+  FillAudioInformation(context.get(), stream_index, audio_info);
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FFmpeg::CreateDecodingContext() {
+  LOG("Create internal structures for decoding");
 
   // Allocate internal decoding structure
   shared_context_ = DecodingData{
       .time_base = input_stream_->streams[stream_index_]->time_base,
       .position = 0,
+      .timestamp = 0,
+      .seek_target = AV_NOPTS_VALUE,
       .packet{Packet(av_packet_alloc())},
       .frame_decoded{Frame(av_frame_alloc())},
       .frame_filtered{Frame(av_frame_alloc())},
+      .carry_over{},
+      .carry_offset = 0,
+      .carry_position = 0,
       .err_code = error::kSuccess,
-      .keep_playing = true,
+      .draining = false,
+      .finished = false,
       .reset_filters = false,
   };
 
@@ -496,45 +663,96 @@ error::Code FFmpeg::Decode(int samples, AudioCallback callback) {
     return error::kUnknownError;
   }
 
-  AVPacket *packet = shared_context_.packet.get();
-  AVFrame *frame = shared_context_.frame_decoded.get();
+  return error::kSuccess;
+}
 
-  // Read audio raw data from input stream
-  while (av_read_frame(input_stream_.get(), packet) >= 0 && shared_context_.KeepDecoding()) {
-    // If not the same stream index, we should not try to decode it
-    if (packet->stream_index != stream_index_) {
-      av_packet_unref(packet);
+/* ********************************************************************************************** */
+
+error::Code FFmpeg::Read(void *buffer, int &frames, int64_t &position) {
+  if (!shared_context_.CheckAllocations()) {
+    ERROR("Cannot read from song, as there is no file opened");
+    frames = 0;
+    return error::kUnknownError;
+  }
+
+  auto &context = shared_context_;
+  auto output = static_cast<uint8_t *>(buffer);
+  int frame_size = output_format_.GetFrameSize();
+  int requested = frames;
+
+  frames = 0;
+  position = context.position;
+
+  while (frames < requested) {
+    int available = static_cast<int>(context.carry_over.size() / frame_size) - context.carry_offset;
+
+    // Nothing left from last decoded chunk, so decode a new one
+    if (available <= 0) {
+      if (!DecodeChunk()) break;
       continue;
     }
 
-    // Send packet to decoder
-    if (avcodec_send_packet(decoder_.get(), packet) < 0) {
-      ERROR("Cannot decode song");
-      return error::kDecodeFileFailed;
+    // Position from the first frame returned to caller
+    if (frames == 0) {
+      position = context.carry_position +
+                 av_rescale(context.carry_offset, 1000, output_format_.sample_rate);
     }
 
-    // Receive frames from decoder
-    while (avcodec_receive_frame(decoder_.get(), frame) >= 0 && shared_context_.KeepDecoding()) {
-      // Note that AVPacket.pts is in AVStream.time_base units, not AVCodecContext.time_base units
-      shared_context_.position = packet->pts / shared_context_.time_base.den;
+    int count = std::min(available, requested - frames);
+    std::memcpy(output + static_cast<size_t>(frames) * frame_size,
+                context.carry_over.data() + static_cast<size_t>(context.carry_offset) * frame_size,
+                static_cast<size_t>(count) * frame_size);
 
-      // UI sent event to update audio filters with new parameters, so it is necessary to reset it
-      if (shared_context_.reset_filters) {
-        shared_context_.err_code = ConfigureFilters();
-        shared_context_.reset_filters = false;
-      }
+    context.carry_offset += count;
+    frames += count;
+  }
 
-      // Pass decoded frame to be processed by filtergraph. And in case of error while processing
-      // frame, shared_context_.KeepDecoding() will return false, so do not worry about it
-      ProcessFrame(samples, callback);
+  return context.err_code;
+}
 
-      shared_context_.ClearFrames();
-    }
+/* ********************************************************************************************** */
+
+error::Code FFmpeg::Seek(int64_t position) {
+  if (!shared_context_.CheckAllocations()) {
+    ERROR("Cannot seek song, as there is no file opened");
+    return error::kUnknownError;
+  }
+
+  LOG("Seek song position=", position, "ms");
+  auto &context = shared_context_;
+
+  // Samples decoded from old position must not be read anymore
+  context.ClearCarryOver();
+  DiscardFilteredFrames();
+
+  // Recalculate new position
+  int64_t target = av_rescale_q(position, kPositionTimeBase, context.time_base);
+  int64_t distance = av_rescale_q(target - context.timestamp, context.time_base, kPositionTimeBase);
 
-    shared_context_.ClearPacket();
+  // Samples before target position will be discarded right after decoding
+  context.seek_target = target;
+  context.position = position;
+
+  // Jumping a little bit ahead, so keep decoding from here (avoid seeking and decoding it all again
+  // from the previous keyframe, which makes repeated seeks much cheaper)
+  if (!context.draining && distance >= 0 && distance <= kMaxSeekDecodeAhead) {
+    return error::kSuccess;
+  }
+
+  // Clear internal buffers
+  context.ClearFrames();
+  avcodec_flush_buffers(decoder_.get());
+
+  context.draining = false;
+  context.finished = false;
+
+  // Seek closest keyframe before target position
+  if (av_seek_frame(input_stream_.get(), stream_index_, target, AVSEEK_FLAG_BACKWARD) < 0) {
+    ERROR("Cannot seek frame in song");
+    context.err_code = error::kSeekFrameFailed;
   }
 
-  return shared_context_.err_code;
+  return context.err_code;
 }
 
 /* ********************************************************************************************** */
@@ -543,6 +761,8 @@ void FFmpeg::ClearCache() {
   LOG("Clear internal cache");
   // decoding
   input_stream_.reset();
+  input_context_.reset();
+  file_input_.Close();
   decoder_.reset();
   stream_index_ = 0;
 
@@ -550,14 +770,28 @@ void FFmpeg::ClearCache() {
   buffersrc_ctx_.reset();
   buffersink_ctx_.reset();
 
-  // custom data for audio filters
-  audio_filters_.clear();
-
   // clear internal structure used for sharing context
   shared_context_ = DecodingData{};
 
   // main structure to handle all created filters
   filter_graph_.reset();
+  passthrough_ = false;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FFmpeg::SetOutputFormat(const model::AudioFormat &format) {
+  if (format == output_format_) return error::kSuccess;
+
+  LOG("Set output format to new value=", format);
+  output_format_ = format;
+
+  if (equalizer_) equalizer_->SetSampleRate(static_cast<int>(format.sample_rate));
+
+  // In case that some song is already opened, filter graph must be recreated to use it
+  if (filter_graph_) return ConfigureFilters();
+
+  return error::kSuccess;
 }
 
 /* ********************************************************************************************** */
@@ -571,17 +805,7 @@ error::Code FFmpeg::SetVolume(model::Volume value) {
 
   // Otherwise, it means that some music is playing, so we gotta update the running filtergraph
   LOG("Found volume filter, update value");
-  std::string volume = model::to_string(volume_);
-  std::string response(kResponseSize, ' ');
-
-  // Set filter option
-  if (avfilter_graph_send_command(filter_graph_.get(), kFilterVolume, "volume", volume.c_str(),
-                                  response.data(), kResponseSize, AV_OPT_SEARCH_CHILDREN)) {
-    ERROR("Cannot set new value for volume filter, error=", response);
-    return error::kUnknownError;
-  }
-
-  return error::kSuccess;
+  return SendFilterCommand(kFilterVolume, "volume", model::to_string(volume_));
 }
 
 /* ********************************************************************************************** */
@@ -593,19 +817,37 @@ model::Volume FFmpeg::GetVolume() const { return volume_; }
 error::Code FFmpeg::UpdateFilters(const std::vector<model::AudioFilter> &filters) {
   LOG("Update audio filters in the internal structure");
 
-  // Clear internal structure
-  audio_filters_.clear();
-
   for (const auto &filter : filters) {
     if (filter.frequency == 0 || filter.Q == 0) {
       ERROR("Zeroed filter is not permitted");
       return error::kUnknownError;
     }
+  }
+
+  // Native equalizer does not depend on filter graph at all
+  if (equalizer_) {
+    audio_filters_ = filters;
+    equalizer_->SetFilters(audio_filters_);
+    return error::kSuccess;
+  }
+
+  // In case that music is playing with the same number of equalizers, it is possible to update
+  // them in place, without having to rebuild the whole filter graph
+  if (filter_graph_ && !shared_context_.reset_filters && filters.size() == audio_filters_.size()) {
+    for (size_t i = 0; i < filters.size(); i++) {
+      if (UpdateFilterEqualizer(i, audio_filters_[i], filters[i]) != error::kSuccess) {
+        // Something went wrong, so fallback to rebuild filter graph
+        shared_context_.reset_filters = true;
+        break;
+      }
+    }
 
-    std::string name{filter.GetName()};
-    audio_filters_[name] = filter;
+    audio_filters_ = filters;
+    return error::kSuccess;
   }
 
+  audio_filters_ = filters;
+
   // In case that music is playing, must reset filter graph
   if (filter_graph_) shared_context_.reset_filters = true;
 
@@ -614,72 +856,373 @@ error::Code FFmpeg::UpdateFilters(const std::vector<model::AudioFilter> &filters
 
 /* ********************************************************************************************** */
 
-void FFmpeg::ProcessFrame(int samples, AudioCallback callback) {
-  // Get source and sink
-  AVFilterContext *source = buffersrc_ctx_.get();
-  AVFilterContext *sink = buffersink_ctx_.get();
+error::Code FFmpeg::UpdateFilterEqualizer(size_t index, const model::AudioFilter &current,
+                                          const model::AudioFilter &updated) {
+  std::string name = GetEqualizerName(index);
+  error::Code result = error::kSuccess;
+
+  // Send commands only for parameters that have changed
+  if (updated.frequency != current.frequency) {
+    result = SendFilterCommand(name, "frequency", std::to_string(updated.frequency));
+  }
+
+  if (result == error::kSuccess && updated.Q != current.Q) {
+    result = SendFilterCommand(name, "width", std::to_string(updated.Q));
+  }
+
+  if (result == error::kSuccess && updated.gain != current.gain) {
+    result = SendFilterCommand(name, "gain", std::to_string(updated.gain));
+  }
+
+  return result;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FFmpeg::SendFilterCommand(const std::string &target, const std::string &command,
+                                      const std::string &value) {
+  std::string response(kResponseSize, ' ');
 
-  // Get allocated pointer for frames (decoded and filtered)
+  // Send command to the running filter graph, it takes effect on the next processed frame
+  if (avfilter_graph_send_command(filter_graph_.get(), target.c_str(), command.c_str(),
+                                  value.c_str(), response.data(), kResponseSize,
+                                  AV_OPT_SEARCH_CHILDREN)) {
+    ERROR("Cannot set new value for ", command, " in filter ", target, ", error=", response);
+    return error::kUnknownError;
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::DecodeChunk() {
+  auto &context = shared_context_;
+  AVFrame *frame = context.frame_decoded.get();
+
+  context.ClearCarryOver();
+
+  while (context.KeepDecoding()) {
+    // Filter chain may still have samples from previous decoded frames
+    if (!passthrough_ && PullFilteredFrame()) return true;
+
+    int result = avcodec_receive_frame(decoder_.get(), frame);
+
+    if (result == AVERROR(EAGAIN)) {
+      // Decoder needs more data to output a new frame
+      SendNextPacket();
+      continue;
+    }
+
+    if (result == AVERROR_EOF) {
+      LOG("Decoder has no frame left");
+      context.finished = true;
+      break;
+    }
+
+    if (result < 0) {
+      ERROR("Cannot receive frame from decoder, error=", result);
+      context.err_code = error::kDecodeFileFailed;
+      break;
+    }
+
+    // Note that timestamps are in AVStream.time_base units, not AVCodecContext.time_base units
+    if (frame->best_effort_timestamp != AV_NOPTS_VALUE) {
+      frame->pts = frame->best_effort_timestamp;
+    } else if (frame->pts == AV_NOPTS_VALUE) {
+      frame->pts = context.timestamp;
+    }
+
+    // Still decoding samples that come before the exact position requested by seek
+    if (!DiscardUntilSeekTarget(frame)) {
+      context.ClearFrames();
+      continue;
+    }
+
+    AVRational sample_time_base{1, frame->sample_rate};
+    context.timestamp = frame->pts + av_rescale_q(frame->nb_samples, sample_time_base,
+                                                  context.time_base);
+    context.position = av_rescale_q(frame->pts, context.time_base, kPositionTimeBase);
+
+    // UI sent event to update audio filters with new parameters, so it is necessary to reset it
+    if (context.reset_filters) {
+      context.err_code = ConfigureFilters();
+      context.reset_filters = false;
+    }
+
+    // Pass decoded frame to be processed by filtergraph. And in case of error while processing
+    // frame, context.KeepDecoding() will return false, so do not worry about it
+    if (context.KeepDecoding()) ProcessFrame();
+
+    context.ClearFrames();
+
+    if (!context.carry_over.empty()) return true;
+  }
+
+  return !context.carry_over.empty();
+}
+
+/* ********************************************************************************************** */
+
+void FFmpeg::SendNextPacket() {
+  auto &context = shared_context_;
+  AVPacket *packet = context.packet.get();
+
+  // Decoder is already returning its remaining frames, nothing else to send
+  if (context.draining) {
+    context.finished = true;
+    return;
+  }
+
+  // Read audio raw data from input stream
+  while (av_read_frame(input_stream_.get(), packet) >= 0) {
+    // If not the same stream index, we should not try to decode it
+    if (packet->stream_index != stream_index_) {
+      context.ClearPacket();
+      continue;
+    }
+
+    // Send packet to decoder
+    int result = avcodec_send_packet(decoder_.get(), packet);
+    context.ClearPacket();
+
+    if (result < 0) {
+      ERROR("Cannot decode song, error=", result);
+      context.err_code = error::kDecodeFileFailed;
+    }
+
+    return;
+  }
+
+  // Reached end of input stream, so send an empty packet to get frames still buffered in decoder
+  LOG("Reached end of input stream, drain decoder");
+  context.draining = true;
+  avcodec_send_packet(decoder_.get(), nullptr);
+}
+
+/* ********************************************************************************************** */
+
+void FFmpeg::ProcessFrame() {
   AVFrame *decoded = shared_context_.frame_decoded.get();
-  AVFrame *filtered = shared_context_.frame_filtered.get();
+
+  if (CanPassthrough(decoded)) {
+    // Filter chain would not change anything, so skip it
+    if (!passthrough_) {
+      LOG("Enable passthrough, decoded frames will skip filter chain");
+
+      // Keep samples still buffered in filter chain, to keep audio continuous
+      while (PullFilteredFrame()) {
+      }
+
+      passthrough_ = true;
+    }
+
+    AppendCarryOver(InterleaveSamples(decoded), decoded->nb_samples);
+    return;
+  }
+
+  if (passthrough_) {
+    LOG("Disable passthrough, decoded frames will be processed by filter chain");
+    passthrough_ = false;
+  }
 
   // Push the audio data from decoded frame into the filtergraph
+  AVFilterContext *source = buffersrc_ctx_.get();
   if (av_buffersrc_add_frame_flags(source, decoded, AV_BUFFERSRC_FLAG_KEEP_REF) < 0) {
     ERROR("Cannot feed audio filtergraph");
     shared_context_.err_code = error::kDecodeFileFailed;
     return;
   }
 
-  int result;
-  bool seek_frame = false;
-  int64_t old_position = shared_context_.position;
+  PullFilteredFrame();
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::PullFilteredFrame() {
+  AVFilterContext *sink = buffersink_ctx_.get();
+  AVFrame *filtered = shared_context_.frame_filtered.get();
+
+  if (!sink) return false;
 
   // Pull filtered audio from the filtergraph
-  while ((result = av_buffersink_get_samples(sink, filtered, samples)) >= 0 &&
-         shared_context_.KeepDecoding()) {
-    // Send filtered audio data to Player
-    shared_context_.keep_playing =
-        callback((void *)filtered->data[0], filtered->nb_samples, shared_context_.position);
-
-    // Clear frame from filtergraph
-    av_frame_unref(filtered);
-
-    // Updated song cursor position
-    if (shared_context_.position != old_position) {
-      seek_frame = true;
-      break;
-    }
+  int result = av_buffersink_get_frame(sink, filtered);
 
-    // In case of EQ update
-    if (shared_context_.reset_filters) {
-      break;
+  if (result < 0) {
+    // Check if got some critical error
+    if (result != AVERROR(EAGAIN) && result != AVERROR_EOF) {
+      ERROR("Cannot pull data from audio filtergraph, error=", result);
+      shared_context_.err_code = error::kDecodeFileFailed;
     }
+
+    return false;
   }
 
-  // Check if got some critical error
-  if (result < 0 && result != AVERROR(EAGAIN) && result != AVERROR_EOF) {
-    ERROR("Cannot pull data from audio filtergraph, error=", result);
-    shared_context_.err_code = error::kDecodeFileFailed;
+  // Equalize audio data in a single pass (filter chain always outputs interleaved samples)
+  if (equalizer_ && GetChannels(filtered) == kChannels) {
+    Equalize(filtered->data[0], filtered->nb_samples);
   }
 
-  // Seek new position in song
-  if (shared_context_.KeepDecoding() && seek_frame) {
-    // Clear internal buffers
-    shared_context_.ClearFrames();
-    avcodec_flush_buffers(decoder_.get());
+  AppendCarryOver(filtered->data[0], filtered->nb_samples);
 
-    // Recalculate new position
-    int64_t target = av_rescale_q(shared_context_.position * AV_TIME_BASE, AV_TIME_BASE_Q,
-                                  shared_context_.time_base);
+  // Clear frame from filtergraph
+  av_frame_unref(filtered);
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+void FFmpeg::DiscardFilteredFrames() {
+  AVFilterContext *sink = buffersink_ctx_.get();
+  AVFrame *filtered = shared_context_.frame_filtered.get();
+
+  if (!sink) return;
+
+  while (av_buffersink_get_frame(sink, filtered) >= 0) av_frame_unref(filtered);
+}
 
-    // Seek new frame
-    if (av_seek_frame(input_stream_.get(), stream_index_, target, AVSEEK_FLAG_BACKWARD) < 0) {
-      ERROR("Cannot seek frame in song");
-      shared_context_.err_code = error::kSeekFrameFailed;
+/* ********************************************************************************************** */
+
+void FFmpeg::AppendCarryOver(const uint8_t *data, int frames) {
+  auto &carry_over = shared_context_.carry_over;
+  size_t size = static_cast<size_t>(frames) * output_format_.GetFrameSize();
+
+  // First samples in buffer, so they start at the position from last decoded frame
+  if (carry_over.empty()) shared_context_.carry_position = shared_context_.position;
+
+  carry_over.insert(carry_over.end(), data, data + size);
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::CanPassthrough(const AVFrame *frame) const {
+  // Volume must be at 100% (and not muted)
+  if (static_cast<float>(volume_) != 1.f) return false;
+
+  // Equalizer must be flat
+  if (std::any_of(audio_filters_.begin(), audio_filters_.end(),
+                  [](const model::AudioFilter &filter) { return filter.gain != 0; })) {
+    return false;
+  }
+
+  // Resampling and channel remixing are left to the filter chain
+  if (frame->sample_rate != static_cast<int>(output_format_.sample_rate) ||
+      GetChannels(frame) != kChannels) {
+    return false;
+  }
+
+  // Same sample format as output (packed or planar)
+  auto format = static_cast<AVSampleFormat>(frame->format);
+  if (av_get_packed_sample_fmt(format) == ToAVSampleFormat(output_format_.sample_format)) {
+    return true;
+  }
+
+  // Float samples converted to signed 16-bit
+  return output_format_.sample_format == model::AudioFormat::SampleFormat::S16 &&
+         (format == AV_SAMPLE_FMT_FLT || format == AV_SAMPLE_FMT_FLTP);
+}
+
+/* ********************************************************************************************** */
+
+uint8_t *FFmpeg::InterleaveSamples(const AVFrame *frame) {
+  auto format = static_cast<AVSampleFormat>(frame->format);
+
+  // Already in the output format, nothing to do
+  if (format == ToAVSampleFormat(output_format_.sample_format)) return frame->data[0];
+
+  size_t size = static_cast<size_t>(frame->nb_samples) * output_format_.GetFrameSize();
+  if (passthrough_buffer_.size() < size) passthrough_buffer_.resize(size);
+
+  uint8_t *output = passthrough_buffer_.data();
+
+  // Float samples converted to signed 16-bit
+  if (output_format_.sample_format == model::AudioFormat::SampleFormat::S16 &&
+      av_get_packed_sample_fmt(format) == AV_SAMPLE_FMT_FLT) {
+    auto to_s16 = [](float value) {
+      return static_cast<int16_t>(std::lrint(std::clamp(value * 32768.f, -32768.f, 32767.f)));
+    };
+
+    auto samples = reinterpret_cast<int16_t *>(output);
+
+    if (av_sample_fmt_is_planar(format)) {
+      // Each channel is in a separate data plane
+      auto left = reinterpret_cast<const float *>(frame->extended_data[0]);
+      auto right = reinterpret_cast<const float *>(frame->extended_data[1]);
+      for (int i = 0; i < frame->nb_samples; i++) {
+        samples[2 * i] = to_s16(left[i]);
+        samples[2 * i + 1] = to_s16(right[i]);
+      }
+    } else {
+      auto input = reinterpret_cast<const float *>(frame->data[0]);
+      for (int i = 0; i < frame->nb_samples * kChannels; i++) samples[i] = to_s16(input[i]);
+    }
+
+    return output;
+  }
+
+  // Same sample format as output, but planar, so it only needs to interleave channels
+  int sample_size = output_format_.GetSampleSize();
+
+  for (int i = 0; i < frame->nb_samples; i++) {
+    for (int ch = 0; ch < kChannels; ch++) {
+      std::memcpy(output, frame->extended_data[ch] + i * sample_size, sample_size);
+      output += sample_size;
     }
+  }
+
+  return passthrough_buffer_.data();
+}
+
+/* ********************************************************************************************** */
 
-    seek_frame = false;
+void FFmpeg::Equalize(uint8_t *buffer, int frames) {
+  switch (output_format_.sample_format) {
+    case model::AudioFormat::SampleFormat::S16:
+      equalizer_->Process(reinterpret_cast<int16_t *>(buffer), frames);
+      break;
+
+    case model::AudioFormat::SampleFormat::S32:
+      equalizer_->Process(reinterpret_cast<int32_t *>(buffer), frames);
+      break;
+
+    case model::AudioFormat::SampleFormat::Float:
+      equalizer_->Process(reinterpret_cast<float *>(buffer), frames);
+      break;
+  }
+}
+
+/* ********************************************************************************************** */
+
+bool FFmpeg::DiscardUntilSeekTarget(AVFrame *frame) {
+  int64_t target = shared_context_.seek_target;
+  if (target == AV_NOPTS_VALUE || frame->pts == AV_NOPTS_VALUE) return true;
+
+  // Number of samples in this frame that come before target position
+  AVRational sample_time_base{1, frame->sample_rate};
+  int64_t skip = av_rescale_q(target - frame->pts, shared_context_.time_base, sample_time_base);
+
+  if (skip >= frame->nb_samples) return false;
+
+  // Reached target position, so stop discarding samples from now on
+  shared_context_.seek_target = AV_NOPTS_VALUE;
+  if (skip <= 0) return true;
+
+  if (av_frame_make_writable(frame) < 0) {
+    ERROR("Cannot discard samples before seek position");
+    return true;
   }
+
+  // Move remaining samples to the beginning of frame
+  int count = frame->nb_samples - static_cast<int>(skip);
+  auto format = static_cast<AVSampleFormat>(frame->format);
+
+  av_samples_copy(frame->extended_data, frame->extended_data, 0, static_cast<int>(skip), count,
+                  GetChannels(frame), format);
+
+  frame->nb_samples = count;
+  frame->pts = target;
+
+  return true;
 }
 
 }  // namespace driver
@@ -1,17 +1,24 @@
 #include "audio/driver/fftw.h"
 
+#include <algorithm>
 #include <cmath>
 #include <cstring>
 #include <iostream>
+#include <system_error>
+
+#include "util/logger.h"
 
 namespace driver {
 
-FFTW::FFTW()
-    : bass_{},
+FFTW::FFTW(const std::filesystem::path& wisdom)
+    : wisdom_{wisdom},
+      bass_{},
       mid_{},
       treble_{},
       input_size_{},
-      input_{},
+      input_position_{},
+      input_left_{},
+      input_right_{},
       previous_output_{},
       memory_{},
       peak_{},
@@ -27,7 +34,8 @@ FFTW::FFTW()
       sensitivity_{},
       sens_init_{},
       bars_per_channel_{},
-      output_size_{} {}
+      output_size_{},
+      sample_rate_{kSampleRate} {}
 
 /* ********************************************************************************************** */
 
@@ -36,6 +44,12 @@ error::Code FFTW::Init(int output_size) {
     return error::kUnknownError;
   }
 
+  // FFT sizes never change, so plans are created only once and reused whenever number of bars
+  // changes (e.g. on terminal resize)
+  if (!bass_.plan) {
+    CreatePlans();
+  }
+
   if (output_size_ != output_size) {
     output_size_ = output_size;
     bars_per_channel_ = output_size / 2;
@@ -44,21 +58,8 @@ error::Code FFTW::Init(int output_size) {
   frame_rate_ = 75;
   sensitivity_ = 1;
   sens_init_ = 1;
-  bass_.buffer_size = kBufferSize * 8;
-  mid_.buffer_size = kBufferSize * 4;
-  treble_.buffer_size = kBufferSize;
-
-  // Hann Window calculate multipliers
-  CreateHannWindow(bass_);
-  CreateHannWindow(mid_);
-  CreateHannWindow(treble_);
 
-  // Allocate FFTW structures
-  CreateFftwStructure(bass_);
-  CreateFftwStructure(mid_);
-  CreateFftwStructure(treble_);
-
-  // Create input buffers
+  // Create buffers for each bar
   CreateBuffers();
 
   // Calculate cutoff frequencies and equalize result
@@ -69,11 +70,30 @@ error::Code FFTW::Init(int output_size) {
 
 /* ********************************************************************************************** */
 
-error::Code FFTW::Execute(double* in, int size, double* out) {
+error::Code FFTW::SetSampleRate(int sample_rate) {
+  if (sample_rate <= 0) {
+    return error::kUnknownError;
+  }
+
+  if (sample_rate_ == sample_rate) {
+    return error::kSuccess;
+  }
+
+  sample_rate_ = sample_rate;
+
+  // Frequency distribution only exists after initialization
+  if (output_size_ > 0) CalculateFrequencies();
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code FFTW::Execute(const float* left, const float* right, int frames, double* out) {
   int silence = 1;
 
   // Use raw data to fill input
-  FillInputBuffer(in, size, silence);
+  FillInputBuffer(left, right, frames, silence);
 
   // Fill the bass, mid and treble buffers
   ApplyFft(bass_);
@@ -91,50 +111,101 @@ error::Code FFTW::Execute(double* in, int size, double* out) {
 
 /* ********************************************************************************************** */
 
-void FFTW::CreateHannWindow(FreqAnalysis& analysis) {
-  analysis.multiplier.reset(fftw_alloc_real(analysis.buffer_size));
+void FFTW::CreatePlans() {
+  LOG("Create FFTW plans for audio analysis");
 
-  for (int i = 0; i < analysis.buffer_size; i++) {
-    analysis.multiplier.get()[i] = 0.5 * (1 - std::cos(2 * M_PI * i / (analysis.buffer_size - 1)));
+  // Reuse plans measured on previous executions, if any
+  ImportWisdom();
+
+  bass_.buffer_size = kBufferSize * 8;
+  mid_.buffer_size = kBufferSize * 4;
+  treble_.buffer_size = kBufferSize;
+
+  // Hann Window calculate multipliers
+  CreateHannWindow(bass_);
+  CreateHannWindow(mid_);
+  CreateHannWindow(treble_);
+
+  // Allocate FFTW structures
+  CreateFftwStructure(bass_);
+  CreateFftwStructure(mid_);
+  CreateFftwStructure(treble_);
+
+  // Create input buffers (only the largest audio range needs the whole history, which is mirrored)
+  input_size_ = bass_.buffer_size;
+  input_position_ = 0;
+  input_left_ = std::vector<float>(2 * input_size_, 0);
+  input_right_ = std::vector<float>(2 * input_size_, 0);
+
+  ExportWisdom();
+}
+
+/* ********************************************************************************************** */
+
+void FFTW::ImportWisdom() {
+  if (wisdom_.empty()) return;
+
+  if (fftwf_import_wisdom_from_filename(wisdom_.c_str()) == 0) {
+    LOG("Could not import FFTW wisdom from path=", wisdom_);
+    return;
   }
+
+  LOG("Imported FFTW wisdom from path=", wisdom_);
 }
 
 /* ********************************************************************************************** */
 
-void FFTW::CreateFftwStructure(FreqAnalysis& analysis) {
-  analysis.in_raw_left.reset(fftw_alloc_real(analysis.buffer_size));
-  analysis.in_raw_right.reset(fftw_alloc_real(analysis.buffer_size));
+void FFTW::ExportWisdom() {
+  if (wisdom_.empty()) return;
 
-  analysis.in_left.reset(fftw_alloc_real(analysis.buffer_size));
-  analysis.in_right.reset(fftw_alloc_real(analysis.buffer_size));
+  std::error_code ec;
+  if (wisdom_.has_parent_path()) {
+    std::filesystem::create_directories(wisdom_.parent_path(), ec);
+  }
+
+  if (fftwf_export_wisdom_to_filename(wisdom_.c_str()) == 0) {
+    ERROR("Cannot export FFTW wisdom to path=", wisdom_);
+    return;
+  }
 
-  analysis.out_left.reset(fftw_alloc_complex(analysis.buffer_size / 2 + 1));
-  analysis.out_right.reset(fftw_alloc_complex(analysis.buffer_size / 2 + 1));
+  LOG("Exported FFTW wisdom to path=", wisdom_);
+}
 
-  fftw_plan p = fftw_plan_dft_r2c_1d(analysis.buffer_size, analysis.in_left.get(),
-                                     analysis.out_left.get(), FFTW_MEASURE);
-  analysis.plan_left.reset(p);
+/* ********************************************************************************************** */
 
-  p = fftw_plan_dft_r2c_1d(analysis.buffer_size, analysis.in_right.get(), analysis.out_right.get(),
-                           FFTW_MEASURE);
-  analysis.plan_right.reset(p);
+void FFTW::CreateHannWindow(FreqAnalysis& analysis) {
+  analysis.multiplier.reset(fftwf_alloc_real(analysis.buffer_size));
 
-  memset(analysis.in_raw_left.get(), 0, sizeof(double) * analysis.buffer_size);
-  memset(analysis.in_raw_right.get(), 0, sizeof(double) * analysis.buffer_size);
+  for (int i = 0; i < analysis.buffer_size; i++) {
+    analysis.multiplier.get()[i] =
+        static_cast<float>(0.5 * (1 - std::cos(2 * M_PI * i / (analysis.buffer_size - 1))));
+  }
+}
 
-  memset(analysis.in_left.get(), 0, sizeof(double) * analysis.buffer_size);
-  memset(analysis.in_right.get(), 0, sizeof(double) * analysis.buffer_size);
+/* ********************************************************************************************** */
 
-  memset(*analysis.out_left, 0, (analysis.buffer_size / 2 + 1) * sizeof(fftw_complex));
-  memset(*analysis.out_right, 0, (analysis.buffer_size / 2 + 1) * sizeof(fftw_complex));
+void FFTW::CreateFftwStructure(FreqAnalysis& analysis) {
+  int size = analysis.buffer_size;
+  int output_size = analysis.OutputSize();
+
+  // Memory allocated by FFTW is properly aligned for SIMD instructions (as buffer size is always a
+  // multiple of the vector length, right channel is aligned too)
+  analysis.in.reset(fftwf_alloc_real(kNumberChannels * size));
+  analysis.out.reset(fftwf_alloc_complex(kNumberChannels * output_size));
+
+  // Single plan to transform both channels at once, each one stored contiguously
+  fftwf_plan p = fftwf_plan_many_dft_r2c(1, &size, kNumberChannels, analysis.in.get(), nullptr, 1,
+                                         size, analysis.out.get(), nullptr, 1, output_size,
+                                         FFTW_MEASURE);
+  analysis.plan.reset(p);
+
+  memset(analysis.in.get(), 0, sizeof(float) * kNumberChannels * size);
+  memset(*analysis.out, 0, sizeof(fftwf_complex) * kNumberChannels * output_size);
 }
 
 /* ********************************************************************************************** */
 
 void FFTW::CreateBuffers() {
-  input_size_ = bass_.buffer_size * kNumberChannels;
-  input_ = std::vector<double>(input_size_, 0);
-
   fall_ = std::vector<int>(output_size_, 0);
   memory_ = std::vector<double>(output_size_, 0);
   peak_ = std::vector<double>(output_size_, 0);
@@ -178,7 +249,7 @@ void FFTW::CalculateFrequencies() {
     }
 
     // Nyquist frequency
-    relative_cut_off[n] = cut_off_freq_[n] / ((float)kSampleRate / 2);
+    relative_cut_off[n] = cut_off_freq_[n] / ((float)sample_rate_ / 2);
 
     // Numbers that come out of the FFT are very high, so the equalizer is used to "normalize" them
     // by dividing with also a very huge number
@@ -272,7 +343,7 @@ void FFTW::CalculateFrequencies() {
                 break;
             }
 
-            cut_off_freq_[n] = relative_cut_off[n] * ((float)kSampleRate / 2);
+            cut_off_freq_[n] = relative_cut_off[n] * ((float)sample_rate_ / 2);
           }
         }
       } else {
@@ -285,23 +356,28 @@ void FFTW::CalculateFrequencies() {
 
 /* ********************************************************************************************** */
 
-void FFTW::FillInputBuffer(double* in, int& size, int& silence) {
-  if (size > input_size_) size = input_size_;
+void FFTW::FillInputBuffer(const float* left, const float* right, int& frames, int& silence) {
+  if (frames > input_size_) {
+    // Only the most recent frames fit into input buffer
+    left += frames - input_size_;
+    right += frames - input_size_;
+    frames = input_size_;
+  }
 
-  if (size > 0) {
+  if (frames > 0) {
     frame_rate_ -= frame_rate_ / 64;
-    frame_rate_ += (double)((float)(kSampleRate * kNumberChannels * frame_skip_) / size) / 64;
+    frame_rate_ += (double)((float)(sample_rate_ * frame_skip_) / frames) / 64;
     frame_skip_ = 1;
 
-    // Shifting input buffer
-    for (uint16_t n = input_size_ - 1; n >= size; n--) {
-      input_[n] = input_[n - size];
-    }
+    // Overwrite the oldest frames, without moving any other frame from input buffer (samples are
+    // already split by channel, so it is a plain copy)
+    WriteInput(input_left_, left, frames);
+    WriteInput(input_right_, right, frames);
+
+    input_position_ = (input_position_ + frames) % input_size_;
 
-    // Fill the input buffer
-    for (uint16_t n = 0; n < size; n++) {
-      input_[size - n - 1] = in[n];
-      if (in[n]) {
+    for (int n = 0; n < frames && silence; n++) {
+      if (left[n] != 0 || right[n] != 0) {
         silence = 0;
       }
     }
@@ -312,20 +388,43 @@ void FFTW::FillInputBuffer(double* in, int& size, int& silence) {
 
 /* ********************************************************************************************** */
 
-void FFTW::ApplyFft(FreqAnalysis& analysis) {
-  for (int i = 0; i < analysis.buffer_size; i++) {
-    analysis.in_raw_right.get()[i] = input_[i * 2];
-    analysis.in_raw_left.get()[i] = input_[i * 2 + 1];
+void FFTW::WriteInput(std::vector<float>& input, const float* data, int frames) {
+  int first = std::min(frames, input_size_ - input_position_);
+  int second = frames - first;
+
+  // Each frame is written to both halves from input buffer
+  for (int offset : {0, input_size_}) {
+    std::memcpy(input.data() + offset + input_position_, data, sizeof(float) * first);
+    std::memcpy(input.data() + offset, data + first, sizeof(float) * second);
   }
+}
+
+/* ********************************************************************************************** */
+
+const float* FFTW::ReadInput(const std::vector<float>& input, int frames) const {
+  // Most recent frame is always right before the write position in the second half
+  return input.data() + input_position_ + input_size_ - frames;
+}
+
+/* ********************************************************************************************** */
+
+void FFTW::ApplyFft(FreqAnalysis& analysis) {
+  // Each audio range analyzes only the most recent frames from input buffer, windowing them while
+  // copying straight into FFTW input
+  const float* raw_left = ReadInput(input_left_, analysis.buffer_size);
+  const float* raw_right = ReadInput(input_right_, analysis.buffer_size);
+
+  float* in_left = analysis.InLeft();
+  float* in_right = analysis.InRight();
+  const float* multiplier = analysis.multiplier.get();
 
   // Hann Window
   for (int j = 0; j < analysis.buffer_size; j++) {
-    analysis.in_left.get()[j] = analysis.multiplier.get()[j] * analysis.in_raw_left.get()[j];
-    analysis.in_right.get()[j] = analysis.multiplier.get()[j] * analysis.in_raw_right.get()[j];
+    in_left[j] = multiplier[j] * raw_left[j];
+    in_right[j] = multiplier[j] * raw_right[j];
   }
 
-  fftw_execute(analysis.plan_left.get());
-  fftw_execute(analysis.plan_right.get());
+  fftwf_execute(analysis.plan.get());
 }
 
 /* ********************************************************************************************** */
@@ -338,16 +437,16 @@ void FFTW::SeparateFreqBands(double* out) {
     // Add FFT values within bands
     for (int i = lower_cut_off_per_bar_[n]; i <= upper_cut_off_per_bar_[n]; i++) {
       if (n <= bass_cut_off_) {
-        temp_l += hypot(bass_.out_left.get()[i][0], bass_.out_left.get()[i][1]);
-        temp_r += hypot(bass_.out_right.get()[i][0], bass_.out_right.get()[i][1]);
+        temp_l += hypot(bass_.OutLeft()[i][0], bass_.OutLeft()[i][1]);
+        temp_r += hypot(bass_.OutRight()[i][0], bass_.OutRight()[i][1]);
 
       } else if (n > bass_cut_off_ && n <= treble_cut_off_) {
-        temp_l += hypot(mid_.out_left.get()[i][0], mid_.out_left.get()[i][1]);
-        temp_r += hypot(mid_.out_right.get()[i][0], mid_.out_right.get()[i][1]);
+        temp_l += hypot(mid_.OutLeft()[i][0], mid_.OutLeft()[i][1]);
+        temp_r += hypot(mid_.OutRight()[i][0], mid_.OutRight()[i][1]);
 
       } else if (n > treble_cut_off_) {
-        temp_l += hypot(treble_.out_left.get()[i][0], treble_.out_left.get()[i][1]);
-        temp_r += hypot(treble_.out_right.get()[i][0], treble_.out_right.get()[i][1]);
+        temp_l += hypot(treble_.OutLeft()[i][0], treble_.OutLeft()[i][1]);
+        temp_r += hypot(treble_.OutRight()[i][0], treble_.OutRight()[i][1]);
       }
     }
 
@@ -0,0 +1,306 @@
+#include "audio/equalizer.h"
+
+#include <algorithm>
+#include <cmath>
+
+#if defined(__x86_64__)
+#include <immintrin.h>
+#elif defined(__aarch64__)
+#include <arm_neon.h>
+#endif
+
+#include "util/logger.h"
+
+namespace audio {
+
+Equalizer::Equalizer(int sample_rate)
+    : sample_rate_{sample_rate},
+      filters_{},
+      slots_{},
+      back_{0},
+      front_{1},
+      middle_{2},
+      state_(kMaxBands),
+      bands_{0},
+      data_(kMaxFrames * kChannels),
+      kernel_{SelectKernel()} {
+  // Writer and reader never allocate after this point
+  filters_.reserve(kMaxBands);
+  for (auto& slot : slots_) slot.reserve(kMaxBands);
+}
+
+/* ********************************************************************************************** */
+
+Equalizer::Kernel Equalizer::SelectKernel() {
+#if defined(__x86_64__)
+  if (__builtin_cpu_supports("avx2") && __builtin_cpu_supports("fma")) {
+    LOG("Equalizer using AVX2 implementation");
+    return &Equalizer::ProcessAvx2;
+  }
+#elif defined(__aarch64__)
+  LOG("Equalizer using NEON implementation");
+  return &Equalizer::ProcessNeon;
+#endif
+
+  LOG("Equalizer using scalar implementation");
+  return &Equalizer::ProcessScalar;
+}
+
+/* ********************************************************************************************** */
+
+Equalizer::Coefficients Equalizer::Calculate(const model::AudioFilter& filter, int sample_rate) {
+  double A = std::pow(10.0, filter.gain / 40.0);
+  double w0 = 2.0 * M_PI * filter.frequency / sample_rate;
+  double alpha = std::sin(w0) / (2.0 * filter.Q);
+  double cos_w0 = std::cos(w0);
+
+  double a0 = 1.0 + alpha / A;
+
+  return Coefficients{
+      .b0 = (1.0 + alpha * A) / a0,
+      .b1 = (-2.0 * cos_w0) / a0,
+      .b2 = (1.0 - alpha * A) / a0,
+      .a1 = (-2.0 * cos_w0) / a0,
+      .a2 = (1.0 - alpha / A) / a0,
+  };
+}
+
+/* ********************************************************************************************** */
+
+void Equalizer::SetFilters(const std::vector<model::AudioFilter>& filters) {
+  if (filters.size() > kMaxBands) {
+    ERROR("Equalizer supports up to ", kMaxBands, " bands, ignoring the remaining ones");
+  }
+
+  filters_.assign(filters.begin(), filters.begin() + std::min<size_t>(filters.size(), kMaxBands));
+  Publish();
+}
+
+/* ********************************************************************************************** */
+
+void Equalizer::SetSampleRate(int sample_rate) {
+  if (sample_rate == sample_rate_) return;
+
+  LOG("Change equalizer sample rate to value=", sample_rate);
+  sample_rate_ = sample_rate;
+  Publish();
+}
+
+/* ********************************************************************************************** */
+
+void Equalizer::Publish() {
+  auto& coefficients = slots_[back_];
+  coefficients.clear();
+
+  for (const auto& filter : filters_) {
+    coefficients.push_back(Calculate(filter, sample_rate_));
+  }
+
+  // Publish coefficients and get the previous middle slot to use on the next update
+  back_ = middle_.exchange(back_ | kDirty, std::memory_order_acq_rel) & ~kDirty;
+}
+
+/* ********************************************************************************************** */
+
+void Equalizer::Reset() { std::fill(state_.begin(), state_.end(), State{}); }
+
+/* ********************************************************************************************** */
+
+int Equalizer::Acquire() {
+  // Get latest coefficients published by writer (if any)
+  if (middle_.load(std::memory_order_relaxed) & kDirty) {
+    front_ = middle_.exchange(front_, std::memory_order_acq_rel) & ~kDirty;
+  }
+
+  int bands = static_cast<int>(slots_[front_].size());
+
+  // Number of bands has changed, so previous state is meaningless
+  if (bands != bands_) {
+    std::fill(state_.begin(), state_.begin() + bands, State{});
+    bands_ = bands;
+  }
+
+  return bands;
+}
+
+/* ********************************************************************************************** */
+
+template <typename T, typename Load, typename Store>
+void Equalizer::Run(T* buffer, int frames, Load load, Store store) {
+  int bands = Acquire();
+  if (bands == 0) return;
+
+  for (int offset = 0; offset < frames; offset += kMaxFrames) {
+    int count = std::min(frames - offset, kMaxFrames);
+    int size = count * kChannels;
+    T* block = buffer + static_cast<size_t>(offset) * kChannels;
+
+    for (int i = 0; i < size; i++) data_[i] = load(block[i]);
+
+    kernel_(slots_[front_].data(), state_.data(), bands, data_.data(), count);
+
+    for (int i = 0; i < size; i++) block[i] = store(data_[i]);
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Equalizer::Process(int16_t* buffer, int frames) {
+  constexpr double kScale = 32768.0;
+
+  // Convert back to signed 16-bit, saturating the result
+  Run(
+      buffer, frames, [](int16_t sample) { return sample / kScale; },
+      [](double value) {
+        return static_cast<int16_t>(std::lrint(std::clamp(value * kScale, -32768.0, 32767.0)));
+      });
+}
+
+/* ********************************************************************************************** */
+
+void Equalizer::Process(int32_t* buffer, int frames) {
+  constexpr double kScale = 2147483648.0;
+
+  // Convert back to signed 32-bit, saturating the result
+  Run(
+      buffer, frames, [](int32_t sample) { return sample / kScale; },
+      [](double value) {
+        return static_cast<int32_t>(
+            std::llrint(std::clamp(value * kScale, -2147483648.0, 2147483647.0)));
+      });
+}
+
+/* ********************************************************************************************** */
+
+void Equalizer::Process(float* buffer, int frames) {
+  // Float samples may exceed full scale, so they are not clamped
+  Run(
+      buffer, frames, [](float sample) { return static_cast<double>(sample); },
+      [](double value) { return static_cast<float>(value); });
+}
+
+/* ********************************************************************************************** */
+
+void Equalizer::ProcessScalar(const Coefficients* coefficients, State* state, int bands,
+                              double* data, int frames) {
+  for (int b = 0; b < bands; b++) {
+    const Coefficients& k = coefficients[b];
+
+    for (int ch = 0; ch < kChannels; ch++) {
+      double z1 = state[b].z1[ch];
+      double z2 = state[b].z2[ch];
+
+      for (int i = ch; i < frames * kChannels; i += kChannels) {
+        double in = data[i];
+        double out = k.b0 * in + z1;
+        z1 = k.b1 * in - k.a1 * out + z2;
+        z2 = k.b2 * in - k.a2 * out;
+        data[i] = out;
+      }
+
+      state[b].z1[ch] = z1;
+      state[b].z2[ch] = z2;
+    }
+  }
+}
+
+/* ********************************************************************************************** */
+
+#if defined(__x86_64__)
+__attribute__((target("avx2,fma"))) void Equalizer::ProcessAvx2(const Coefficients* coefficients,
+                                                                 State* state, int bands,
+                                                                 double* data, int frames) {
+  int b = 0;
+
+  // Each vector holds two consecutive bands for both channels: {L(b), R(b), L(b+1), R(b+1)}. As
+  // band b+1 depends on the output from band b, the upper half always runs one frame behind
+  for (; b + 1 < bands; b += 2) {
+    const Coefficients& k0 = coefficients[b];
+    const Coefficients& k1 = coefficients[b + 1];
+
+    const __m256d b0 = _mm256_setr_pd(k0.b0, k0.b0, k1.b0, k1.b0);
+    const __m256d b1 = _mm256_setr_pd(k0.b1, k0.b1, k1.b1, k1.b1);
+    const __m256d b2 = _mm256_setr_pd(k0.b2, k0.b2, k1.b2, k1.b2);
+    const __m256d a1 = _mm256_setr_pd(k0.a1, k0.a1, k1.a1, k1.a1);
+    const __m256d a2 = _mm256_setr_pd(k0.a2, k0.a2, k1.a2, k1.a2);
+
+    __m256d z1 = _mm256_set_m128d(_mm_load_pd(state[b + 1].z1), _mm_load_pd(state[b].z1));
+    __m256d z2 = _mm256_set_m128d(_mm_load_pd(state[b + 1].z2), _mm_load_pd(state[b].z2));
+
+    __m256d in, out, new_z1, new_z2;
+
+    // Prologue: only band b processes the first frame (keep state from band b+1 untouched)
+    in = _mm256_set_m128d(_mm_setzero_pd(), _mm_loadu_pd(data));
+    out = _mm256_fmadd_pd(b0, in, z1);
+    new_z1 = _mm256_fmadd_pd(b1, in, _mm256_fnmadd_pd(a1, out, z2));
+    new_z2 = _mm256_fnmadd_pd(a2, out, _mm256_mul_pd(b2, in));
+    z1 = _mm256_blend_pd(z1, new_z1, 0b0011);
+    z2 = _mm256_blend_pd(z2, new_z2, 0b0011);
+
+    __m128d previous = _mm256_castpd256_pd128(out);
+
+    // Main loop: band b processes frame i while band b+1 processes frame i-1
+    for (int i = 1; i < frames; i++) {
+      in = _mm256_set_m128d(previous, _mm_loadu_pd(data + i * kChannels));
+      out = _mm256_fmadd_pd(b0, in, z1);
+      z1 = _mm256_fmadd_pd(b1, in, _mm256_fnmadd_pd(a1, out, z2));
+      z2 = _mm256_fnmadd_pd(a2, out, _mm256_mul_pd(b2, in));
+
+      _mm_storeu_pd(data + (i - 1) * kChannels, _mm256_extractf128_pd(out, 1));
+      previous = _mm256_castpd256_pd128(out);
+    }
+
+    // Epilogue: only band b+1 processes the last frame (keep state from band b untouched)
+    in = _mm256_set_m128d(previous, _mm_setzero_pd());
+    out = _mm256_fmadd_pd(b0, in, z1);
+    new_z1 = _mm256_fmadd_pd(b1, in, _mm256_fnmadd_pd(a1, out, z2));
+    new_z2 = _mm256_fnmadd_pd(a2, out, _mm256_mul_pd(b2, in));
+    z1 = _mm256_blend_pd(z1, new_z1, 0b1100);
+    z2 = _mm256_blend_pd(z2, new_z2, 0b1100);
+
+    _mm_storeu_pd(data + (frames - 1) * kChannels, _mm256_extractf128_pd(out, 1));
+
+    _mm_store_pd(state[b].z1, _mm256_castpd256_pd128(z1));
+    _mm_store_pd(state[b].z2, _mm256_castpd256_pd128(z2));
+    _mm_store_pd(state[b + 1].z1, _mm256_extractf128_pd(z1, 1));
+    _mm_store_pd(state[b + 1].z2, _mm256_extractf128_pd(z2, 1));
+  }
+
+  // In case of an odd number of bands, process the last one without pipelining
+  if (b < bands) ProcessScalar(coefficients + b, state + b, 1, data, frames);
+}
+#endif
+
+/* ********************************************************************************************** */
+
+#if defined(__aarch64__)
+void Equalizer::ProcessNeon(const Coefficients* coefficients, State* state, int bands,
+                            double* data, int frames) {
+  // Each vector holds both channels for the same band: {L(b), R(b)}
+  for (int b = 0; b < bands; b++) {
+    const Coefficients& k = coefficients[b];
+
+    const float64x2_t b0 = vdupq_n_f64(k.b0);
+    const float64x2_t b1 = vdupq_n_f64(k.b1);
+    const float64x2_t b2 = vdupq_n_f64(k.b2);
+    const float64x2_t a1 = vdupq_n_f64(k.a1);
+    const float64x2_t a2 = vdupq_n_f64(k.a2);
+
+    float64x2_t z1 = vld1q_f64(state[b].z1);
+    float64x2_t z2 = vld1q_f64(state[b].z2);
+
+    for (int i = 0; i < frames; i++) {
+      float64x2_t in = vld1q_f64(data + i * kChannels);
+      float64x2_t out = vfmaq_f64(z1, b0, in);
+      z1 = vfmaq_f64(vfmsq_f64(z2, a1, out), b1, in);
+      z2 = vfmsq_f64(vmulq_f64(b2, in), a2, out);
+      vst1q_f64(data + i * kChannels, out);
+    }
+
+    vst1q_f64(state[b].z1, z1);
+    vst1q_f64(state[b].z2, z2);
+  }
+}
+#endif
+
+}  // namespace audio
@@ -0,0 +1,234 @@
+#include "audio/file_input.h"
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <iomanip>
+
+#include "util/logger.h"
+
+namespace audio {
+
+FileInput::FileInput(const model::InputSettings& settings)
+    : settings_{settings},
+      fd_{-1},
+      size_{-1},
+      offset_{0},
+      mapping_{nullptr},
+      buffer_{},
+      window_start_{0},
+      window_size_{0},
+      statistics_{} {}
+
+/* ********************************************************************************************** */
+
+FileInput::~FileInput() { Close(); }
+
+/* ********************************************************************************************** */
+
+bool FileInput::Open(const std::string& filepath) {
+  Close();
+
+  LOG("Open file input with settings=", settings_, " from filepath=", std::quoted(filepath));
+  statistics_ = Statistics{};
+
+  statistics_.syscalls++;
+  fd_ = open(filepath.c_str(), O_RDONLY | O_CLOEXEC);
+
+  if (fd_ < 0) {
+    ERROR("Cannot open file, error=", std::strerror(errno));
+    return false;
+  }
+
+  struct stat info {};
+  statistics_.syscalls++;
+
+  if (fstat(fd_, &info) < 0 || !S_ISREG(info.st_mode)) {
+    ERROR("Cannot get size from regular file");
+    Close();
+    return false;
+  }
+
+  size_ = info.st_size;
+  offset_ = 0;
+
+  if (settings_.access == model::InputSettings::Access::Mmap && size_ > 0) return Map();
+
+  // Whole file is going to be read from beginning to end, so kernel may use a larger read-ahead
+  statistics_.syscalls++;
+  posix_fadvise(fd_, 0, 0, POSIX_FADV_SEQUENTIAL);
+
+  buffer_.resize(std::max<uint32_t>(settings_.read_ahead, kMinReadAhead));
+  window_start_ = 0;
+  window_size_ = 0;
+
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+void FileInput::Close() {
+  if (mapping_ != nullptr) {
+    statistics_.syscalls++;
+    munmap(mapping_, static_cast<size_t>(size_));
+    mapping_ = nullptr;
+  }
+
+  if (fd_ >= 0) {
+    statistics_.syscalls++;
+    close(fd_);
+    fd_ = -1;
+  }
+
+  if (size_ >= 0) {
+    LOG("Close file input with statistics: bytes_read=", statistics_.bytes_read,
+        " syscalls=", statistics_.syscalls);
+  }
+
+  size_ = -1;
+  offset_ = 0;
+
+  // Release memory from read-ahead buffer
+  buffer_ = std::vector<uint8_t>{};
+  window_start_ = 0;
+  window_size_ = 0;
+}
+
+/* ********************************************************************************************** */
+
+int FileInput::Read(uint8_t* buffer, int size) {
+  if (!IsOpen()) return -1;
+  if (size <= 0 || offset_ >= size_) return 0;
+
+  return mapping_ != nullptr ? ReadFromMapping(buffer, size) : ReadFromStream(buffer, size);
+}
+
+/* ********************************************************************************************** */
+
+int64_t FileInput::Seek(int64_t offset, int whence) {
+  if (!IsOpen()) return -1;
+
+  int64_t target;
+
+  switch (whence) {
+    case SEEK_SET:
+      target = offset;
+      break;
+    case SEEK_CUR:
+      target = offset_ + offset;
+      break;
+    case SEEK_END:
+      target = size_ + offset;
+      break;
+    default:
+      return -1;
+  }
+
+  if (target < 0) return -1;
+
+  offset_ = target;
+  return offset_;
+}
+
+/* ********************************************************************************************** */
+
+bool FileInput::Map() {
+  statistics_.syscalls++;
+  void* address = mmap(nullptr, static_cast<size_t>(size_), PROT_READ, MAP_PRIVATE, fd_, 0);
+
+  if (address == MAP_FAILED) {
+    ERROR("Cannot map file into memory, error=", std::strerror(errno));
+    Close();
+    return false;
+  }
+
+  mapping_ = static_cast<uint8_t*>(address);
+
+  // Mapping does not depend on file descriptor anymore
+  statistics_.syscalls++;
+  close(fd_);
+  fd_ = -1;
+
+  // Let kernel read ahead aggressively and drop pages already read
+  statistics_.syscalls++;
+  madvise(mapping_, static_cast<size_t>(size_), MADV_SEQUENTIAL);
+
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+bool FileInput::Refill() {
+  window_start_ = offset_;
+  window_size_ = 0;
+
+  ssize_t result;
+
+  do {
+    statistics_.syscalls++;
+    result = pread(fd_, buffer_.data(), buffer_.size(), window_start_);
+  } while (result < 0 && errno == EINTR);
+
+  if (result < 0) {
+    ERROR("Cannot read from file, error=", std::strerror(errno));
+    return false;
+  }
+
+  window_size_ = result;
+  statistics_.bytes_read += static_cast<uint64_t>(result);
+
+  // Ask kernel to start reading the next chunk in background, while this one is consumed
+  int64_t next = window_start_ + window_size_;
+
+  if (window_size_ > 0 && next < size_) {
+    statistics_.syscalls++;
+    posix_fadvise(fd_, next, static_cast<off_t>(buffer_.size()), POSIX_FADV_WILLNEED);
+  }
+
+  return window_size_ > 0;
+}
+
+/* ********************************************************************************************** */
+
+int FileInput::ReadFromMapping(uint8_t* buffer, int size) {
+  auto count = static_cast<int>(std::min<int64_t>(size, size_ - offset_));
+
+  std::memcpy(buffer, mapping_ + offset_, static_cast<size_t>(count));
+  offset_ += count;
+
+  statistics_.bytes_read += static_cast<uint64_t>(count);
+  return count;
+}
+
+/* ********************************************************************************************** */
+
+int FileInput::ReadFromStream(uint8_t* buffer, int size) {
+  int read = 0;
+
+  while (read < size && offset_ < size_) {
+    // Current offset is not in read-ahead buffer (reached its end, or jumped somewhere else)
+    if (offset_ < window_start_ || offset_ >= window_start_ + window_size_) {
+      if (!Refill()) break;
+    }
+
+    int64_t skip = offset_ - window_start_;
+    auto count = static_cast<int>(std::min<int64_t>(size - read, window_size_ - skip));
+
+    std::memcpy(buffer + read, buffer_.data() + skip, static_cast<size_t>(count));
+    offset_ += count;
+    read += count;
+  }
+
+  // Only fails when nothing could be read at all
+  if (read == 0 && offset_ < size_) return -1;
+
+  return read;
+}
+
+}  // namespace audio
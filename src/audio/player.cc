@@ -1,5 +1,6 @@
 #include "audio/player.h"
 
+#include <algorithm>
 #include <iomanip>
 #include <stdexcept>
 
@@ -16,7 +17,8 @@
 namespace audio {
 
 std::shared_ptr<Player> Player::Create(driver::Playback* playback, driver::Decoder* decoder,
-                                       bool asynchronous) {
+                                       bool asynchronous, driver::Decoder* next_decoder,
+                                       DecoderPool* warm_up) {
   LOG("Create new instance of player");
 
 #ifndef SPECTRUM_DEBUG
@@ -27,16 +29,26 @@ std::shared_ptr<Player> Player::Create(driver::Playback* playback, driver::Decod
   // Create decoder object
   auto dec = decoder != nullptr ? std::unique_ptr<driver::Decoder>(std::move(decoder))
                                 : std::make_unique<driver::FFmpeg>();
+
+  // Create spare decoder object (used to open next song while current one is still playing)
+  auto next_dec = next_decoder != nullptr
+                      ? std::unique_ptr<driver::Decoder>(std::move(next_decoder))
+                      : std::make_unique<driver::FFmpeg>();
 #else
   // Create playback object
   auto pb = std::make_unique<driver::DummyPlayback>();
 
-  // Create decoder object
+  // Create decoder objects
   auto dec = std::make_unique<driver::DummyDecoder>();
+  auto next_dec = std::make_unique<driver::DummyDecoder>();
 #endif
 
+  // Pool is optional, files are simply opened when played without it
+  auto pool = std::unique_ptr<DecoderPool>(warm_up);
+
   // Instantiate Player
-  auto player = std::shared_ptr<Player>(new Player(std::move(pb), std::move(dec)));
+  auto player = std::shared_ptr<Player>(
+      new Player(std::move(pb), std::move(dec), std::move(next_dec), std::move(pool)));
 
   // Initialize internal components
   player->Init(asynchronous);
@@ -46,15 +58,45 @@ std::shared_ptr<Player> Player::Create(driver::Playback* playback, driver::Decod
 
 /* ********************************************************************************************** */
 
+std::shared_ptr<Player> Player::Create(const model::PlaybackSettings& settings,
+                                       const model::InputSettings& input) {
+#ifndef SPECTRUM_DEBUG
+  // Each decoder warmed up keeps its own read-ahead buffer, besides demuxer and codec contexts
+  auto warm_up = new DecoderPool([input] { return std::make_unique<driver::FFmpeg>(input); },
+                                 kWarmUpBudget, input.read_ahead + kWarmUpOverhead);
+
+  return Create(new driver::Alsa(settings), new driver::FFmpeg(input), true,
+                new driver::FFmpeg(input), warm_up);
+#else
+  return Create();
+#endif
+}
+
+/* ********************************************************************************************** */
+
 Player::Player(std::unique_ptr<driver::Playback>&& playback,
-               std::unique_ptr<driver::Decoder>&& decoder)
+               std::unique_ptr<driver::Decoder>&& decoder,
+               std::unique_ptr<driver::Decoder>&& next_decoder,
+               std::unique_ptr<DecoderPool>&& warm_up)
     : playback_{std::move(playback)},
       decoder_{std::move(decoder)},
+      next_decoder_{std::move(next_decoder)},
+      warm_up_{std::move(warm_up)},
       audio_loop_{},
+      audio_writer_{},
       media_control_{.state = State::Idle},
       curr_song_{},
+      next_song_{},
+      next_song_ready_{false},
+      next_format_{},
+      preroll_{},
+      next_preroll_{},
       notifier_{},
-      period_size_() {}
+      period_size_(),
+      capabilities_{},
+      format_{},
+      settings_{},
+      volume_{model::Volume{}} {}
 
 /* ********************************************************************************************** */
 
@@ -64,6 +106,20 @@ Player::~Player() {
   if (audio_loop_.joinable()) {
     audio_loop_.join();
   }
+
+  // Warm-up thread negotiates format using Player capabilities, so it must finish before them
+  warm_up_.reset();
+
+  // Audio loop is done, so it is safe to finish writer thread
+  {
+    std::scoped_lock<std::mutex> lock(decode_ahead_.mutex);
+    decode_ahead_.exit = true;
+  }
+  decode_ahead_.notifier.notify_one();
+
+  if (audio_writer_.joinable()) {
+    audio_writer_.join();
+  }
 }
 
 /* ********************************************************************************************** */
@@ -71,15 +127,19 @@ Player::~Player() {
 void Player::Init(bool asynchronous) {
   LOG("Initialize player with async=", asynchronous);
 
-  // Open playback stream using default device
+  // Open playback stream using device from settings
   error::Code result = playback_->CreatePlaybackStream();
 
   if (result != error::kSuccess) {
     throw std::runtime_error("Cannot initialize playback stream in player");
   }
 
-  // Configure desired parameters for playback
-  result = playback_->ConfigureParameters();
+  // Discover formats supported by playback, to negotiate the best one for each song
+  capabilities_ = playback_->GetCapabilities();
+
+  // Configure desired parameters for playback (using default format until some song is opened)
+  format_ = NegotiateFormat(model::Song{});
+  result = playback_->ConfigureParameters(format_);
 
   if (result != error::kSuccess) {
     throw std::runtime_error("Cannot set parameters in player");
@@ -87,11 +147,22 @@ void Player::Init(bool asynchronous) {
 
   // This value is used to decide buffer size for song decoding
   period_size_ = playback_->GetPeriodSize();
+  settings_ = playback_->GetSettings();
 
   if (asynchronous) {
-    // Spawn thread for Audio player
+    // Create buffer to decode audio ahead of playback
+    decode_ahead_.ring = std::make_unique<PcmRing>(
+        PcmRing::FramesFor(kDecodeAhead, format_.sample_rate), format_.GetFrameSize());
+
+    // Spawn threads for Audio player and for writing into playback stream
+    audio_writer_ = std::thread(&Player::PlaybackWriter, this);
     audio_loop_ = std::thread(&Player::AudioHandler, this);
   }
+
+  // Files opened in background are decoded using the same format that Player would choose
+  if (warm_up_) {
+    warm_up_->Start([this](const model::Song& song) { return NegotiateFormat(song); });
+  }
 }
 
 /* ********************************************************************************************** */
@@ -100,6 +171,8 @@ void Player::ResetMediaControl(error::Code result, bool error_parsing) {
   LOG("Reset media control with error code=", result);
   media_control_.Reset();
   curr_song_.reset();
+  preroll_.clear();
+  ClearNextSong();
 
   auto media_notifier = notifier_.lock();
   if (!media_notifier) return;
@@ -113,7 +186,43 @@ void Player::ResetMediaControl(error::Code result, bool error_parsing) {
 
 /* ********************************************************************************************** */
 
-bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& last_position) {
+error::Code Player::ReadSong() {
+  std::vector<uint8_t> buffer;
+  int64_t last_position = -1;  // in milliseconds
+  bool keep_playing = true;
+
+  while (keep_playing) {
+    // Play samples decoded in background before reading anything else from decoder
+    if (!preroll_.empty()) {
+      auto chunk = std::move(preroll_.front());
+      preroll_.pop_front();
+
+      keep_playing =
+          HandleCommand(chunk.samples.data(), chunk.frames, chunk.position, last_position);
+      continue;
+    }
+
+    // Read a whole period at once, so it can be written into playback with a single call
+    int frames = period_size_ > 0 ? period_size_ : kWriterPeriod;
+
+    size_t size = static_cast<size_t>(frames) * format_.GetFrameSize();
+    if (buffer.size() < size) buffer.resize(size);
+
+    int64_t position = 0;
+    error::Code result = decoder_->Read(buffer.data(), frames, position);
+
+    // Reached the end of song (or some error occurred while decoding it)
+    if (result != error::kSuccess || frames == 0) return result;
+
+    keep_playing = HandleCommand(buffer.data(), frames, position, last_position);
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+bool Player::HandleCommand(void* buffer, int size, int64_t position, int64_t& last_position) {
   auto command = media_control_.Pop();
   auto media_notifier = notifier_.lock();
 
@@ -125,10 +234,11 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
     case Command::Identifier::Play: {
       LOG("Audio handler received command requesting to play a new song");
       // Add play request back to queue
-      media_control_.Push(command);
+      media_control_.Push(std::move(command));
 
       // Stop current song
       media_control_.state = State::Stop;
+      HoldPlayback(/* drop= */ true);
       playback_->Stop();
       return false;
     } break;
@@ -136,6 +246,9 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
     case Command::Identifier::PauseOrResume: {
       LOG("Audio handler received command to pause song");
       media_control_.state = TranslateCommand(command);
+
+      // Keep samples already decoded, they will be played right after resuming
+      HoldPlayback(/* drop= */ false);
       playback_->Pause();
 
       // As this thread can stay blocked for a long time, waiting for a command,
@@ -143,7 +256,8 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
       if (media_notifier) {
         media_notifier->NotifySongState(model::Song::CurrentInformation{
             .state = model::Song::MediaState::Pause,
-            .position = (uint32_t)last_position,
+            .position = (uint32_t)ToSeconds(position),
+            .position_ms = (uint32_t)position,
         });
       }
 
@@ -151,6 +265,9 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
       bool keep_executing =
           media_control_.WaitFor(Command::Play(), Command::PauseOrResume(), Command::Stop());
 
+      // Volume or audio filters may have been updated while paused
+      ApplyDeferredSettings();
+
       // TODO: NotifySongState for stop
 
       auto command_after_wait = media_control_.Pop();
@@ -163,21 +280,32 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
           media_control_.Push(command_after_wait);
         }
 
+        // Next song was meant to follow the one being stopped
+        media_control_.TakeNextSong();
+
         // Stop current song
         media_control_.state = TranslateCommand(command_after_wait);
+        HoldPlayback(/* drop= */ true);
         playback_->Stop();
         return false;
       }
 
       LOG("Audio handler received command to resume song");
       media_control_.state = State::Play;
-      playback_->Prepare();
+
+      // Next song may have been set while paused
+      if (auto next_song = media_control_.TakeNextSong()) SetNextSongInternal(*next_song);
+
+      // Continue from the exact sample where it was paused (nothing was dropped or re-decoded)
+      playback_->Resume();
+      ResumePlayback();
     } break;
 
     case Command::Identifier::Stop:
     case Command::Identifier::Exit: {
       LOG("Audio handler received command to", command);
       media_control_.state = TranslateCommand(command);
+      HoldPlayback(/* drop= */ true);
       playback_->Stop();
       return false;
     } break;
@@ -186,55 +314,77 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
       int offset = command.GetContent<int>();
       LOG("Audio handler received command to seek forward with value=", offset);
 
-      if ((new_position + offset) < curr_song_->duration) {
-        new_position += offset;
-        return true;
-      }
+      auto target = std::chrono::milliseconds{position} + std::chrono::seconds{offset};
+      if (SeekPosition(target, last_position)) return true;
     } break;
 
     case Command::Identifier::SeekBackward: {
       int offset = command.GetContent<int>();
       LOG("Audio handler received command to seek backward with value=", offset);
 
-      if (new_position > 0 && (new_position - offset) >= 0) {
-        new_position -= offset;
-        return true;
-      }
+      auto target = std::chrono::milliseconds{position} - std::chrono::seconds{offset};
+      if (SeekPosition(target, last_position)) return true;
+    } break;
+
+    case Command::Identifier::SeekTo: {
+      auto target = command.GetContent<std::chrono::milliseconds>();
+      LOG("Audio handler received command to seek to position=", target.count(), "ms");
+
+      if (SeekPosition(target, last_position)) return true;
     } break;
 
     case Command::Identifier::SetVolume: {
       model::Volume value = command.GetContent<model::Volume>();
       LOG("Audio handler received command to set volume with value=", value);
       decoder_->SetVolume(value);
+      next_decoder_->SetVolume(value);
     } break;
 
     case Command::Identifier::UpdateAudioFilters: {
-      std::vector<model::AudioFilter> value = command.GetContent<std::vector<model::AudioFilter>>();
+      auto value = command.TakeContent<std::vector<model::AudioFilter>>();
       LOG("Audio handler received command to update audio filters");
-      // TODO: handle error...
-      decoder_->UpdateFilters(value);
+      UpdateDecoderFilters(value);
+    } break;
+
+    case Command::Identifier::SetNextSong: {
+      auto filepath = command.GetContent<std::string>();
+      LOG("Audio handler received command to set next song with filepath=", std::quoted(filepath));
+      SetNextSongInternal(filepath);
     } break;
 
     default:
       break;
   }
 
-  // Send raw information to media controller to run audio analysis
-  if (media_notifier) {
-    media_notifier->SendAudioRaw((uint8_t*)buffer, size);
+  // Send raw information to media controller to run audio analysis (when decoding ahead, writer
+  // thread does it only after samples are actually heard)
+  if (media_notifier && !decode_ahead_.ring) {
+    media_notifier->SendAudioRaw(model::PcmBlock{
+        .data = buffer,
+        .format = format_,
+        .frames = size,
+        .timestamp = model::PcmBlock::Clock::now(),
+    });
   }
 
   // Write samples to playback
-  playback_->AudioCallback(buffer, size);
+  WritePlayback(buffer, size);
+
+  // Getting close to the end of current song, so open next one to avoid any gap between them
+  if (next_song_ && !next_song_ready_ &&
+      ToSeconds(position) + kPreloadNextSong >= curr_song_->duration) {
+    PreloadNextSong(/* wait= */ false);
+  }
 
-  // Notify song state to graphical interface
-  if (last_position != new_position) {
-    last_position = new_position;
+  // Notify song state to graphical interface (every second, or right after seeking)
+  if (last_position < 0 || ToSeconds(last_position) != ToSeconds(position)) {
+    last_position = position;
 
     if (media_notifier) {
       media_notifier->NotifySongState(model::Song::CurrentInformation{
           .state = model::Song::MediaState::Play,
-          .position = (uint32_t)last_position,
+          .position = (uint32_t)ToSeconds(last_position),
+          .position_ms = (uint32_t)last_position,
       });
     }
   }
@@ -244,6 +394,55 @@ bool Player::HandleCommand(void* buffer, int size, int64_t& new_position, int& l
 
 /* ********************************************************************************************** */
 
+bool Player::SeekPosition(std::chrono::milliseconds target, int64_t& last_position) {
+  std::chrono::milliseconds duration = std::chrono::seconds{curr_song_->duration};
+
+  if (target.count() < 0 || target >= duration) return false;
+
+  // Decoder is responsible to seek this exact position, and in case of error, it is returned by
+  // the next read (so song finishes with error)
+  if (decoder_->Seek(target.count()) != error::kSuccess) {
+    ERROR("Cannot seek position=", target.count(), "ms in song");
+  }
+
+  // Samples decoded in background are not useful anymore
+  preroll_.clear();
+
+  // Force UI to receive the new position, even if it is still within the same second
+  last_position = -1;
+
+  // Discard samples decoded ahead from old position
+  HoldPlayback(/* drop= */ true);
+  ResumePlayback();
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+void Player::UpdateDecoderFilters(const std::vector<model::AudioFilter>& filters) {
+  error::Code result = decoder_->UpdateFilters(filters);
+  next_decoder_->UpdateFilters(filters);
+
+  // Notify error
+  if (result != error::kSuccess) {
+    auto media_notifier = notifier_.lock();
+    if (media_notifier) media_notifier->NotifyError(result);
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Player::ApplyDeferredSettings() {
+  if (auto volume = media_control_.TakeVolume()) {
+    decoder_->SetVolume(*volume);
+    next_decoder_->SetVolume(*volume);
+  }
+
+  if (auto filters = media_control_.TakeFilters()) UpdateDecoderFilters(*filters);
+}
+
+/* ********************************************************************************************** */
+
 void Player::AudioHandler() {
   LOG("Start audio handler thread");
 
@@ -251,17 +450,22 @@ void Player::AudioHandler() {
   while (media_control_.WaitFor(Command::Play())) {
     LOG("Audio handler received new song to play");
 
+    // Volume or audio filters may have been updated while idle
+    ApplyDeferredSettings();
+
     // Get command from queue and update internal media state
     auto command_play = media_control_.Pop();
     media_control_.state = TranslateCommand(command_play);
 
     // Get filepath from command and initialize current song
     curr_song_ = std::make_unique<model::Song>(model::Song{
-        .filepath = command_play.GetContent<std::string>(),
+        .filepath = command_play.TakeContent<std::string>(),
     });
 
-    // First, try to parse file (it may be or not a support file extension to decode)
-    error::Code result = decoder_->OpenFile(*curr_song_);
+    // First, try to parse file (it may be or not a support file extension to decode), unless it
+    // was already opened in background
+    auto warmed_up = TakeWarmedUp();
+    error::Code result = warmed_up ? error::kSuccess : decoder_->OpenFile(*curr_song_);
 
     // In case of error, reset media controls and notify terminal UI with error
     if (result != error::kSuccess) {
@@ -269,21 +473,51 @@ void Player::AudioHandler() {
       continue;  // we don't wanna keep in this loop anymore, so wait for next song!
     }
 
+    // Decode song using the audio format closest to its own properties (avoid resampling)
+    result = ConfigureOutput(NegotiateFormat(*curr_song_));
+
+    if (result != error::kSuccess) {
+      ResetMediaControl(result);
+      continue;
+    }
+
+    // In case that playback stream did not accept the same format chosen in background, samples
+    // decoded by then cannot be used, so decode them again using the current format
+    if (warmed_up && *warmed_up != format_) {
+      LOG("Discard samples decoded in background, as audio format has changed");
+      preroll_.clear();
+      decoder_->SetOutputFormat(format_);
+      decoder_->Seek(0);
+    }
+
     {
       // Otherwise, it is a supported audio extension, send detailed audio information to UI
       auto media_notifier = notifier_.lock();
       if (media_notifier) media_notifier->NotifySongInformation(*curr_song_);
     }
 
+    // Next song may have been set while waiting for this one
+    if (auto next_song = media_control_.TakeNextSong()) SetNextSongInternal(*next_song);
+
     // Inform playback driver to be ready to play
+    analysis_delay_.Reset();
     playback_->Prepare();
+    ResumePlayback();
+
+    // Keep decoding while there is a next song ready to continue from where current one ended
+    do {
+      result = ReadSong();
+    } while (result == error::kSuccess && media_control_.state == State::Play &&
+             SwitchToNextSong());
+
+    // Let playback consume what was already decoded before resetting, in case song ended naturally
+    // (otherwise, playback was already stopped without waiting for remaining samples)
+    if (result == error::kSuccess && media_control_.state == State::Play) {
+      FlushPlayback();
+      playback_->Drain();
+    }
 
-    int position = -1;  // in seconds
-
-    // To keep decoding audio, return true in lambda function
-    result = decoder_->Decode(period_size_ / 2, [&](void* buffer, int size, int64_t& new_position) {
-      return HandleCommand(buffer, size, new_position, position);
-    });
+    HoldPlayback(/* drop= */ true);
 
     // Reached the end of song, originated from one of these situations:
     // 1. naturally; 2. forced to stop/exit by user; 3. error from decoding;
@@ -295,9 +529,415 @@ void Player::AudioHandler() {
 
 /* ********************************************************************************************** */
 
+void Player::SetNextSongInternal(const std::string& filepath) {
+  ClearNextSong();
+  if (filepath.empty()) return;
+
+  next_song_ = std::make_unique<model::Song>(model::Song{.filepath = filepath});
+
+  // Start opening it right away, so it is probably ready by the time current song ends
+  if (warm_up_) warm_up_->WarmUpNext(filepath);
+}
+
+/* ********************************************************************************************** */
+
+void Player::PreloadNextSong(bool wait) {
+  if (!next_song_ || next_song_ready_) return;
+
+  if (warm_up_) {
+    auto entry = warm_up_->Take(next_song_->filepath, wait);
+
+    if (entry) {
+      LOG("Use decoder warmed up in background for next song, with preroll=",
+          entry->preroll.size(), " chunks");
+
+      // Previous spare decoder is released along with entry
+      std::swap(next_decoder_, entry->decoder);
+      *next_song_ = std::move(entry->song);
+      next_preroll_ = std::move(entry->preroll);
+      next_format_ = entry->format;
+      next_song_ready_ = true;
+      return;
+    }
+
+    // Warm-up thread is not done yet, check again later
+    if (!wait) return;
+  }
+
+  // Without warm-up thread (or in case it could not open the file), file is opened right here.
+  // Playback does not starve meanwhile, as it keeps consuming samples already decoded ahead
+  LOG("Open next song using spare decoder");
+  error::Code result = next_decoder_->OpenFile(*next_song_);
+
+  if (result != error::kSuccess) {
+    ERROR("Cannot open next song, error=", result);
+    next_song_.reset();
+    return;
+  }
+
+  next_song_ready_ = true;
+}
+
+/* ********************************************************************************************** */
+
+bool Player::SwitchToNextSong() {
+  // In case it was set too late, try to open it right now
+  PreloadNextSong(/* wait= */ true);
+
+  if (!next_song_ready_) return false;
+
+  LOG("Switch to next song without stopping playback stream");
+  std::swap(decoder_, next_decoder_);
+  curr_song_ = std::move(next_song_);
+  preroll_ = std::move(next_preroll_);
+  next_preroll_.clear();
+  auto warmed_up = std::exchange(next_format_, std::nullopt);
+  next_song_ready_ = false;
+
+  // Release resources from previous song
+  next_decoder_->ClearCache();
+
+  // In case that next song is better played using another format, playback stream must be
+  // reconfigured (only in this case, it is not possible to avoid a gap between songs)
+  auto format = NegotiateFormat(*curr_song_);
+
+  if (format != format_) {
+    // Finish playing previous song before reconfiguring stream
+    FlushPlayback();
+    HoldPlayback(/* drop= */ true);
+    playback_->Drain();
+    ConfigureOutput(format);
+
+    analysis_delay_.Reset();
+    playback_->Prepare();
+    ResumePlayback();
+  }
+
+  // Same as when playing a song warmed up, samples decoded with another format cannot be used
+  if (warmed_up && *warmed_up != format_) {
+    LOG("Discard samples decoded in background, as audio format has changed");
+    preroll_.clear();
+    decoder_->SetOutputFormat(format_);
+    decoder_->Seek(0);
+  }
+
+  auto media_notifier = notifier_.lock();
+  if (media_notifier) media_notifier->NotifySongInformation(*curr_song_);
+
+  return true;
+}
+
+/* ********************************************************************************************** */
+
+void Player::ClearNextSong() {
+  if (next_song_ready_) next_decoder_->ClearCache();
+
+  next_song_.reset();
+  next_song_ready_ = false;
+  next_format_.reset();
+  next_preroll_.clear();
+
+  // Decoder warmed up for it (if any) is kept in pool, but no longer reserved
+  if (warm_up_) warm_up_->WarmUpNext("");
+}
+
+/* ********************************************************************************************** */
+
+std::optional<model::AudioFormat> Player::TakeWarmedUp() {
+  if (!warm_up_) return std::nullopt;
+
+  auto entry = warm_up_->Take(curr_song_->filepath);
+  if (!entry) return std::nullopt;
+
+  LOG("Use decoder warmed up in background, with preroll=", entry->preroll.size(), " chunks");
+
+  // Previous decoder is released along with entry
+  std::swap(decoder_, entry->decoder);
+  *curr_song_ = std::move(entry->song);
+  preroll_ = std::move(entry->preroll);
+
+  return entry->format;
+}
+
+/* ********************************************************************************************** */
+
+model::AudioFormat Player::NegotiateFormat(const model::Song& song) const {
+  using SampleFormat = model::AudioFormat::SampleFormat;
+
+  auto supports = [](const auto& values, const auto& value) {
+    return std::find(values.begin(), values.end(), value) != values.end();
+  };
+
+  // Start from default format (signed 16-bit, 44100Hz and stereo)
+  model::AudioFormat format;
+
+  // Keep song sample rate, to avoid resampling it
+  if (supports(capabilities_.sample_rates, song.sample_rate)) {
+    format.sample_rate = song.sample_rate;
+  } else if (!capabilities_.sample_rates.empty() &&
+             !supports(capabilities_.sample_rates, format.sample_rate)) {
+    // As playback does not resample, default rate is only an option if device supports it
+    format.sample_rate = capabilities_.sample_rates.front();
+  }
+
+  // Keep song bit depth, to avoid truncating samples
+  if (song.bit_depth > 16) {
+    if (supports(capabilities_.sample_formats, SampleFormat::S32)) {
+      format.sample_format = SampleFormat::S32;
+    } else if (supports(capabilities_.sample_formats, SampleFormat::Float)) {
+      format.sample_format = SampleFormat::Float;
+    }
+  }
+
+  return format;
+}
+
+/* ********************************************************************************************** */
+
+error::Code Player::ConfigureOutput(const model::AudioFormat& format) {
+  if (format == format_) return error::kSuccess;
+
+  LOG("Change audio format from ", format_, " to ", format);
+
+  // Hardware parameters cannot be changed while stream is running
+  playback_->Stop();
+
+  if (playback_->ConfigureParameters(format) != error::kSuccess) {
+    ERROR("Cannot configure playback stream with new format, keep using current one");
+    playback_->ConfigureParameters(format_);
+    return error::kSuccess;
+  }
+
+  {
+    // Writer is on hold at this point, so it is safe to replace decode-ahead buffer
+    std::scoped_lock<std::mutex> lock(decode_ahead_.mutex);
+    format_ = format;
+    period_size_ = playback_->GetPeriodSize();
+    settings_ = playback_->GetSettings();
+
+    if (decode_ahead_.ring) {
+      decode_ahead_.ring = std::make_unique<PcmRing>(
+          PcmRing::FramesFor(kDecodeAhead, format_.sample_rate), format_.GetFrameSize());
+    }
+  }
+
+  // Inform audio analysis about new format and UI about new values negotiated with device
+  auto media_notifier = notifier_.lock();
+  if (media_notifier) {
+    media_notifier->NotifyAudioFormat(format_);
+    media_notifier->NotifyPlaybackSettings(settings_);
+  }
+
+  // Spare decoder must also use it, otherwise next song would be decoded with previous format
+  next_decoder_->SetOutputFormat(format_);
+  return decoder_->SetOutputFormat(format_);
+}
+
+/* ********************************************************************************************** */
+
+void Player::PlaybackWriter() {
+  LOG("Start playback writer thread");
+
+  std::vector<uint8_t> buffer;
+  PcmRing* ring = nullptr;
+  model::AudioFormat format;
+  int frames = 0;
+
+  while (true) {
+    int period = 0;
+
+    {
+      std::unique_lock<std::mutex> lock(decode_ahead_.mutex);
+      if (frames > 0) decode_ahead_.primed = true;
+
+      // Unblock Audio thread in case it is waiting for space in buffer or for writer to be idle
+      decode_ahead_.writing = false;
+      decode_ahead_.space.notify_one();
+
+      // Playback consumed everything and decoder didn't manage to keep up with it
+      if (decode_ahead_.running && decode_ahead_.primed && !decode_ahead_.flushing &&
+          decode_ahead_.ring->Empty()) {
+        decode_ahead_.primed = false;
+        uint64_t count = ++decode_ahead_.underruns;
+        ERROR("Decode-ahead buffer underrun, total count=", count);
+      }
+
+      decode_ahead_.notifier.wait(lock, [&] {
+        return decode_ahead_.exit || (decode_ahead_.running && !decode_ahead_.ring->Empty());
+      });
+
+      if (decode_ahead_.exit) break;
+
+      decode_ahead_.writing = true;
+
+      // Buffer may have been replaced (audio format changed) while writer was on hold
+      ring = decode_ahead_.ring.get();
+      format = format_;
+      period = period_size_ > 0 ? period_size_ : kWriterPeriod;
+    }
+
+    // Write samples outside the lock, as this will block until playback has space for them
+    int available = std::min(period, ring->Size());
+    void* area = playback_->BeginDirectWrite(available);
+
+    if (area != nullptr) {
+      // Copy samples straight from decode-ahead buffer into playback buffer
+      frames = ring->Read(area, available);
+      playback_->CommitDirectWrite(frames);
+      ReleaseAnalysis(area, frames, format);
+      continue;
+    }
+
+    size_t size = static_cast<size_t>(period) * ring->FrameSize();
+    if (buffer.size() < size) buffer.resize(size);
+
+    frames = ring->Read(buffer.data(), period);
+    playback_->AudioCallback(buffer.data(), frames);
+    ReleaseAnalysis(buffer.data(), frames, format);
+  }
+
+  LOG("Finish playback writer thread");
+}
+
+/* ********************************************************************************************** */
+
+void Player::ReleaseAnalysis(const void* data, int frames, const model::AudioFormat& format) {
+  if (frames <= 0) return;
+
+  auto& delay = analysis_delay_;
+  AnalysisDelay::Chunk chunk;
+
+  // Reuse memory from some chunk already released
+  if (!delay.spare.empty()) {
+    chunk = std::move(delay.spare.back());
+    delay.spare.pop_back();
+  }
+
+  auto bytes = static_cast<const uint8_t*>(data);
+  chunk.start = delay.written;
+  chunk.frames = frames;
+  chunk.format = format;
+  chunk.samples.assign(bytes, bytes + static_cast<size_t>(frames) * format.GetFrameSize());
+
+  delay.pending.push_back(std::move(chunk));
+  delay.written += frames;
+
+  // Frames still queued in playback stream were not heard yet (this is measured on every write,
+  // so it keeps correct even after pausing, seeking or changing latency)
+  auto queued = static_cast<uint64_t>(std::max(playback_->GetDelay(), 0));
+  uint64_t heard = delay.written > queued ? delay.written - queued : 0;
+
+  auto media_notifier = notifier_.lock();
+  auto now = model::PcmBlock::Clock::now();
+
+  // Release every chunk that has started to be heard
+  while (!delay.pending.empty() && delay.pending.front().start < heard) {
+    auto& front = delay.pending.front();
+
+    if (media_notifier) {
+      media_notifier->SendAudioRaw(model::PcmBlock{
+          .data = front.samples.data(),
+          .format = front.format,
+          .frames = front.frames,
+          .timestamp = now,
+      });
+    }
+
+    delay.spare.push_back(std::move(front));
+    delay.pending.pop_front();
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Player::WritePlayback(void* buffer, int size) {
+  // Running synchronously, so write samples directly into playback
+  if (!decode_ahead_.ring) {
+    playback_->AudioCallback(buffer, size);
+    return;
+  }
+
+  auto& ring = *decode_ahead_.ring;
+  auto data = static_cast<uint8_t*>(buffer);
+
+  while (size > 0) {
+    int written = ring.Write(data, size);
+    data += written * ring.FrameSize();
+    size -= written;
+
+    decode_ahead_.Notify();
+
+    if (size > 0) {
+      // Buffer is full, so wait for writer to consume some samples
+      std::unique_lock<std::mutex> lock(decode_ahead_.mutex);
+      decode_ahead_.space.wait(lock, [&] { return !ring.Full() || !decode_ahead_.running; });
+
+      // Writer is on hold, nothing else will be consumed
+      if (!decode_ahead_.running) break;
+    }
+  }
+}
+
+/* ********************************************************************************************** */
+
+void Player::ResumePlayback() {
+  if (!decode_ahead_.ring) return;
+
+  {
+    std::scoped_lock<std::mutex> lock(decode_ahead_.mutex);
+    decode_ahead_.running = true;
+    decode_ahead_.primed = false;
+    decode_ahead_.flushing = false;
+  }
+  decode_ahead_.notifier.notify_one();
+}
+
+/* ********************************************************************************************** */
+
+void Player::HoldPlayback(bool drop) {
+  if (!decode_ahead_.ring) return;
+
+  std::unique_lock<std::mutex> lock(decode_ahead_.mutex);
+  decode_ahead_.running = false;
+
+  // Wait for writer to finish its current write
+  decode_ahead_.space.wait(lock, [&] { return !decode_ahead_.writing; });
+
+  // As writer is idle and this is the producer thread, it is safe to clear buffer
+  if (drop) decode_ahead_.ring->Clear();
+}
+
+/* ********************************************************************************************** */
+
+void Player::FlushPlayback() {
+  if (!decode_ahead_.ring) return;
+
+  LOG("Wait for playback writer to consume remaining samples");
+  std::unique_lock<std::mutex> lock(decode_ahead_.mutex);
+
+  // Decoder has finished, so an empty buffer from now on is expected
+  decode_ahead_.flushing = true;
+  decode_ahead_.notifier.notify_one();
+
+  decode_ahead_.space.wait(lock, [&] {
+    return !decode_ahead_.running || (decode_ahead_.ring->Empty() && !decode_ahead_.writing);
+  });
+}
+
+/* ********************************************************************************************** */
+
 void Player::RegisterInterfaceNotifier(const std::shared_ptr<interface::Notifier>& notifier) {
   LOG("Register new interface notifier");
   notifier_ = notifier;
+
+  model::PlaybackSettings settings;
+  {
+    std::scoped_lock<std::mutex> lock(decode_ahead_.mutex);
+    settings = settings_;
+  }
+
+  // Show values negotiated with playback device during initialization
+  if (notifier) notifier->NotifyPlaybackSettings(settings);
 }
 
 /* ********************************************************************************************** */
@@ -327,24 +967,16 @@ void Player::Stop() {
 void Player::SetAudioVolume(const model::Volume& value) {
   LOG("Set audio volume with value=", value);
 
-  // Set volume direcly or add new command to audio queue, based on current media state
+  // Always add new command to audio queue (even when idle), as Audio thread may replace decoders
+  // at any moment (e.g. when playing a song warmed up in background)
   switch (media_control_.state) {
-    // If state is idle, there is no music playing
-    case State::Idle: {
-      error::Code result = decoder_->SetVolume(value);
-
-      // Notify error
-      if (result != error::kSuccess) {
-        auto media_notifier = notifier_.lock();
-        if (media_notifier) media_notifier->NotifyError(result);
-      }
-    } break;
-
-    // Otherwise, add command to queue
+    case State::Idle:
     case State::Play:
     case State::Pause:
     case State::Stop:
+      volume_.store(value);
       media_control_.Push(Command::SetVolume(value));
+      if (warm_up_) warm_up_->SetVolume(value);
       break;
 
     case State::Exit:
@@ -357,7 +989,7 @@ void Player::SetAudioVolume(const model::Volume& value) {
 
 model::Volume Player::GetAudioVolume() const {
   LOG("Get audio volume");
-  return decoder_->GetVolume();
+  return volume_.load();
 }
 
 /* ********************************************************************************************** */
@@ -376,27 +1008,25 @@ void Player::SeekBackwardPosition(int value) {
 
 /* ********************************************************************************************** */
 
+void Player::SeekTo(std::chrono::milliseconds position) {
+  LOG("Add command to queue: SeekTo (with value=", position.count(), "ms)");
+  media_control_.Push(Command::SeekTo(position));
+}
+
+/* ********************************************************************************************** */
+
 void Player::ApplyAudioFilters(const std::vector<model::AudioFilter>& filters) {
   LOG("Apply updated audio filters");
 
-  // Set audio filters direcly or add new command to audio queue, based on current media state
+  // Always add new command to audio queue (even when idle), so decoders are only updated by Audio
+  // thread and never while equalizing samples
   switch (media_control_.state) {
-    // If state is idle, there is no music playing
-    case State::Idle: {
-      error::Code result = decoder_->UpdateFilters(filters);
-
-      // Notify error
-      if (result != error::kSuccess) {
-        auto media_notifier = notifier_.lock();
-        if (media_notifier) media_notifier->NotifyError(result);
-      }
-    } break;
-
-    // Otherwise, add command to queue
+    case State::Idle:
     case State::Play:
     case State::Pause:
     case State::Stop:
       media_control_.Push(Command::UpdateAudioFilters(filters));
+      if (warm_up_) warm_up_->UpdateFilters(filters);
       break;
 
     case State::Exit:
@@ -407,6 +1037,36 @@ void Player::ApplyAudioFilters(const std::vector<model::AudioFilter>& filters) {
 
 /* ********************************************************************************************** */
 
+void Player::SetNextSong(const std::string& filepath) {
+  LOG("Add command to queue: SetNextSong (with filepath=", std::quoted(filepath), ")");
+  media_control_.Push(Command::SetNextSong(filepath));
+}
+
+/* ********************************************************************************************** */
+
+void Player::WarmUp(const std::vector<std::string>& filepaths) {
+  if (!warm_up_) return;
+
+  LOG("Warm up decoders for ", filepaths.size(), " files in background");
+  warm_up_->WarmUp(filepaths);
+}
+
+/* ********************************************************************************************** */
+
+Player::BufferStatus Player::GetBufferStatus() const {
+  // Buffer is replaced by Audio thread whenever audio format changes
+  std::scoped_lock<std::mutex> lock(decode_ahead_.mutex);
+  if (!decode_ahead_.ring) return BufferStatus{};
+
+  return BufferStatus{
+      .capacity = decode_ahead_.ring->Capacity(),
+      .filled = decode_ahead_.ring->Size(),
+      .underruns = decode_ahead_.underruns,
+  };
+}
+
+/* ********************************************************************************************** */
+
 void Player::Exit() {
   LOG("Add command to queue: Exit");
   media_control_.Push(Command::Exit());
@@ -2,17 +2,28 @@
  * \file
  * \brief Main function
  */
-#include <cstdlib>  // for EXIT_SUCCESS
+#include <cctype>    // for isdigit
+#include <cstdlib>     // for EXIT_SUCCESS, getenv
+#include <filesystem>  // for path
+#include <iostream>    // for cout
 
 #include "audio/player.h"                          // for Player
 #include "ftxui/component/screen_interactive.hpp"  // for ScreenInteractive
 #include "middleware/media_controller.h"           // for MediaController
+#include "middleware/media_library.h"              // for MediaLibrary
+#include "model/input_settings.h"                  // for InputSettings
+#include "model/playback_settings.h"               // for PlaybackSettings
 #include "util/arg_parser.h"                       // for ArgumentParser
 #include "util/logger.h"                           // For Logger
 #include "view/base/terminal.h"                    // for Terminal
 
+#ifndef SPECTRUM_DEBUG
+#include "audio/driver/fftw.h"  // for FFTW
+#endif
+
 //! Command-line argument parsing
-bool parse(int argc, char** argv) {
+bool parse(int argc, char** argv, model::PlaybackSettings& settings, model::InputSettings& input,
+           std::filesystem::path& library, int& analysis_rate) {
   // Create arguments expectation
   using util::Argument, util::Arguments, util::Expected, util::Parser;
   auto expected_args = Expected{
@@ -21,6 +32,51 @@ bool parse(int argc, char** argv) {
           .choices = {"-l", "--log"},
           .description = "Enable logging to specified path",
       },
+      Argument{
+          .name = "device",
+          .choices = {"-d", "--device"},
+          .description = "Use specified ALSA device for playback (e.g. hw:0,0)",
+      },
+      Argument{
+          .name = "latency",
+          .choices = {"-L", "--latency"},
+          .description = "Set playback latency profile (low, balanced or power-saving)",
+      },
+      Argument{
+          .name = "access",
+          .choices = {"-a", "--access"},
+          .description = "Set playback access mode (rw or mmap)",
+      },
+      Argument{
+          .name = "input",
+          .choices = {"-i", "--input"},
+          .description = "Set access mode for reading local files (stream or mmap)",
+      },
+      Argument{
+          .name = "read-ahead",
+          .choices = {"-r", "--read-ahead"},
+          .description = "Set read-ahead buffer size in KiB for streaming local files",
+      },
+      Argument{
+          .name = "threads",
+          .choices = {"-t", "--threads"},
+          .description = "Set maximum number of threads for decoding (default is auto)",
+      },
+      Argument{
+          .name = "equalizer",
+          .choices = {"-e", "--equalizer"},
+          .description = "Set equalizer implementation (filter or native)",
+      },
+      Argument{
+          .name = "library",
+          .choices = {"-m", "--library"},
+          .description = "Index metadata from all songs found under specified directory",
+      },
+      Argument{
+          .name = "fps",
+          .choices = {"-f", "--fps"},
+          .description = "Set refresh rate in Hz for audio visualizer (default is 60)",
+      },
   };
 
   try {
@@ -34,6 +90,112 @@ bool parse(int argc, char** argv) {
       util::Logger::GetInstance().Configure(parsed_args["log"]);
     }
 
+    // Check if contains device name for playback
+    if (parsed_args.find("device") != parsed_args.end()) {
+      settings.device = parsed_args["device"];
+    }
+
+    // Check if contains latency profile for playback
+    if (parsed_args.find("latency") != parsed_args.end()) {
+      auto latency = model::to_latency(parsed_args["latency"]);
+
+      if (!latency) {
+        std::cout << "spectrum: invalid value for option [--latency " << parsed_args["latency"]
+                  << "]\n";
+        return false;
+      }
+
+      settings.latency = *latency;
+    }
+
+    // Check if contains access mode for playback
+    if (parsed_args.find("access") != parsed_args.end()) {
+      const std::string& access = parsed_args["access"];
+
+      if (access != "rw" && access != "mmap") {
+        std::cout << "spectrum: invalid value for option [--access " << access << "]\n";
+        return false;
+      }
+
+      settings.mmap = access == "mmap";
+    }
+
+    // Check if contains access mode for reading files
+    if (parsed_args.find("input") != parsed_args.end()) {
+      auto access = model::to_access(parsed_args["input"]);
+
+      if (!access) {
+        std::cout << "spectrum: invalid value for option [--input " << parsed_args["input"]
+                  << "]\n";
+        return false;
+      }
+
+      input.access = *access;
+    }
+
+    // Check if contains read-ahead size for reading files
+    if (parsed_args.find("read-ahead") != parsed_args.end()) {
+      const std::string& size = parsed_args["read-ahead"];
+      int kibibytes = size.empty() || !std::isdigit(size.front()) ? 0 : std::stoi(size);
+
+      // Limited to 1 GiB
+      if (kibibytes <= 0 || kibibytes > 1024 * 1024) {
+        std::cout << "spectrum: invalid value for option [--read-ahead " << size << "]\n";
+        return false;
+      }
+
+      input.read_ahead = static_cast<uint32_t>(kibibytes) * 1024;
+    }
+
+    // Check if contains thread budget for decoding
+    if (parsed_args.find("threads") != parsed_args.end()) {
+      const std::string& count = parsed_args["threads"];
+      int threads = count.empty() || !std::isdigit(count.front()) ? 0 : std::stoi(count);
+
+      // Limited to a sensible number, more than that would only add overhead
+      if (threads <= 0 || threads > 64) {
+        std::cout << "spectrum: invalid value for option [--threads " << count << "]\n";
+        return false;
+      }
+
+      input.threads = static_cast<uint32_t>(threads);
+    }
+
+    // Check if contains equalizer implementation for decoding
+    if (parsed_args.find("equalizer") != parsed_args.end()) {
+      auto equalizer = model::to_equalizer(parsed_args["equalizer"]);
+
+      if (!equalizer) {
+        std::cout << "spectrum: invalid value for option [--equalizer " << parsed_args["equalizer"]
+                  << "]\n";
+        return false;
+      }
+
+      input.equalizer = *equalizer;
+    }
+
+    // Check if contains music directory for media library
+    if (parsed_args.find("library") != parsed_args.end()) {
+      library = parsed_args["library"];
+
+      if (!std::filesystem::is_directory(library)) {
+        std::cout << "spectrum: invalid value for option [--library " << library.string() << "]\n";
+        return false;
+      }
+    }
+
+    // Check if contains refresh rate for audio analysis
+    if (parsed_args.find("fps") != parsed_args.end()) {
+      const std::string& rate = parsed_args["fps"];
+      analysis_rate = rate.empty() || !std::isdigit(rate.front()) ? 0 : std::stoi(rate);
+
+      // Limited to a sensible number, as terminal won't be able to keep up with more than that
+      if (analysis_rate <= 0 || analysis_rate > 240) {
+        std::cout << "spectrum: invalid value for option [--fps " << rate << "]\n";
+        return false;
+      }
+    }
+
   } catch (...) {
     // Got some error while trying to parse, or even received help as argument
     // Just let ArgumentParser inform about it on CLI
@@ -43,26 +205,66 @@ bool parse(int argc, char** argv) {
   return true;
 }
 
+//! Get path to cache directory, following XDG base directory specification
+std::filesystem::path get_cache_directory() {
+  const char* cache = std::getenv("XDG_CACHE_HOME");
+  const char* home = std::getenv("HOME");
+
+  std::filesystem::path base = cache && *cache ? std::filesystem::path{cache}
+                               : home          ? std::filesystem::path{home} / ".cache"
+                                               : std::filesystem::temp_directory_path();
+
+  return base / "spectrum";
+}
+
+//! Get path to media library index
+std::filesystem::path get_library_index() { return get_cache_directory() / "library.idx"; }
+
+//! Get path to FFTW wisdom, so plans measured once are reused on every execution
+std::filesystem::path get_fftw_wisdom() { return get_cache_directory() / "fftw.wisdom"; }
+
 /* ********************************************************************************************** */
 
 int main(int argc, char** argv) {
   // In case of getting some unexpected argument or some other error:
   // Do not execute the program
-  if (!parse(argc, argv)) {
+  model::PlaybackSettings settings;
+  model::InputSettings input;
+  std::filesystem::path library_root;
+  int analysis_rate = 0;
+  if (!parse(argc, argv, settings, input, library_root, analysis_rate)) {
     return EXIT_SUCCESS;
   }
 
+  // Index media library in background, as scanning a large one may take a while
+  std::unique_ptr<middleware::MediaLibrary> library;
+  if (!library_root.empty()) {
+    library = middleware::MediaLibrary::Create(get_library_index());
+    library->Scan(library_root);
+  }
+
   // Create and initialize a new player
-  auto player = audio::Player::Create();
+  auto player = audio::Player::Create(settings, input);
+
+  // Songs already indexed by media library are listed by their artist and title
+  interface::SongLookup lookup;
+  if (library) lookup = [&library](const auto& file) { return library->Find(file); };
 
   // Create and initialize a new terminal window
-  auto terminal = interface::Terminal::Create();
+  auto terminal = interface::Terminal::Create(lookup);
 
   // Use terminal maximum width as input to decide how many bars should display on audio visualizer
   int number_bars = terminal->CalculateNumberBars();
 
+  // Audio analyzer (ownership is taken by middleware)
+  driver::Analyzer* analyzer = nullptr;
+#ifndef SPECTRUM_DEBUG
+  analyzer = new driver::FFTW(get_fftw_wisdom());
+#endif
+
   // Create and initialize a new middleware for terminal and player
-  auto middleware = middleware::MediaController::Create(terminal, player, number_bars);
+  auto middleware = middleware::MediaController::Create(terminal, player, number_bars, analyzer);
+  if (analysis_rate > 0) middleware->SetAnalysisRate(analysis_rate);
 
   // Register callbacks to Terminal and Player
   terminal->RegisterPlayerNotifier(middleware);
@@ -59,7 +59,10 @@ MediaController::MediaController(const std::shared_ptr<interface::EventDispatche
       player_ctl_{player_ctl},
       analyzer_{std::move(analyzer)},
       analysis_loop_{},
-      sync_data_{} {}
+      sync_data_{},
+      analysis_rate_{kAnalysisRate},
+      effective_rate_{0},
+      skipped_frames_{0} {}
 
 /* ********************************************************************************************** */
 
@@ -94,13 +97,41 @@ void MediaController::Exit() {
 
 /* ********************************************************************************************** */
 
+void MediaController::SetAnalysisRate(int rate) {
+  if (rate <= 0) return;
+
+  LOG("Set audio analysis rate to value=", rate);
+  analysis_rate_.store(rate);
+}
+
+/* ********************************************************************************************** */
+
+MediaController::AnalysisStatistics MediaController::GetAnalysisStatistics() const {
+  return AnalysisStatistics{
+      .rate = effective_rate_.load(),
+      .skipped = skipped_frames_.load(),
+      .dropped = sync_data_.ring.Dropped(),
+  };
+}
+
+/* ********************************************************************************************** */
+
 void MediaController::AnalysisHandler() {
   LOG("Start analysis handler thread");
 
   using namespace std::chrono_literals;
-  std::vector<double> input, output, previous;
+  using Duration = std::chrono::duration<long double, std::nano>;
+
+  std::vector<float> left, right;
+  std::vector<double> output, previous;
   int in_size, out_size;
 
+  // Schedule for analysis, and counters to measure its effective rate
+  std::chrono::time_point<std::chrono::steady_clock, Duration> next_analysis;
+  std::chrono::steady_clock::time_point window_start;
+  int analyses = 0;
+  uint64_t skipped = 0;
+
   while (sync_data_.WaitForCommand()) {
     // Get buffer size directly from audio analyzer, to discover chunk size to receive and send
     in_size = analyzer_->GetBufferSize();
@@ -111,16 +142,43 @@ void MediaController::AnalysisHandler() {
       output.resize(out_size);
     }
 
+    // Same for input vectors (only grows, so it won't allocate again while running)
+    if (left.size() < in_size) {
+      left.resize(in_size);
+      right.resize(in_size);
+    }
+
     auto command = sync_data_.Pop();
 
     switch (command) {
       case Command::Analyze: {
-        // Get input data, run FFT and update local cache
+        // Keep analysis at target rate, so everything received until then is analyzed at once (any
+        // other command received meanwhile cuts this wait short)
+        sync_data_.WaitForCommandOrUntil(next_analysis);
+        next_analysis = std::chrono::steady_clock::now() + Duration{1s} / analysis_rate_.load();
+
+        // Get only the most recent input data, run FFT and update local cache
         // P.S.: do not log this because this command is received too often
-        input = sync_data_.GetBuffer(in_size);
-        analyzer_->Execute(input.data(), input.size(), output.data());
+        int frames = sync_data_.GetBuffer(in_size, left.data(), right.data(), skipped);
+        if (frames == 0) break;
+
+        analyzer_->Execute(left.data(), right.data(), frames, output.data());
         previous = output;
 
+        // Update statistics (rate is measured roughly once per second, only while playing)
+        skipped_frames_.store(skipped);
+
+        auto now = std::chrono::steady_clock::now();
+        if (analyses++ == 0) window_start = now;
+
+        std::chrono::duration<double> elapsed = now - window_start;
+
+        if (elapsed >= 1s) {
+          effective_rate_.store((analyses - 1) / elapsed.count());
+          window_start = now;
+          analyses = 1;
+        }
+
         auto dispatcher = GetDispatcher();
 
         // Send result to UI
@@ -132,6 +190,12 @@ void MediaController::AnalysisHandler() {
       case Command::RunClearAnimationWithRegain:
       case Command::RunClearAnimationWithoutRegain: {
         LOG("Analysis handler received command to run clear animation on audio visualizer");
+        auto statistics = GetAnalysisStatistics();
+        LOG("Audio analysis statistics: rate=", statistics.rate, "Hz, skipped=", statistics.skipped,
+            " frames, dropped=", statistics.dropped, " frames");
+
+        // Playback is on hold, so it must not count for analysis rate
+        analyses = 0;
         auto dispatcher = GetDispatcher();
 
         for (int i = 0; i < 10; i++) {
@@ -146,7 +210,7 @@ void MediaController::AnalysisHandler() {
 
           // Sleep a little bit before sending a new update to UI. And in case of receiving a new
           // command in the meantime, just cancel animation
-          auto timeout = std::chrono::system_clock::now() + 0.04s;
+          auto timeout = std::chrono::steady_clock::now() + 0.04s;
           bool exit_animation = sync_data_.WaitForCommandOrUntil(timeout);
           if (exit_animation) break;
         }
@@ -179,7 +243,7 @@ void MediaController::AnalysisHandler() {
 
           // Sleep a little bit before sending a new update to UI. And in case of receiving a new
           // command in the meantime, just cancel animation
-          auto timeout = std::chrono::system_clock::now() + 0.01s;
+          auto timeout = std::chrono::steady_clock::now() + 0.01s;
           bool exit_animation = sync_data_.WaitForCommandOrUntil(timeout);
           if (exit_animation) break;
 
@@ -187,10 +251,27 @@ void MediaController::AnalysisHandler() {
         }
       } break;
 
+      case Command::SetSampleRate: {
+        int sample_rate = sync_data_.GetSampleRate();
+        LOG("Analysis handler received command to set sample rate to value=", sample_rate);
+        analyzer_->SetSampleRate(sample_rate);
+      } break;
+
+      case Command::ResizeOutput: {
+        int output_size = sync_data_.GetOutputSize();
+        LOG("Analysis handler received command to resize output to value=", output_size);
+
+        // Buffer sizes are read again from analyzer before handling the next command
+        analyzer_->Init(output_size);
+      } break;
+
       default:
         break;
     }
   }
+
+  LOG("Finish analysis handler thread, total of skipped frames=", skipped,
+      " and dropped frames=", sync_data_.ring.Dropped());
 }
 
 /* ********************************************************************************************** */
@@ -241,8 +322,10 @@ void MediaController::SetVolume(model::Volume value) {
 /* ********************************************************************************************** */
 
 void MediaController::ResizeAnalysisOutput(int value) {
-  std::unique_lock<std::mutex> lock(sync_data_.mutex);
-  analyzer_->Init(value);
+  LOG("Add command to queue: ResizeOutput (with value=", value, ")");
+
+  // Analyzer may be running right now, so leave it for analysis thread
+  sync_data_.ResizeOutput(value);
 }
 
 /* ********************************************************************************************** */
@@ -265,6 +348,15 @@ void MediaController::SeekBackwardPosition(int value) {
 
 /* ********************************************************************************************** */
 
+void MediaController::SeekTo(std::chrono::milliseconds position) {
+  auto player = player_ctl_.lock();
+  if (!player) return;
+
+  player->SeekTo(position);
+}
+
+/* ********************************************************************************************** */
+
 void MediaController::ApplyAudioFilters(const std::vector<model::AudioFilter>& filters) {
   auto player = player_ctl_.lock();
   if (!player) return;
@@ -274,6 +366,24 @@ void MediaController::ApplyAudioFilters(const std::vector<model::AudioFilter>& f
 
 /* ********************************************************************************************** */
 
+void MediaController::WarmUpFiles(const std::vector<std::filesystem::path>& files) {
+  auto player = player_ctl_.lock();
+  if (!player) return;
+
+  player->WarmUp(std::vector<std::string>(files.begin(), files.end()));
+}
+
+/* ********************************************************************************************** */
+
+void MediaController::SetNextSong(const std::filesystem::path& file) {
+  auto player = player_ctl_.lock();
+  if (!player) return;
+
+  player->SetNextSong(file.string());
+}
+
+/* ********************************************************************************************** */
+
 void MediaController::ClearSongInformation(bool playing) {
   if (playing) sync_data_.Push(Command::RunClearAnimationWithoutRegain);
 
@@ -313,9 +423,28 @@ void MediaController::NotifySongState(const model::Song::CurrentInformation& sta
 
 /* ********************************************************************************************** */
 
-void MediaController::SendAudioRaw(uint8_t* buffer, int buffer_size) {
+void MediaController::SendAudioRaw(const model::PcmBlock& block) {
   // Append audio data to be analyzed by thread
-  sync_data_.Append(buffer, buffer_size);
+  sync_data_.Append(block);
+}
+
+/* ********************************************************************************************** */
+
+void MediaController::NotifyAudioFormat(const model::AudioFormat& format) {
+  LOG("Update audio analysis with format=", format);
+
+  // Analyzer may be running right now, so leave it for analysis thread
+  sync_data_.SetSampleRate(static_cast<int>(format.sample_rate));
+}
+
+/* ********************************************************************************************** */
+
+void MediaController::NotifyPlaybackSettings(const model::PlaybackSettings& settings) {
+  auto dispatcher = GetDispatcher();
+  auto event = interface::CustomEvent::UpdatePlaybackSettings(settings);
+
+  // Notify File Info block with values negotiated with playback device
+  dispatcher->SendEvent(event);
 }
 
 /* ********************************************************************************************** */
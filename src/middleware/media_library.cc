@@ -0,0 +1,393 @@
+#include "middleware/media_library.h"
+
+#include <algorithm>
+#include <fstream>
+#include <iomanip>
+#include <mutex>
+#include <system_error>
+#include <tuple>
+#include <unordered_set>
+
+#ifndef SPECTRUM_DEBUG
+#include "audio/driver/ffmpeg.h"
+#else
+#include "audio/debug/dummy_decoder.h"
+#endif
+
+#include "util/logger.h"
+
+namespace middleware {
+
+namespace {
+
+//! Maximum length for a string read from index, anything bigger means that file is corrupted
+constexpr uint32_t kMaxStringLength = 64 * 1024;
+
+//! Maximum number of entries to reserve in advance, as count from index may be corrupted as well
+constexpr uint64_t kMaxReserve = 1024 * 1024;
+
+//! Write plain value in binary format
+template <typename T>
+void WriteValue(std::ostream& out, const T& value) {
+  out.write(reinterpret_cast<const char*>(&value), sizeof(T));
+}
+
+//! Write string in binary format, prefixed by its length
+void WriteString(std::ostream& out, const std::string& value) {
+  WriteValue(out, static_cast<uint32_t>(value.size()));
+  out.write(value.data(), static_cast<std::streamsize>(value.size()));
+}
+
+//! Read plain value in binary format
+template <typename T>
+bool ReadValue(std::istream& in, T& value) {
+  return static_cast<bool>(in.read(reinterpret_cast<char*>(&value), sizeof(T)));
+}
+
+//! Read string in binary format, prefixed by its length
+bool ReadString(std::istream& in, std::string& value) {
+  uint32_t length = 0;
+  if (!ReadValue(in, length) || length > kMaxStringLength) return false;
+
+  value.resize(length);
+  return static_cast<bool>(in.read(value.data(), length));
+}
+
+//! Get last modification time from file as a plain number
+int64_t GetModificationTime(const std::filesystem::directory_entry& entry, std::error_code& ec) {
+  return static_cast<int64_t>(entry.last_write_time(ec).time_since_epoch().count());
+}
+
+//! Check if path is inside root directory (both must be normalized)
+bool IsInside(const std::string& path, const std::string& root) {
+  return path.size() > root.size() && path.compare(0, root.size(), root) == 0 &&
+         (root.back() == std::filesystem::path::preferred_separator ||
+          path[root.size()] == std::filesystem::path::preferred_separator);
+}
+
+}  // namespace
+
+/* ********************************************************************************************** */
+
+bool MediaLibrary::Statistics::operator==(const Statistics& other) const {
+  return std::tie(files, probed, unchanged, failed, removed) ==
+         std::tie(other.files, other.probed, other.unchanged, other.failed, other.removed);
+}
+
+/* ********************************************************************************************** */
+
+MediaLibrary::MediaLibrary(const std::filesystem::path& index_path, Probe probe, unsigned workers)
+    : index_path_{index_path}, probe_{std::move(probe)}, workers_{workers} {}
+
+/* ********************************************************************************************** */
+
+std::unique_ptr<MediaLibrary> MediaLibrary::Create(const std::filesystem::path& index_path,
+                                                   Probe probe, unsigned workers) {
+  LOG("Create new instance of media library with index=", index_path);
+
+  if (!probe) {
+#ifndef SPECTRUM_DEBUG
+    // Probe file using FFmpeg, limited to its first few hundred kilobytes
+    probe = driver::FFmpeg::ProbeFile;
+#else
+    // Fill song with dummy information
+    probe = [](model::Song& song) {
+      std::string filepath = song.filepath;
+      error::Code result = driver::DummyDecoder{}.OpenFile(song);
+      song.filepath = filepath;
+      return result;
+    };
+#endif
+  }
+
+  // Probing is mostly waiting for I/O, but still, too many threads would only thrash the disk
+  if (workers == 0) {
+    workers = std::clamp(std::thread::hardware_concurrency(), 1U, kMaxWorkers);
+  }
+
+  auto library =
+      std::unique_ptr<MediaLibrary>(new MediaLibrary(index_path, std::move(probe), workers));
+
+  library->Load();
+  return library;
+}
+
+/* ********************************************************************************************** */
+
+MediaLibrary::~MediaLibrary() {
+  Cancel();
+  Wait();
+}
+
+/* ********************************************************************************************** */
+
+error::Code MediaLibrary::Load() {
+  LOG("Load media library index from path=", index_path_);
+  std::ifstream in(index_path_, std::ios::binary);
+
+  if (!in) {
+    LOG("Cannot find media library index, starting with an empty one");
+    return error::kInvalidFile;
+  }
+
+  uint32_t magic = 0, version = 0;
+  uint64_t count = 0;
+
+  if (!ReadValue(in, magic) || magic != kMagic || !ReadValue(in, version) ||
+      version != kVersion || !ReadValue(in, count)) {
+    ERROR("Media library index has an unknown format, ignoring it");
+    return error::kInvalidFile;
+  }
+
+  std::unordered_map<std::string, Record> records;
+  records.reserve(std::min<uint64_t>(count, kMaxReserve));
+
+  for (uint64_t i = 0; i < count; i++) {
+    std::string filepath;
+    Record record{};
+    uint8_t flags = 0;
+
+    bool success = ReadString(in, filepath) && ReadValue(in, record.size) &&
+                   ReadValue(in, record.mtime) && ReadValue(in, flags) &&
+                   ReadString(in, record.song.artist) && ReadString(in, record.song.title) &&
+                   ReadValue(in, record.song.num_channels) &&
+                   ReadValue(in, record.song.sample_rate) && ReadValue(in, record.song.bit_rate) &&
+                   ReadValue(in, record.song.bit_depth) && ReadValue(in, record.song.duration);
+
+    if (!success) {
+      ERROR("Media library index is corrupted, ignoring it");
+      return error::kCorruptedData;
+    }
+
+    record.supported = flags & 0x1;
+    record.song.filepath = filepath;
+    records.emplace(std::move(filepath), std::move(record));
+  }
+
+  std::unique_lock lock(mutex_);
+  records_ = std::move(records);
+
+  LOG("Loaded media library index with ", records_.size(), " entries");
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+error::Code MediaLibrary::Save() const {
+  LOG("Save media library index to path=", index_path_);
+
+  std::error_code ec;
+  if (index_path_.has_parent_path()) {
+    std::filesystem::create_directories(index_path_.parent_path(), ec);
+  }
+
+  auto temporary = index_path_;
+  temporary += ".tmp";
+
+  {
+    std::ofstream out(temporary, std::ios::binary | std::ios::trunc);
+
+    if (!out) {
+      ERROR("Cannot create media library index at path=", temporary);
+      return error::kUnknownError;
+    }
+
+    std::shared_lock lock(mutex_);
+
+    WriteValue(out, kMagic);
+    WriteValue(out, kVersion);
+    WriteValue(out, static_cast<uint64_t>(records_.size()));
+
+    for (const auto& [filepath, record] : records_) {
+      WriteString(out, filepath);
+      WriteValue(out, record.size);
+      WriteValue(out, record.mtime);
+      WriteValue(out, static_cast<uint8_t>(record.supported ? 0x1 : 0x0));
+      WriteString(out, record.song.artist);
+      WriteString(out, record.song.title);
+      WriteValue(out, record.song.num_channels);
+      WriteValue(out, record.song.sample_rate);
+      WriteValue(out, record.song.bit_rate);
+      WriteValue(out, record.song.bit_depth);
+      WriteValue(out, record.song.duration);
+    }
+
+    if (!out.flush()) {
+      ERROR("Cannot write media library index at path=", temporary);
+      return error::kUnknownError;
+    }
+  }
+
+  std::filesystem::rename(temporary, index_path_, ec);
+
+  if (ec) {
+    ERROR("Cannot replace media library index, error=", ec.message());
+    return error::kUnknownError;
+  }
+
+  return error::kSuccess;
+}
+
+/* ********************************************************************************************** */
+
+void MediaLibrary::Scan(const std::filesystem::path& root) {
+  Cancel();
+  Wait();
+
+  LOG("Start scanning media library from root=", root);
+  cancel_ = false;
+  scanning_ = true;
+
+  scanner_ = std::thread(&MediaLibrary::Walk, this, std::filesystem::absolute(root));
+}
+
+/* ********************************************************************************************** */
+
+void MediaLibrary::Cancel() { cancel_ = true; }
+
+/* ********************************************************************************************** */
+
+void MediaLibrary::Wait() {
+  if (scanner_.joinable()) {
+    scanner_.join();
+  }
+}
+
+/* ********************************************************************************************** */
+
+std::optional<model::Song> MediaLibrary::Find(const std::filesystem::path& filepath) const {
+  std::shared_lock lock(mutex_);
+  auto it = records_.find(filepath.lexically_normal().string());
+
+  if (it == records_.end() || !it->second.supported) return std::nullopt;
+  return it->second.song;
+}
+
+/* ********************************************************************************************** */
+
+size_t MediaLibrary::Size() const {
+  std::shared_lock lock(mutex_);
+  return records_.size();
+}
+
+/* ********************************************************************************************** */
+
+MediaLibrary::Statistics MediaLibrary::GetStatistics() const {
+  std::shared_lock lock(mutex_);
+  return statistics_;
+}
+
+/* ********************************************************************************************** */
+
+void MediaLibrary::Walk(const std::filesystem::path& root) {
+  const std::string prefix = root.lexically_normal().string();
+
+  std::unordered_set<std::string> found;
+  std::vector<Pending> queue;
+  Statistics statistics;
+
+  // Walk directory tree, and only keep files that are new or have been modified since last scan
+  std::error_code ec;
+  auto options = std::filesystem::directory_options::skip_permission_denied;
+
+  for (auto it = std::filesystem::recursive_directory_iterator(root, options, ec);
+       !ec && it != std::filesystem::recursive_directory_iterator(); it.increment(ec)) {
+    if (cancel_) break;
+
+    std::error_code file_ec;
+    if (!it->is_regular_file(file_ec)) continue;
+
+    uint64_t size = it->file_size(file_ec);
+    int64_t mtime = GetModificationTime(*it, file_ec);
+    if (file_ec) continue;
+
+    std::string filepath = it->path().lexically_normal().string();
+    statistics.files++;
+
+    {
+      std::shared_lock lock(mutex_);
+      auto record = records_.find(filepath);
+
+      if (record != records_.end() && record->second.size == size &&
+          record->second.mtime == mtime) {
+        statistics.unchanged++;
+        found.insert(std::move(filepath));
+        continue;
+      }
+    }
+
+    found.insert(filepath);
+    queue.push_back(Pending{.filepath = std::move(filepath), .size = size, .mtime = mtime});
+  }
+
+  if (ec) ERROR("Cannot walk directory tree, error=", ec.message());
+
+  {
+    std::unique_lock lock(mutex_);
+    statistics_ = statistics;
+  }
+
+  LOG("Found ", statistics.files, " files in media library, and ", queue.size(),
+      " of them must be probed");
+
+  // Probe files in parallel
+  std::atomic<size_t> next = 0;
+  std::vector<std::thread> workers;
+  unsigned count = std::min<size_t>(workers_, queue.size());
+
+  for (unsigned i = 0; i < count; i++) {
+    workers.emplace_back(&MediaLibrary::Worker, this, std::cref(queue), std::ref(next));
+  }
+
+  for (auto& worker : workers) worker.join();
+
+  // Directory tree was not walked until the end, so it is not possible to know what was removed
+  if (!cancel_ && !ec) {
+    std::unique_lock lock(mutex_);
+
+    for (auto it = records_.begin(); it != records_.end();) {
+      if (IsInside(it->first, prefix) && found.find(it->first) == found.end()) {
+        it = records_.erase(it);
+        statistics_.removed++;
+      } else {
+        ++it;
+      }
+    }
+  }
+
+  Save();
+
+  statistics = GetStatistics();
+  LOG("Finish scanning media library (probed=", statistics.probed,
+      " unchanged=", statistics.unchanged, " failed=", statistics.failed,
+      " removed=", statistics.removed, " cancelled=", cancel_.load(), ")");
+
+  scanning_ = false;
+}
+
+/* ********************************************************************************************** */
+
+void MediaLibrary::Worker(const std::vector<Pending>& queue, std::atomic<size_t>& next) {
+  for (size_t index = next++; index < queue.size() && !cancel_; index = next++) {
+    const Pending& pending = queue[index];
+
+    Record record{.size = pending.size, .mtime = pending.mtime};
+    record.song.filepath = pending.filepath;
+
+    // Probing may take a while, so do not block anyone meanwhile
+    record.supported = probe_(record.song) == error::kSuccess;
+
+    // Keep entry for unsupported file too, so it is not probed again on the next scan
+    if (!record.supported) {
+      record.song = model::Song{.filepath = pending.filepath};
+    }
+
+    std::unique_lock lock(mutex_);
+    statistics_.probed++;
+    if (!record.supported) statistics_.failed++;
+
+    records_.insert_or_assign(pending.filepath, std::move(record));
+  }
+}
+
+}  // namespace middleware
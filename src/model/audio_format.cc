@@ -0,0 +1,40 @@
+#include "model/audio_format.h"
+
+#include <tuple>
+
+namespace model {
+
+bool AudioFormat::operator==(const AudioFormat& other) const {
+  return std::tie(sample_format, sample_rate, channels) ==
+         std::tie(other.sample_format, other.sample_rate, other.channels);
+}
+
+bool AudioFormat::operator!=(const AudioFormat& other) const { return !operator==(other); }
+
+//! AudioFormat::SampleFormat pretty print
+std::ostream& operator<<(std::ostream& out, const AudioFormat::SampleFormat& s) {
+  switch (s) {
+    case AudioFormat::SampleFormat::S16:
+      out << "S16";
+      break;
+
+    case AudioFormat::SampleFormat::S32:
+      out << "S32";
+      break;
+
+    case AudioFormat::SampleFormat::Float:
+      out << "Float";
+      break;
+  }
+
+  return out;
+}
+
+//! AudioFormat pretty print
+std::ostream& operator<<(std::ostream& out, const AudioFormat& a) {
+  out << "{sample_format:" << a.sample_format << " sample_rate:" << a.sample_rate
+      << " channels:" << a.channels << "}";
+  return out;
+}
+
+}  // namespace model
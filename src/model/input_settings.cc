@@ -0,0 +1,69 @@
+#include "model/input_settings.h"
+
+#include <tuple>
+
+namespace model {
+
+bool InputSettings::operator==(const InputSettings& other) const {
+  return std::tie(access, read_ahead, threads, equalizer) ==
+         std::tie(other.access, other.read_ahead, other.threads, other.equalizer);
+}
+
+bool InputSettings::operator!=(const InputSettings& other) const { return !operator==(other); }
+
+//! InputSettings::Access pretty print
+std::ostream& operator<<(std::ostream& out, const InputSettings::Access& a) {
+  switch (a) {
+    case InputSettings::Access::Stream:
+      out << "Stream";
+      break;
+
+    case InputSettings::Access::Mmap:
+      out << "Mmap";
+      break;
+  }
+
+  return out;
+}
+
+//! InputSettings::Equalizer pretty print
+std::ostream& operator<<(std::ostream& out, const InputSettings::Equalizer& e) {
+  switch (e) {
+    case InputSettings::Equalizer::Filter:
+      out << "Filter";
+      break;
+
+    case InputSettings::Equalizer::Native:
+      out << "Native";
+      break;
+  }
+
+  return out;
+}
+
+//! InputSettings pretty print
+std::ostream& operator<<(std::ostream& out, const InputSettings& s) {
+  out << "{access:" << s.access << " read_ahead:" << s.read_ahead << " threads:" << s.threads
+      << " equalizer:" << s.equalizer << "}";
+  return out;
+}
+
+/* ********************************************************************************************** */
+
+std::optional<InputSettings::Access> to_access(const std::string& name) {
+  if (name == "stream") return InputSettings::Access::Stream;
+  if (name == "mmap") return InputSettings::Access::Mmap;
+
+  return std::nullopt;
+}
+
+/* ********************************************************************************************** */
+
+std::optional<InputSettings::Equalizer> to_equalizer(const std::string& name) {
+  if (name == "filter") return InputSettings::Equalizer::Filter;
+  if (name == "native") return InputSettings::Equalizer::Native;
+
+  return std::nullopt;
+}
+
+}  // namespace model
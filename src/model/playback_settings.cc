@@ -0,0 +1,77 @@
+#include "model/playback_settings.h"
+
+#include <sstream>
+#include <tuple>
+
+#include "util/formatter.h"
+
+namespace model {
+
+bool PlaybackSettings::operator==(const PlaybackSettings& other) const {
+  return std::tie(device, latency, mmap, format, period_size, buffer_size) ==
+         std::tie(other.device, other.latency, other.mmap, other.format, other.period_size,
+                  other.buffer_size);
+}
+
+bool PlaybackSettings::operator!=(const PlaybackSettings& other) const {
+  return !operator==(other);
+}
+
+//! PlaybackSettings::Latency pretty print
+std::ostream& operator<<(std::ostream& out, const PlaybackSettings::Latency& l) {
+  switch (l) {
+    case PlaybackSettings::Latency::Low:
+      out << "Low";
+      break;
+
+    case PlaybackSettings::Latency::Balanced:
+      out << "Balanced";
+      break;
+
+    case PlaybackSettings::Latency::PowerSaving:
+      out << "PowerSaving";
+      break;
+  }
+
+  return out;
+}
+
+//! PlaybackSettings pretty print
+std::ostream& operator<<(std::ostream& out, const PlaybackSettings& s) {
+  out << "{device:" << s.device << " latency:" << s.latency << " mmap:" << s.mmap
+      << " format:" << s.format << " period_size:" << s.period_size
+      << " buffer_size:" << s.buffer_size << "}";
+  return out;
+}
+
+/* ********************************************************************************************** */
+
+std::optional<PlaybackSettings::Latency> to_latency(const std::string& name) {
+  if (name == "low") return PlaybackSettings::Latency::Low;
+  if (name == "balanced") return PlaybackSettings::Latency::Balanced;
+  if (name == "power-saving") return PlaybackSettings::Latency::PowerSaving;
+
+  return std::nullopt;
+}
+
+/* ********************************************************************************************** */
+
+std::string to_string(const PlaybackSettings& arg) {
+  std::ostringstream format;
+  format << arg.format.sample_format << " "
+         << util::format_with_prefix(arg.format.sample_rate, "Hz");
+
+  std::string period = util::to_string_with_precision(arg.ToMilliseconds(arg.period_size), 1);
+  std::string buffer = util::to_string_with_precision(arg.ToMilliseconds(arg.buffer_size), 1);
+
+  std::ostringstream ss;
+
+  ss << "Device: " << arg.device << std::endl;
+  ss << "Output: " << format.str() << std::endl;
+  ss << "Period: " << period << " ms" << std::endl;
+  ss << "Latency: " << buffer << " ms" << std::endl;
+
+  return std::move(ss).str();
+}
+
+}  // namespace model
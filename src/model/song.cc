@@ -13,7 +13,8 @@
 namespace model {
 
 bool Song::CurrentInformation::operator==(const Song::CurrentInformation& other) const {
-  return std::tie(state, position) == std::tie(other.state, position);
+  return std::tie(state, position, position_ms) ==
+         std::tie(other.state, other.position, other.position_ms);
 }
 
 bool Song::CurrentInformation::operator!=(const Song::CurrentInformation& other) const {
@@ -54,7 +55,8 @@ std::ostream& operator<<(std::ostream& out, const Song::MediaState& state) {
 
 //! Song::CurrentInformation pretty print
 std::ostream& operator<<(std::ostream& out, const Song::CurrentInformation& info) {
-  out << "{state:" << info.state << " position:" << info.position << "}";
+  out << "{state:" << info.state << " position:" << info.position
+      << " position_ms:" << info.position_ms << "}";
   return out;
 }
 
@@ -0,0 +1,110 @@
+#include "util/path_table.h"
+
+#include <stdexcept>
+#include <system_error>
+
+namespace util {
+
+void PathTable::reserve(size_t entries, size_t bytes) {
+  slots_.reserve(entries);
+  arena_.reserve(bytes);
+}
+
+/* ********************************************************************************************** */
+
+void PathTable::emplace_back(const std::filesystem::directory_entry& entry) {
+  std::error_code ec;
+  emplace_back(entry.path().native(), entry.is_directory(ec));
+}
+
+/* ********************************************************************************************** */
+
+void PathTable::emplace_back(const std::filesystem::path& path) {
+  emplace_back(path.native(), std::filesystem::is_directory(path));
+}
+
+/* ********************************************************************************************** */
+
+void PathTable::emplace_back(std::string_view path, bool directory) {
+  slots_.push_back(Append(path, directory));
+}
+
+/* ********************************************************************************************** */
+
+void PathTable::emplace_front(std::string_view path, bool directory) {
+  slots_.insert(slots_.begin(), Append(path, directory));
+}
+
+/* ********************************************************************************************** */
+
+void PathTable::shrink_to_fit() {
+  slots_.shrink_to_fit();
+  arena_.shrink_to_fit();
+}
+
+/* ********************************************************************************************** */
+
+void PathTable::clear() {
+  slots_.clear();
+  arena_.clear();
+}
+
+/* ********************************************************************************************** */
+
+std::filesystem::path PathTable::at(size_t index) const {
+  return std::filesystem::path{native(index)};
+}
+
+/* ********************************************************************************************** */
+
+std::string_view PathTable::native(size_t index) const {
+  const Slot& slot = slots_.at(index);
+  return std::string_view{arena_}.substr(slot.offset, slot.length);
+}
+
+/* ********************************************************************************************** */
+
+std::string_view PathTable::filename(size_t index) const { return GetFilename(slots_.at(index)); }
+
+/* ********************************************************************************************** */
+
+std::vector<PathTable::Index> PathTable::find(std::string_view text) const {
+  std::vector<Index> result;
+
+  // Lower text only once, and compare it against filenames lowered on the fly
+  std::string pattern{text};
+  std::transform(pattern.begin(), pattern.end(), pattern.begin(), ToLower);
+
+  auto compare = [](char a, char b) { return ToLower(a) == b; };
+
+  for (size_t i = 0; i < slots_.size(); i++) {
+    std::string_view name = GetFilename(slots_[i]);
+
+    if (pattern.empty() || std::search(name.begin(), name.end(), pattern.begin(), pattern.end(),
+                                       compare) != name.end()) {
+      result.push_back(static_cast<Index>(i));
+    }
+  }
+
+  return result;
+}
+
+/* ********************************************************************************************** */
+
+PathTable::Slot PathTable::Append(std::string_view path, bool directory) {
+  // Filename is whatever comes after the last separator (and it is the whole path if none)
+  size_t separator = path.rfind(std::filesystem::path::preferred_separator);
+  size_t name = separator == std::string_view::npos ? 0 : separator + 1;
+
+  Slot slot{
+      .offset = arena_.size(),
+      .length = static_cast<uint32_t>(path.size()),
+      .name = static_cast<uint16_t>(name),
+      .directory = directory,
+  };
+
+  arena_.append(path);
+  return slot;
+}
+
+}  // namespace util
@@ -24,6 +24,11 @@ struct ContentVisitor {
   }
   void operator()(const model::BarAnimation& a) const { out << a; }
   void operator()(const model::BlockIdentifier& i) const { out << i; }
+  void operator()(const model::PlaybackSettings& s) const { out << s; }
+  void operator()(const std::chrono::milliseconds& ms) const { out << ms.count() << "ms"; }
+  void operator()(const std::vector<std::filesystem::path>& f) const {
+    out << "{" << f.size() << " files}";
+  }
 
   std::ostream& out;
 };
@@ -69,6 +74,10 @@ std::ostream& operator<<(std::ostream& out, const CustomEvent::Identifier& i) {
       out << "DrawAudioSpectrum";
       break;
 
+    case CustomEvent::Identifier::UpdatePlaybackSettings:
+      out << "UpdatePlaybackSettings";
+      break;
+
     case CustomEvent::Identifier::NotifyFileSelection:
       out << "NotifyFileSelection";
       break;
@@ -105,6 +114,18 @@ std::ostream& operator<<(std::ostream& out, const CustomEvent::Identifier& i) {
       out << "ApplyAudioFilters";
       break;
 
+    case CustomEvent::Identifier::SeekToPosition:
+      out << "SeekToPosition";
+      break;
+
+    case CustomEvent::Identifier::WarmUpFiles:
+      out << "WarmUpFiles";
+      break;
+
+    case CustomEvent::Identifier::SetNextSong:
+      out << "SetNextSong";
+      break;
+
     case CustomEvent::Identifier::Refresh:
       out << "Refresh";
       break;
@@ -213,6 +234,17 @@ CustomEvent CustomEvent::DrawAudioSpectrum(const std::vector<double>& data) {
 
 /* ********************************************************************************************** */
 
+// Static
+CustomEvent CustomEvent::UpdatePlaybackSettings(const model::PlaybackSettings& settings) {
+  return CustomEvent{
+      .type = Type::FromAudioThreadToInterface,
+      .id = Identifier::UpdatePlaybackSettings,
+      .content = settings,
+  };
+}
+
+/* ********************************************************************************************** */
+
 // Static
 CustomEvent CustomEvent::NotifyFileSelection(const std::filesystem::path file_path) {
   return CustomEvent{
@@ -298,6 +330,17 @@ CustomEvent CustomEvent::SeekBackwardPosition(int offset) {
 
 /* ********************************************************************************************** */
 
+// Static
+CustomEvent CustomEvent::SeekToPosition(std::chrono::milliseconds position) {
+  return CustomEvent{
+      .type = Type::FromInterfaceToAudioThread,
+      .id = Identifier::SeekToPosition,
+      .content = position,
+  };
+}
+
+/* ********************************************************************************************** */
+
 // Static
 CustomEvent CustomEvent::ApplyAudioFilters(const std::vector<model::AudioFilter> filters) {
   return CustomEvent{
@@ -309,6 +352,28 @@ CustomEvent CustomEvent::ApplyAudioFilters(const std::vector<model::AudioFilter>
 
 /* ********************************************************************************************** */
 
+// Static
+CustomEvent CustomEvent::WarmUpFiles(const std::vector<std::filesystem::path>& files) {
+  return CustomEvent{
+      .type = Type::FromInterfaceToAudioThread,
+      .id = Identifier::WarmUpFiles,
+      .content = files,
+  };
+}
+
+/* ********************************************************************************************** */
+
+// Static
+CustomEvent CustomEvent::SetNextSong(const std::filesystem::path& file_path) {
+  return CustomEvent{
+      .type = Type::FromInterfaceToAudioThread,
+      .id = Identifier::SetNextSong,
+      .content = file_path,
+  };
+}
+
+/* ********************************************************************************************** */
+
 // Static
 CustomEvent CustomEvent::Refresh() {
   return CustomEvent{
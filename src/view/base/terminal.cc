@@ -30,7 +30,7 @@ bool operator!=(const ftxui::Dimensions& lhs, const ftxui::Dimensions& rhs) {
 
 /* ********************************************************************************************** */
 
-std::shared_ptr<Terminal> Terminal::Create() {
+std::shared_ptr<Terminal> Terminal::Create(SongLookup lookup) {
   LOG("Create new instance of terminal");
 
   // Simply extend the Terminal class, as we do not want to expose the default constructor, neither
@@ -39,7 +39,7 @@ std::shared_ptr<Terminal> Terminal::Create() {
   auto terminal = std::make_shared<MakeSharedEnabler>();
 
   // Initialize internal components
-  terminal->Init();
+  terminal->Init(std::move(lookup));
 
   return terminal;
 }
@@ -68,7 +68,7 @@ Terminal::~Terminal() {
 
 /* ********************************************************************************************** */
 
-void Terminal::Init() {
+void Terminal::Init(SongLookup lookup) {
   LOG("Initialize terminal");
 
   // As this terminal will hold all these interface blocks, there is nothing better than
@@ -76,7 +76,7 @@ void Terminal::Init() {
   std::shared_ptr<EventDispatcher> dispatcher = shared_from_this();
 
   // Create blocks
-  auto list_dir = std::make_shared<ListDirectory>(dispatcher);
+  auto list_dir = std::make_shared<ListDirectory>(dispatcher, "", std::move(lookup));
   auto file_info = std::make_shared<FileInfo>(dispatcher);
   auto tab_viewer = std::make_shared<TabViewer>(dispatcher);
   auto media_player = std::make_shared<MediaPlayer>(dispatcher);
@@ -397,12 +397,27 @@ bool Terminal::HandleEventFromInterfaceToAudioThread(const CustomEvent& event) {
       media_ctl->SeekBackwardPosition(content);
     } break;
 
+    case CustomEvent::Identifier::SeekToPosition: {
+      auto content = event.GetContent<std::chrono::milliseconds>();
+      media_ctl->SeekTo(content);
+    } break;
+
     case CustomEvent::Identifier::ApplyAudioFilters: {
       auto content = event.GetContent<std::vector<model::AudioFilter>>();
       media_ctl->ApplyAudioFilters(content);
 
     } break;
 
+    case CustomEvent::Identifier::WarmUpFiles: {
+      auto content = event.GetContent<std::vector<std::filesystem::path>>();
+      media_ctl->WarmUpFiles(content);
+    } break;
+
+    case CustomEvent::Identifier::SetNextSong: {
+      auto content = event.GetContent<std::filesystem::path>();
+      media_ctl->SetNextSong(content);
+    } break;
+
     default:
       event_handled = false;
       break;
@@ -15,7 +15,8 @@ namespace interface {
 FileInfo::FileInfo(const std::shared_ptr<EventDispatcher>& dispatcher)
     : Block{dispatcher, model::BlockIdentifier::FileInfo,
             interface::Size{.width = 0, .height = kMaxRows}},
-      audio_info_{} {}
+      audio_info_{},
+      playback_settings_{} {}
 
 /* ********************************************************************************************** */
 
@@ -26,8 +27,12 @@ ftxui::Element FileInfo::Render() {
   ftxui::Color::Palette256 color =
       audio_info_.filepath.empty() ? ftxui::Color::LightSteelBlue3 : ftxui::Color::LightSteelBlue1;
 
+  // Values negotiated with playback device are only shown after receiving them
+  std::string info = model::to_string(audio_info_);
+  if (playback_settings_.period_size > 0) info.append(model::to_string(playback_settings_));
+
   // Use istringstream to split string into lines and parse it as <Field, Value>
-  std::istringstream input{model::to_string(audio_info_)};
+  std::istringstream input{info};
   size_t pos;
 
   for (std::string line; std::getline(input, line);) {
@@ -71,6 +76,12 @@ bool FileInfo::OnCustomEvent(const CustomEvent& event) {
     audio_info_ = event.GetContent<model::Song>();
   }
 
+  // Do not return true because other blocks may use it
+  if (event == CustomEvent::Identifier::UpdatePlaybackSettings) {
+    LOG("Received new playback settings from player");
+    playback_settings_ = event.GetContent<model::PlaybackSettings>();
+  }
+
   return false;
 }
 
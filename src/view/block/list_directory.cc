@@ -3,11 +3,12 @@
 
 #include <ctype.h>  // for tolower
 
-#include <algorithm>   // for for_each, search, sort
-#include <filesystem>  // for path, directory_iterator
+#include <algorithm>    // for find, lexicographical_compare
+#include <filesystem>   // for path, directory_iterator
 #include <iomanip>
-#include <memory>   // for shared_ptr, __shared_p...
-#include <utility>  // for move
+#include <memory>       // for shared_ptr, __shared_p...
+#include <string_view>  // for string_view
+#include <utility>      // for move
 
 #include "ftxui/component/component.hpp"       // for Input
 #include "ftxui/component/component_base.hpp"  // for Component, ComponentBase
@@ -41,7 +42,7 @@ constexpr const T& clamp(const T& v, const T& lo, const T& hi) {
 /* ********************************************************************************************** */
 
 ListDirectory::ListDirectory(const std::shared_ptr<EventDispatcher>& dispatcher,
-                             const std::string& optional_path)
+                             const std::string& optional_path, SongLookup lookup)
     : Block{dispatcher, model::BlockIdentifier::ListDirectory,
             interface::Size{.width = kMaxColumns, .height = 0}},
       curr_dir_{optional_path == "" ? std::filesystem::current_path()
@@ -56,7 +57,8 @@ ListDirectory::ListDirectory(const std::shared_ptr<EventDispatcher>& dispatcher,
       boxes_{},
       box_{},
       mode_search_{std::nullopt},
-      animation_{TextAnimation{.enabled = false}} {
+      animation_{TextAnimation{.enabled = false}},
+      lookup_{std::move(lookup)} {
   // TODO: this is not good, read this below
   // https://google.github.io/styleguide/cppguide.html#Doing_Work_in_Constructors
   RefreshList(curr_dir_);
@@ -94,10 +96,12 @@ ftxui::Element ListDirectory::Render() {
     bool is_focused = (*focused == i);
     bool is_selected = (*selected == i);
 
-    File& entry = GetEntry(i);
-    auto& type = entry == curr_playing_                 ? styles_.playing
-                 : std::filesystem::is_directory(entry) ? styles_.directory
-                                                        : styles_.file;
+    int index = GetIndex(i);
+    bool is_playing = curr_playing_ && entries_.native(index) == curr_playing_->native();
+
+    auto& type = is_playing                     ? styles_.playing
+                 : entries_.is_directory(index) ? styles_.directory
+                                                : styles_.file;
     const char* icon = is_selected ? "> " : "  ";
 
     ftxui::Decorator style = is_selected ? (is_focused ? type.selected_focused : type.selected)
@@ -107,8 +111,7 @@ ftxui::Element ListDirectory::Render() {
 
     // In case of entry text too long, animation thread will be running, so we gotta take the text
     // content from there
-    std::string text =
-        animation_.enabled && is_selected ? animation_.text : entry.filename().string();
+    std::string text = animation_.enabled && is_selected ? animation_.text : GetText(index);
 
     entries.push_back(ftxui::text(icon + text) | ftxui::size(WIDTH, EQUAL, kMaxColumns) | style |
                       focus_management | ftxui::reflect(boxes_[i]));
@@ -163,7 +166,7 @@ bool ListDirectory::OnEvent(ftxui::Event event) {
     LOG("Enable search mode");
     mode_search_ = Search({
         .text_to_search = "",
-        .entries = entries_,
+        .entries = entries_.find(""),
         .selected = 0,
         .focused = 0,
         .position = 0,
@@ -187,6 +190,9 @@ bool ListDirectory::OnCustomEvent(const CustomEvent& event) {
 
     // Set current song
     curr_playing_ = event.GetContent<model::Song>().filepath;
+
+    // Keep playing the same directory once this song finishes
+    QueueNextSong();
   }
 
   if (event == CustomEvent::Identifier::ClearSongInfo) {
@@ -310,7 +316,7 @@ bool ListDirectory::OnMenuNavigation(ftxui::Event event) {
     std::filesystem::path new_dir;
     auto active = GetActiveEntry();
 
-    if (active != nullptr) {
+    if (active) {
       LOG("Handle menu navigation key=", util::EventToString(event));
 
       if (active->filename() == ".." && std::filesystem::exists(curr_dir_.parent_path())) {
@@ -410,6 +416,19 @@ void ListDirectory::Clamp() {
 
 /* ********************************************************************************************** */
 
+std::string ListDirectory::GetText(Files::Index index) const {
+  std::string filename{entries_.filename(index)};
+  if (!lookup_ || entries_.is_directory(index)) return filename;
+
+  // Lookup is expected to be cheap (no file is opened), so it is done on every render
+  auto song = lookup_(entries_.at(index));
+  if (!song || song->title.empty()) return filename;
+
+  return song->artist.empty() ? song->title : song->artist + " - " + song->title;
+}
+
+/* ********************************************************************************************** */
+
 std::string ListDirectory::GetTitle() {
   const std::string curr_dir = curr_dir_.string();
 
@@ -433,7 +452,7 @@ void ListDirectory::RefreshList(const std::filesystem::path& dir_path) {
   Files tmp;
 
   try {
-    // Add all files from the given directory
+    // Add all files from the given directory (and type from each entry, to avoid a stat on render)
     for (auto const& entry : std::filesystem::directory_iterator(dir_path)) {
       tmp.emplace_back(entry);
     }
@@ -448,28 +467,29 @@ void ListDirectory::RefreshList(const std::filesystem::path& dir_path) {
   entries_ = std::move(tmp);
   selected_ = 0, focused_ = 0;
 
-  // Transform whole string into uppercase
-  constexpr auto to_lower = [](char& c) { c = std::tolower(c); };
-
-  // Created a custom file sort
-  auto custom_sort = [&to_lower](const File& a, const File& b) {
-    std::string lhs{a.filename()}, rhs{b.filename()};
+  // Compare characters ignoring case
+  constexpr auto less_lower = [](unsigned char a, unsigned char b) {
+    return std::tolower(a) < std::tolower(b);
+  };
 
+  // Created a custom file sort (comparing filenames in place, without copying them)
+  auto custom_sort = [&less_lower](std::string_view lhs, std::string_view rhs) {
     // Don't care if it is hidden (tried to make it similar to "ls" output)
-    if (lhs.at(0) == '.') lhs.erase(0, 1);
-    if (rhs.at(0) == '.') rhs.erase(0, 1);
-
-    std::for_each(lhs.begin(), lhs.end(), to_lower);
-    std::for_each(rhs.begin(), rhs.end(), to_lower);
+    if (!lhs.empty() && lhs.front() == '.') lhs.remove_prefix(1);
+    if (!rhs.empty() && rhs.front() == '.') rhs.remove_prefix(1);
 
-    return lhs < rhs;
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end(),
+                                        less_lower);
   };
 
   // Sort list alphabetically (case insensitive)
-  std::sort(entries_.begin(), entries_.end(), custom_sort);
+  entries_.sort(custom_sort);
 
   // Add option to go back one level
-  entries_.insert(entries_.begin(), File{".."});
+  entries_.emplace_front("..", true);
+
+  // Directory listing is not going to change anymore, so release any memory left unused
+  entries_.shrink_to_fit();
 }
 
 /* ********************************************************************************************** */
@@ -478,26 +498,8 @@ void ListDirectory::RefreshSearchList() {
   LOG("Refresh list on search mode");
   mode_search_->selected = 0, mode_search_->focused = 0;
 
-  // Do not even try to find it in the main list
-  if (mode_search_->text_to_search.empty()) {
-    mode_search_->entries = entries_;
-    return;
-  }
-
-  auto compare_string = [](char ch1, char ch2) { return std::tolower(ch1) == std::tolower(ch2); };
-
-  mode_search_->entries.clear();
-  auto& text_to_search = mode_search_->text_to_search;
-
-  for (auto& entry : entries_) {
-    const std::string filename = entry.filename().string();
-    auto it = std::search(filename.begin(), filename.end(), text_to_search.begin(),
-                          text_to_search.end(), compare_string);
-
-    if (it != filename.end()) {
-      mode_search_->entries.push_back(entry);
-    }
-  }
+  // Only indexes are kept, so there is no need to copy any path
+  mode_search_->entries = entries_.find(mode_search_->text_to_search);
 }
 
 /* ********************************************************************************************** */
@@ -509,11 +511,59 @@ void ListDirectory::UpdateActiveEntry() {
   if (Size() > 0) {
     // Check text length of active entry
     int* selected = GetSelected();
-    std::string text{GetEntry(*selected).filename().string().append(" ")};
+    std::string text = GetText(GetIndex(*selected));
+    text.append(" ");
     int max_chars = text.length() + kMaxIconColumns;
 
     // Start animation thread
     if (max_chars > kMaxColumns) animation_.Start(text);
+
+    WarmUpEntries(*selected);
+  }
+}
+
+/* ********************************************************************************************** */
+
+void ListDirectory::WarmUpEntries(int index) {
+  std::vector<std::filesystem::path> files;
+
+  // Selected entry comes first, as it is the most likely one to be played
+  for (int offset = 0; offset <= kWarmUpNeighbours; offset++) {
+    for (int i : {index + offset, index - offset}) {
+      if (i < 0 || i >= Size()) continue;
+
+      if (entries_.is_directory(GetIndex(i))) continue;
+
+      File entry = GetEntry(i);
+      if (std::find(files.begin(), files.end(), entry) == files.end()) files.push_back(entry);
+    }
+  }
+
+  if (files.empty()) return;
+
+  auto dispatcher = GetDispatcher();
+  auto event = interface::CustomEvent::WarmUpFiles(files);
+  dispatcher->SendEvent(event);
+}
+
+/* ********************************************************************************************** */
+
+void ListDirectory::QueueNextSong() {
+  // Look for song in the whole directory (even when search mode is enabled)
+  for (size_t i = 0; i < entries_.size(); i++) {
+    if (entries_.native(i) != curr_playing_->native()) continue;
+
+    for (size_t next = i + 1; next < entries_.size(); next++) {
+      if (entries_.is_directory(next)) continue;
+
+      LOG("Queue next song with filepath=", entries_.at(next));
+      auto dispatcher = GetDispatcher();
+      auto event = interface::CustomEvent::SetNextSong(entries_.at(next));
+      dispatcher->SendEvent(event);
+      return;
+    }
+
+    break;
   }
 }
 
@@ -1,5 +1,6 @@
 #include "view/block/media_player.h"
 
+#include <chrono>
 #include <cstdlib>
 #include <sstream>
 #include <utility>  // for move
@@ -291,22 +292,21 @@ bool MediaPlayer::OnMouseEvent(ftxui::Event event) {
 
     // Calculate new song position based on screen coordinates
     int real_x = event.mouse().x - duration_box_.x_min;
-    int new_position =
-        floor(floor(song_.duration * real_x) / (duration_box_.x_max - duration_box_.x_min));
+    int width = duration_box_.x_max - duration_box_.x_min;
 
-    int offset = std::abs(int(new_position - song_.curr_info.position));
+    std::chrono::milliseconds duration = std::chrono::seconds(song_.duration);
+    std::chrono::milliseconds new_position = duration * real_x / width;
 
     // Do nothing if result is equal the current position
-    if (new_position == song_.curr_info.position) return true;
+    if (new_position.count() == song_.curr_info.position_ms) return true;
 
     LOG("Handle left click mouse event on song progress bar");
 
-    // Send event to player
-    interface::CustomEvent event_seek = new_position > song_.curr_info.position
-                                            ? interface::CustomEvent::SeekForwardPosition(offset)
-                                            : interface::CustomEvent::SeekBackwardPosition(offset);
+    // Send event to player, which seeks exactly the clicked position (instead of a relative offset
+    // based on the last position received, that may be already outdated)
+    auto event_seek = interface::CustomEvent::SeekToPosition(new_position);
 
-    LOG("Sending event to ", event_seek.GetId(), " with offset=", offset);
+    LOG("Sending event to ", event_seek.GetId(), " with position=", new_position.count(), "ms");
     dispatcher->SendEvent(event_seek);
 
     // Set this block as active (focused)
@@ -0,0 +1,165 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+#include "audio/analysis_ring.h"
+#include "model/pcm_block.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+/**
+ * @brief Tests with AnalysisRing class
+ */
+class AnalysisRingTest : public ::testing::Test {
+ protected:
+  static constexpr int kChannels = 2;
+
+  //! Create interleaved frames with sequential values starting from offset (left channel holds
+  //! positive values and right channel negative ones)
+  static std::vector<int16_t> CreateFrames(int frames, int16_t offset = 0) {
+    std::vector<int16_t> data(frames * kChannels);
+    for (int i = 0; i < frames; i++) {
+      data[i * kChannels] = static_cast<int16_t>(offset + i);
+      data[i * kChannels + 1] = static_cast<int16_t>(-(offset + i));
+    }
+    return data;
+  }
+
+  //! Write all frames from buffer into ring
+  static void Write(audio::AnalysisRing& ring, const std::vector<int16_t>& data) {
+    ring.Write(model::PcmBlock{.data = data.data(), .frames = (int)data.size() / kChannels});
+  }
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(AnalysisRingTest, WriteAndReadWrappingAround) {
+  audio::AnalysisRing ring(8);
+  EXPECT_EQ(ring.Size(), 0);
+
+  Write(ring, CreateFrames(6));
+  EXPECT_EQ(ring.Size(), 6);
+
+  // Read only part of it, already split by channel
+  std::vector<float> left(4), right(4);
+  EXPECT_EQ(ring.Read(left.data(), right.data(), 4), 4);
+  EXPECT_THAT(left, ElementsAre(0, 1, 2, 3));
+  EXPECT_THAT(right, ElementsAre(0, -1, -2, -3));
+
+  // Now write more frames, this time wrapping around internal storage
+  Write(ring, CreateFrames(5, 100));
+  EXPECT_EQ(ring.Size(), 7);
+
+  left.resize(7);
+  right.resize(7);
+  EXPECT_EQ(ring.Read(left.data(), right.data(), 10), 7);
+  EXPECT_THAT(left, ElementsAre(4, 5, 100, 101, 102, 103, 104));
+  EXPECT_THAT(right, ElementsAre(-4, -5, -100, -101, -102, -103, -104));
+
+  EXPECT_EQ(ring.Size(), 0);
+  EXPECT_EQ(ring.Read(left.data(), right.data(), 1), 0);
+  EXPECT_EQ(ring.Dropped(), 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(AnalysisRingTest, OverwriteOldestFrames) {
+  audio::AnalysisRing ring(8);
+
+  // Ring is never full for producer, oldest frames are simply overwritten
+  Write(ring, CreateFrames(6));
+  Write(ring, CreateFrames(5, 100));
+
+  EXPECT_EQ(ring.Size(), 8);
+
+  std::vector<float> left(8), right(8);
+  EXPECT_EQ(ring.Read(left.data(), right.data(), 8), 8);
+  EXPECT_THAT(left, ElementsAre(3, 4, 5, 100, 101, 102, 103, 104));
+  EXPECT_EQ(ring.Dropped(), 3);
+
+  // Block bigger than ring keeps only its most recent frames
+  Write(ring, CreateFrames(10, 200));
+
+  EXPECT_EQ(ring.Read(left.data(), right.data(), 8), 8);
+  EXPECT_THAT(left, ElementsAre(202, 203, 204, 205, 206, 207, 208, 209));
+  EXPECT_EQ(ring.Dropped(), 5);
+
+  // Discard everything
+  Write(ring, CreateFrames(4));
+  ring.Clear();
+
+  EXPECT_EQ(ring.Size(), 0);
+  EXPECT_EQ(ring.Capacity(), 8);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(AnalysisRingTest, KeepOnlyMostRecentFrames) {
+  audio::AnalysisRing ring(8);
+
+  Write(ring, CreateFrames(6));
+  EXPECT_EQ(ring.Keep(2), 4);
+  EXPECT_EQ(ring.Size(), 2);
+
+  // Nothing to skip
+  EXPECT_EQ(ring.Keep(4), 0);
+
+  // Frames already overwritten are not skipped, but dropped
+  Write(ring, CreateFrames(8, 100));
+  EXPECT_EQ(ring.Keep(3), 5);
+  EXPECT_EQ(ring.Dropped(), 2);
+
+  std::vector<float> left(3), right(3);
+  EXPECT_EQ(ring.Read(left.data(), right.data(), 3), 3);
+  EXPECT_THAT(left, ElementsAre(105, 106, 107));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(AnalysisRingTest, ProducerAndConsumerOnDifferentThreads) {
+  constexpr int kTotalFrames = 30000;
+  constexpr int kChunk = 333;
+
+  audio::AnalysisRing ring(1024);
+  auto input = CreateFrames(kTotalFrames);
+
+  std::thread producer([&] {
+    for (int sent = 0; sent < kTotalFrames; sent += kChunk) {
+      int count = std::min(kChunk, kTotalFrames - sent);
+      ring.Write(model::PcmBlock{.data = &input[sent * kChannels], .frames = count});
+      std::this_thread::yield();
+    }
+  });
+
+  // Consumer may fall behind, but whatever it reads must be in order and never corrupted
+  std::vector<float> left(kChunk), right(kChunk);
+  int received = 0;
+  float last = -1;
+
+  while (last < kTotalFrames - 1) {
+    int count = ring.Read(left.data(), right.data(), kChunk);
+
+    for (int i = 0; i < count; i++) {
+      ASSERT_GT(left[i], last);
+      ASSERT_EQ(right[i], -left[i]);
+      last = left[i];
+    }
+
+    received += count;
+    std::this_thread::yield();
+  }
+
+  producer.join();
+
+  EXPECT_EQ(received + ring.Dropped(), kTotalFrames);
+}
+
+}  // namespace
@@ -0,0 +1,195 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "audio/command_queue.h"
+
+namespace {
+
+using audio::Command;
+using audio::CommandQueue;
+
+/* ********************************************************************************************** */
+
+TEST(CommandQueueTest, PushAndPopInOrder) {
+  CommandQueue queue(8);
+  EXPECT_FALSE(queue.Pending());
+
+  EXPECT_TRUE(queue.Push(Command::Play("Nujabes - Aruarian Dance")));
+  EXPECT_TRUE(queue.Push(Command::PauseOrResume()));
+  EXPECT_TRUE(queue.Push(Command::Stop()));
+  EXPECT_TRUE(queue.Pending());
+
+  Command cmd = queue.Pop();
+  EXPECT_EQ(cmd, Command::Identifier::Play);
+  EXPECT_EQ(cmd.GetContent<std::string>(), "Nujabes - Aruarian Dance");
+
+  EXPECT_EQ(queue.Pop(), Command::Identifier::PauseOrResume);
+  EXPECT_EQ(queue.Pop(), Command::Identifier::Stop);
+
+  EXPECT_FALSE(queue.Pending());
+  EXPECT_EQ(queue.Pop(), Command::Identifier::None);
+}
+
+/* ********************************************************************************************** */
+
+TEST(CommandQueueTest, RejectCommandWhenFull) {
+  CommandQueue queue(4);
+
+  for (int i = 0; i < 4; i++) EXPECT_TRUE(queue.Push(Command::Stop()));
+  EXPECT_FALSE(queue.Push(Command::Stop()));
+
+  // Release space and push again, this time wrapping around internal storage
+  queue.Pop();
+  EXPECT_TRUE(queue.Push(Command::PauseOrResume()));
+
+  for (int i = 0; i < 3; i++) EXPECT_EQ(queue.Pop(), Command::Identifier::Stop);
+  EXPECT_EQ(queue.Pop(), Command::Identifier::PauseOrResume);
+}
+
+/* ********************************************************************************************** */
+
+TEST(CommandQueueTest, MergeConsecutiveSeeks) {
+  CommandQueue queue(16);
+
+  queue.Push(Command::SeekForward(5));
+  queue.Push(Command::SeekForward(5));
+  queue.Push(Command::SeekBackward(2));
+  queue.Push(Command::PauseOrResume());
+  queue.Push(Command::SeekBackward(3));
+  queue.Push(Command::SeekBackward(4));
+
+  Command cmd = queue.Pop();
+  EXPECT_EQ(cmd, Command::Identifier::SeekForward);
+  EXPECT_EQ(cmd.GetContent<int>(), 8);
+
+  // Seeks are not merged across other commands
+  EXPECT_EQ(queue.Pop(), Command::Identifier::PauseOrResume);
+
+  cmd = queue.Pop();
+  EXPECT_EQ(cmd, Command::Identifier::SeekBackward);
+  EXPECT_EQ(cmd.GetContent<int>(), 7);
+
+  // Seeks cancelling each other should simply disappear
+  queue.Push(Command::SeekForward(1));
+  queue.Push(Command::SeekBackward(1));
+  queue.Push(Command::Stop());
+
+  EXPECT_EQ(queue.Pop(), Command::Identifier::Stop);
+  EXPECT_FALSE(queue.Pending());
+}
+
+/* ********************************************************************************************** */
+
+TEST(CommandQueueTest, MergeConsecutiveAbsoluteSeeks) {
+  CommandQueue queue(16);
+
+  queue.Push(Command::SeekTo(std::chrono::milliseconds(1500)));
+  queue.Push(Command::SeekTo(std::chrono::milliseconds(42250)));
+  queue.Push(Command::SeekForward(1));
+  queue.Push(Command::SeekTo(std::chrono::milliseconds(3000)));
+
+  Command cmd = queue.Pop();
+  EXPECT_EQ(cmd, Command::Identifier::SeekTo);
+  EXPECT_EQ(cmd.GetContent<std::chrono::milliseconds>(), std::chrono::milliseconds(42250));
+
+  // Relative seek is kept in between, as it depends on the previous position
+  EXPECT_EQ(queue.Pop(), Command::Identifier::SeekForward);
+
+  cmd = queue.Pop();
+  EXPECT_EQ(cmd, Command::Identifier::SeekTo);
+  EXPECT_EQ(cmd.GetContent<std::chrono::milliseconds>(), std::chrono::milliseconds(3000));
+
+  EXPECT_FALSE(queue.Pending());
+}
+
+/* ********************************************************************************************** */
+
+TEST(CommandQueueTest, KeepOnlyLatestVolumeAndFilters) {
+  CommandQueue queue(16);
+
+  auto filters = model::AudioFilter::Create();
+  filters[0].gain = 6;
+
+  queue.Push(Command::SetVolume({0.1f}));
+  queue.Push(Command::UpdateAudioFilters(model::AudioFilter::Create()));
+  queue.Push(Command::SetVolume({0.2f}));
+  queue.Push(Command::SeekForward(1));
+  queue.Push(Command::UpdateAudioFilters(filters));
+  queue.Push(Command::SetVolume({0.3f}));
+
+  EXPECT_EQ(queue.Pop(), Command::Identifier::SeekForward);
+
+  Command cmd = queue.Pop();
+  EXPECT_EQ(cmd, Command::Identifier::UpdateAudioFilters);
+  EXPECT_EQ(cmd.TakeContent<std::vector<model::AudioFilter>>(), filters);
+
+  cmd = queue.Pop();
+  EXPECT_EQ(cmd, Command::Identifier::SetVolume);
+  EXPECT_EQ(cmd.GetContent<model::Volume>(), model::Volume{0.3f});
+
+  EXPECT_EQ(queue.Pop(), Command::Identifier::None);
+}
+
+/* ********************************************************************************************** */
+
+TEST(CommandQueueTest, RetainOnlySomeCommands) {
+  CommandQueue queue(16);
+
+  queue.Push(Command::SeekForward(1));
+  queue.Push(Command::Play("Bonobo - Kerala"));
+  queue.Push(Command::SetVolume({0.5f}));
+  queue.Push(Command::SetNextSong("Bonobo - Cirrus"));
+
+  queue.Retain([](const Command& c) {
+    return c == Command::Identifier::Play || c == Command::Identifier::SetNextSong;
+  });
+
+  EXPECT_EQ(queue.Pop(), Command::Identifier::Play);
+  EXPECT_EQ(queue.Pop(), Command::Identifier::SetNextSong);
+  EXPECT_EQ(queue.Pop(), Command::Identifier::None);
+  EXPECT_FALSE(queue.Pending());
+}
+
+/* ********************************************************************************************** */
+
+TEST(CommandQueueTest, MultipleProducersOnDifferentThreads) {
+  constexpr int kProducers = 4;
+  constexpr int kCommands = 10000;
+
+  CommandQueue queue(64);
+  std::vector<std::thread> producers;
+
+  // Each producer sends a known amount of seek forward (merged by consumer into a larger offset)
+  for (int p = 0; p < kProducers; p++) {
+    producers.emplace_back([&] {
+      for (int i = 0; i < kCommands; i++) {
+        while (!queue.Push(Command::SeekForward(1))) std::this_thread::yield();
+      }
+    });
+  }
+
+  int total = 0;
+  while (total < kProducers * kCommands) {
+    if (!queue.Pending()) {
+      std::this_thread::yield();
+      continue;
+    }
+
+    Command cmd = queue.Pop();
+    if (cmd == Command::Identifier::SeekForward) total += cmd.GetContent<int>();
+  }
+
+  for (auto& producer : producers) producer.join();
+
+  EXPECT_EQ(total, kProducers * kCommands);
+  EXPECT_FALSE(queue.Pending());
+}
+
+}  // namespace
@@ -0,0 +1,219 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include "audio/decoder_pool.h"
+#include "mock/decoder_mock.h"
+#include "model/application_error.h"
+#include "util/logger.h"
+
+namespace {
+
+using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::Invoke;
+using ::testing::Return;
+
+/**
+ * @brief Tests with DecoderPool class
+ */
+class DecoderPoolTest : public ::testing::Test {
+ protected:
+  static constexpr size_t kOverhead = 100 * 1024;
+
+  //! Frames decoded in advance for each song (300ms using default format)
+  static constexpr int kPrerollFrames = 13230;
+
+  //! Estimated memory usage for each entry
+  static constexpr size_t kEntryCost = kOverhead + kPrerollFrames * 4;
+
+  static void SetUpTestSuite() { util::Logger::GetInstance().Configure(); }
+
+  void TearDown() override { pool.reset(); }
+
+  //! Create pool with worker thread running, where files named "invalid" cannot be opened
+  void Init(size_t budget) {
+    pool = std::make_unique<audio::DecoderPool>([this] { return CreateDecoder(); }, budget,
+                                                kOverhead);
+
+    pool->Start([](const model::Song&) { return model::AudioFormat{}; });
+  }
+
+  //! Create decoder emulating a song, where each read returns all requested frames
+  std::unique_ptr<driver::Decoder> CreateDecoder() {
+    auto decoder = std::make_unique<DecoderMock>();
+
+    EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(Invoke([](model::Song& song) {
+      if (song.filepath == "invalid") return error::kFileNotSupported;
+
+      song.sample_rate = 44100;
+      song.duration = 180;
+      return error::kSuccess;
+    }));
+
+    EXPECT_CALL(*decoder, SetOutputFormat(model::AudioFormat{})).Times(AnyNumber());
+
+    auto position = std::make_shared<int64_t>(0);
+    EXPECT_CALL(*decoder, Read(_, _, _))
+        .WillRepeatedly(Invoke([position](void*, int& frames, int64_t& pos) {
+          pos = *position;
+          *position += frames * 1000 / 44100;
+          return error::kSuccess;
+        }));
+
+    last_decoder = decoder.get();
+    return decoder;
+  }
+
+  //! Wait for worker thread to warm up all pending files
+  void WaitUntilIdle() { pool->WaitUntilIdle(); }
+
+  //! Finish worker thread, so entries are never refreshed in background
+  void StopWorker() {
+    {
+      std::scoped_lock<std::mutex> lock(pool->mutex_);
+      pool->exit_ = true;
+    }
+    pool->notifier_.notify_one();
+    pool->worker_.join();
+  }
+
+ protected:
+  std::unique_ptr<audio::DecoderPool> pool;  //!< Pool of decoders warmed up in background
+  DecoderMock* last_decoder = nullptr;       //!< Last decoder created by pool
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(DecoderPoolTest, WarmUpAndTakeEntry) {
+  Init(/* budget= */ 10 * kEntryCost);
+
+  pool->WarmUp({"first.mp3", "invalid", "second.mp3"});
+  WaitUntilIdle();
+
+  // File that could not be opened is simply skipped
+  EXPECT_EQ(pool->Size(), 2);
+  EXPECT_EQ(pool->GetUsage(), 2 * kEntryCost);
+
+  auto entry = pool->Take("second.mp3");
+  ASSERT_TRUE(entry.has_value());
+
+  EXPECT_EQ(entry->song.sample_rate, 44100);
+  EXPECT_EQ(entry->format, model::AudioFormat{});
+  EXPECT_EQ(entry->cost, kEntryCost);
+
+  // Preroll is decoded from the start of song, using chunks of 1024 frames
+  ASSERT_EQ(entry->preroll.size(), 13);
+  EXPECT_EQ(entry->preroll.front().position, 0);
+  EXPECT_EQ(entry->preroll.back().frames, kPrerollFrames - 12 * 1024);
+
+  int total = 0;
+  for (const auto& chunk : entry->preroll) total += chunk.frames;
+  EXPECT_EQ(total, kPrerollFrames);
+
+  // Entry is not in pool anymore
+  EXPECT_EQ(pool->Size(), 1);
+  EXPECT_EQ(pool->GetUsage(), kEntryCost);
+  EXPECT_FALSE(pool->Take("second.mp3").has_value());
+  EXPECT_FALSE(pool->Take("unknown.mp3").has_value());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DecoderPoolTest, EvictLeastRecentlyUsed) {
+  Init(/* budget= */ 2 * kEntryCost);
+
+  // Budget is not enough for all of them, so the one with lowest priority is evicted
+  pool->WarmUp({"first.mp3", "second.mp3", "third.mp3"});
+  WaitUntilIdle();
+
+  EXPECT_EQ(pool->Size(), 2);
+  EXPECT_EQ(pool->GetUsage(), 2 * kEntryCost);
+
+  // Third one is requested again, so now it is the second one that was used less recently
+  pool->WarmUp({"third.mp3"});
+  WaitUntilIdle();
+
+  EXPECT_EQ(pool->Size(), 2);
+  EXPECT_TRUE(pool->Take("first.mp3").has_value());
+  EXPECT_FALSE(pool->Take("second.mp3").has_value());
+  EXPECT_TRUE(pool->Take("third.mp3").has_value());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DecoderPoolTest, KeepNextSongAheadOfOthers) {
+  Init(/* budget= */ 2 * kEntryCost);
+
+  // Next song is reserved, so it is never evicted in favour of files from the file list
+  pool->WarmUpNext("next.mp3");
+  pool->WarmUp({"first.mp3", "second.mp3"});
+  WaitUntilIdle();
+
+  EXPECT_EQ(pool->Size(), 2);
+  EXPECT_FALSE(pool->Take("second.mp3", /* wait= */ false).has_value());
+  EXPECT_TRUE(pool->Take("next.mp3", /* wait= */ false).has_value());
+  EXPECT_TRUE(pool->Take("first.mp3", /* wait= */ false).has_value());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DecoderPoolTest, ChangeVolumeAfterWarmUp) {
+  Init(/* budget= */ 10 * kEntryCost);
+
+  pool->WarmUp({"first.mp3"});
+  WaitUntilIdle();
+
+  EXPECT_EQ(pool->GetUsage(), kEntryCost);
+
+  // Preroll was decoded using the old volume, so worker goes back to the start and decodes it again
+  model::Volume volume{0.5f};
+  EXPECT_CALL(*last_decoder, SetVolume(volume));
+  EXPECT_CALL(*last_decoder, Seek(0)).WillOnce(Return(error::kSuccess));
+
+  pool->SetVolume(volume);
+  WaitUntilIdle();
+
+  EXPECT_EQ(pool->Size(), 1);
+  EXPECT_EQ(pool->GetUsage(), kEntryCost);
+
+  auto entry = pool->Take("first.mp3");
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_EQ(entry->preroll.size(), 13);
+  EXPECT_EQ(entry->cost, kEntryCost);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DecoderPoolTest, ApplyVolumeOnTakeBeforeRefresh) {
+  Init(/* budget= */ 10 * kEntryCost);
+
+  pool->WarmUp({"first.mp3"});
+  WaitUntilIdle();
+
+  // Stop worker from refreshing entry, as if it was busy with some other file
+  StopWorker();
+
+  // Setting volume returns right away, without touching any decoder
+  model::Volume volume{0.5f};
+  EXPECT_CALL(*last_decoder, SetVolume(volume)).Times(0);
+  pool->SetVolume(volume);
+
+  // So it is applied to the entry taken, dropping samples decoded with the old volume
+  EXPECT_CALL(*last_decoder, SetVolume(volume));
+  EXPECT_CALL(*last_decoder, Seek(0)).WillOnce(Return(error::kSuccess));
+
+  auto entry = pool->Take("first.mp3");
+  ASSERT_TRUE(entry.has_value());
+  EXPECT_TRUE(entry->preroll.empty());
+  EXPECT_EQ(entry->cost, kOverhead);
+}
+
+}  // namespace
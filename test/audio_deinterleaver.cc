@@ -0,0 +1,123 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <cstdint>
+#include <vector>
+
+#include "audio/deinterleaver.h"
+#include "model/audio_format.h"
+#include "model/pcm_block.h"
+#include "util/logger.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+using ::testing::ElementsAreArray;
+
+/**
+ * @brief Tests with Deinterleaver class
+ */
+class DeinterleaverTest : public ::testing::Test {
+ protected:
+  using SampleFormat = model::AudioFormat::SampleFormat;
+
+  static void SetUpTestSuite() { util::Logger::GetInstance().Configure(); }
+
+  //! Convert samples using only the scalar implementation
+  static void ConvertScalar(audio::Deinterleaver& deinterleaver, const model::PcmBlock& block,
+                            float* left, float* right) {
+    deinterleaver.kernel_ = &audio::Deinterleaver::ConvertScalar;
+    deinterleaver.Process(block, left, right);
+  }
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(DeinterleaverTest, SplitStereoSamples) {
+  audio::Deinterleaver deinterleaver;
+
+  std::vector<int16_t> data{1, -1, 32767, -32768, 0, 100, -200, 300};
+  std::vector<float> left(4), right(4);
+
+  deinterleaver.Process(model::PcmBlock{.data = data.data(), .frames = 4}, left.data(),
+                        right.data());
+
+  EXPECT_THAT(left, ElementsAre(1, 32767, 0, -200));
+  EXPECT_THAT(right, ElementsAre(-1, -32768, 100, 300));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DeinterleaverTest, OptimizedImplementationMatchesScalar) {
+  audio::Deinterleaver optimized, scalar;
+
+  // Odd number of frames, to exercise both vectorized loop and remaining frames
+  constexpr int kFrames = 1027;
+
+  std::vector<int16_t> data(kFrames * 2);
+  for (size_t i = 0; i < data.size(); i++) {
+    data[i] = static_cast<int16_t>(i * 7919);
+  }
+
+  model::PcmBlock block{.data = data.data(), .frames = kFrames};
+
+  std::vector<float> left(kFrames), right(kFrames);
+  std::vector<float> expected_left(kFrames), expected_right(kFrames);
+
+  optimized.Process(block, left.data(), right.data());
+  ConvertScalar(scalar, block, expected_left.data(), expected_right.data());
+
+  EXPECT_THAT(left, ElementsAreArray(expected_left));
+  EXPECT_THAT(right, ElementsAreArray(expected_right));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(DeinterleaverTest, ConvertOtherFormats) {
+  audio::Deinterleaver deinterleaver;
+  std::vector<float> left(2), right(2);
+
+  // Signed 32-bit is scaled down to signed 16-bit range
+  std::vector<int32_t> s32{65536, -131072, 2147418112, 0};
+  model::AudioFormat format{.sample_format = SampleFormat::S32};
+
+  deinterleaver.Process(model::PcmBlock{.data = s32.data(), .format = format, .frames = 2},
+                        left.data(), right.data());
+
+  EXPECT_THAT(left, ElementsAre(1, 32767));
+  EXPECT_THAT(right, ElementsAre(-2, 0));
+
+  // Float is scaled up to signed 16-bit range
+  std::vector<float> f32{0.5f, -0.25f, -1.0f, 0.0f};
+  format = model::AudioFormat{.sample_format = SampleFormat::Float};
+
+  deinterleaver.Process(model::PcmBlock{.data = f32.data(), .format = format, .frames = 2},
+                        left.data(), right.data());
+
+  EXPECT_THAT(left, ElementsAre(16384, -32768));
+  EXPECT_THAT(right, ElementsAre(-8192, 0));
+
+  // Mono is copied to both channels
+  std::vector<int16_t> mono{10, -20};
+  format = model::AudioFormat{.channels = 1};
+
+  deinterleaver.Process(model::PcmBlock{.data = mono.data(), .format = format, .frames = 2},
+                        left.data(), right.data());
+
+  EXPECT_THAT(left, ElementsAre(10, -20));
+  EXPECT_THAT(right, ElementsAre(10, -20));
+
+  // Only first two channels are taken from multichannel audio
+  std::vector<int16_t> surround{1, 2, 3, 4, 5, 6, 7, 8, 9, 10, 11, 12};
+  format = model::AudioFormat{.channels = 6};
+
+  deinterleaver.Process(model::PcmBlock{.data = surround.data(), .format = format, .frames = 2},
+                        left.data(), right.data());
+
+  EXPECT_THAT(left, ElementsAre(1, 7));
+  EXPECT_THAT(right, ElementsAre(2, 8));
+}
+
+}  // namespace
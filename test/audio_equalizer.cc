@@ -0,0 +1,216 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include "audio/equalizer.h"
+#include "model/audio_filter.h"
+#include "util/logger.h"
+
+namespace {
+
+using ::testing::ElementsAreArray;
+
+/**
+ * @brief Tests with Equalizer class
+ */
+class EqualizerTest : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() { util::Logger::GetInstance().Configure(); }
+
+  static constexpr int kSampleRate = 44100;
+  static constexpr int kFrames = 4096;
+
+  //! Create interleaved stereo sine wave (right channel with half amplitude from left one)
+  static std::vector<int16_t> CreateSine(double frequency, double amplitude, int frames = kFrames) {
+    std::vector<int16_t> data(frames * 2);
+    for (int i = 0; i < frames; i++) {
+      double value = amplitude * std::sin(2 * M_PI * frequency * i / kSampleRate);
+      data[2 * i] = static_cast<int16_t>(std::lrint(value));
+      data[2 * i + 1] = static_cast<int16_t>(std::lrint(value / 2));
+    }
+    return data;
+  }
+
+  //! Get peak value from channel, ignoring the beginning of buffer (filter transient)
+  static int Peak(const std::vector<int16_t>& data, int channel) {
+    int peak = 0;
+    for (size_t i = data.size() / 2 + channel; i < data.size(); i += 2) {
+      peak = std::max(peak, std::abs(static_cast<int>(data[i])));
+    }
+    return peak;
+  }
+
+  //! Get pointers to buffers owned by reader (which must never be reallocated)
+  static std::pair<const void*, const void*> GetBuffers(const audio::Equalizer& equalizer) {
+    return {equalizer.state_.data(), equalizer.data_.data()};
+  }
+
+  //! Process samples using only the scalar implementation
+  static void ProcessScalar(audio::Equalizer& equalizer, std::vector<int16_t>& data) {
+    equalizer.kernel_ = &audio::Equalizer::ProcessScalar;
+    equalizer.Process(data.data(), data.size() / 2);
+  }
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(EqualizerTest, FlatFiltersKeepSamplesUntouched) {
+  audio::Equalizer equalizer;
+  equalizer.SetFilters(model::AudioFilter::Create());
+
+  auto input = CreateSine(440, 10000);
+  auto output = input;
+  equalizer.Process(output.data(), kFrames);
+
+  EXPECT_THAT(output, ElementsAreArray(input));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(EqualizerTest, BoostAndCutCenterFrequency) {
+  audio::Equalizer equalizer;
+
+  // +6dB at 1kHz, which means amplitude twice as big
+  equalizer.SetFilters({model::AudioFilter{.frequency = 1000, .gain = 6}});
+
+  auto boosted = CreateSine(1000, 5000);
+  equalizer.Process(boosted.data(), kFrames);
+
+  EXPECT_NEAR(Peak(boosted, 0), 9976, 50);
+  EXPECT_NEAR(Peak(boosted, 1), 4988, 50);
+
+  // -6dB at 1kHz, which means amplitude half as big
+  equalizer.SetFilters({model::AudioFilter{.frequency = 1000, .gain = -6}});
+  equalizer.Reset();
+
+  auto cut = CreateSine(1000, 5000);
+  equalizer.Process(cut.data(), kFrames);
+
+  EXPECT_NEAR(Peak(cut, 0), 2506, 50);
+  EXPECT_NEAR(Peak(cut, 1), 1253, 50);
+
+  // Far from center frequency, nothing should change
+  auto far = CreateSine(100, 5000);
+  equalizer.Process(far.data(), kFrames);
+
+  EXPECT_NEAR(Peak(far, 0), 5000, 100);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(EqualizerTest, SaturateInsteadOfWrapAround) {
+  audio::Equalizer equalizer;
+  equalizer.SetFilters({model::AudioFilter{.frequency = 1000, .gain = 12}});
+
+  auto data = CreateSine(1000, 30000);
+  equalizer.Process(data.data(), kFrames);
+
+  EXPECT_EQ(Peak(data, 0), 32768);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(EqualizerTest, OptimizedImplementationMatchesScalar) {
+  // Odd number of bands, to exercise both paired and single band processing
+  std::vector<model::AudioFilter> filters = model::AudioFilter::Create();
+  filters.push_back(model::AudioFilter{.frequency = 12000, .Q = 0.7});
+
+  for (size_t i = 0; i < filters.size(); i++) {
+    filters[i].gain = (i % 2 ? -1.0 : 1.0) * static_cast<double>(i + 1);
+  }
+
+  audio::Equalizer optimized, scalar;
+  optimized.SetFilters(filters);
+  scalar.SetFilters(filters);
+
+  // Process in multiple chunks with different sizes, state must be kept between them
+  auto input = CreateSine(3000, 8000);
+  for (int chunk : {1, 7, 512, 1024}) {
+    std::vector<int16_t> expected(input.begin(), input.begin() + chunk * 2);
+    std::vector<int16_t> result = expected;
+
+    ProcessScalar(scalar, expected);
+    optimized.Process(result.data(), chunk);
+
+    for (size_t i = 0; i < expected.size(); i++) {
+      EXPECT_NEAR(result[i], expected[i], 1) << "at sample " << i << " from chunk " << chunk;
+    }
+  }
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(EqualizerTest, UpdateGainWithoutResettingState) {
+  audio::Equalizer equalizer;
+  auto filters = model::AudioFilter::Create();
+  equalizer.SetFilters(filters);
+
+  auto data = CreateSine(250, 5000);
+  equalizer.Process(data.data(), kFrames);
+
+  // Update many times before processing again, only the latest one should be used
+  for (int gain = 1; gain <= 6; gain++) {
+    filters[3].gain = gain;
+    equalizer.SetFilters(filters);
+  }
+
+  data = CreateSine(250, 5000);
+  equalizer.Process(data.data(), kFrames);
+
+  EXPECT_NEAR(Peak(data, 0), 9976, 50);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(EqualizerTest, ProcessLongBufferWithoutAllocating) {
+  audio::Equalizer whole, split;
+  auto buffers = GetBuffers(whole);
+
+  whole.SetFilters({model::AudioFilter{.frequency = 1000, .gain = 6}});
+  split.SetFilters({model::AudioFilter{.frequency = 1000, .gain = 6}});
+
+  // Long buffer is processed in blocks, with the same result as processing it in small pieces
+  constexpr int kLong = 4 * kFrames + 100;
+  auto expected = CreateSine(1000, 5000, kLong);
+  auto data = expected;
+
+  whole.Process(data.data(), kLong);
+
+  for (int offset = 0; offset < kLong; offset += 300) {
+    int frames = std::min(300, kLong - offset);
+    split.Process(expected.data() + offset * 2, frames);
+  }
+
+  EXPECT_THAT(data, ElementsAreArray(expected));
+
+  // Changing the number of bands resets filter state, but reuses the same buffers
+  whole.SetFilters(model::AudioFilter::Create());
+  whole.Process(data.data(), kLong);
+
+  EXPECT_EQ(GetBuffers(whole), buffers);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(EqualizerTest, ApplyEveryBandUpToMaximum) {
+  audio::Equalizer equalizer;
+
+  // Only the last band (out of 64) changes gain, so it must not be ignored
+  std::vector<model::AudioFilter> filters(63, model::AudioFilter{.frequency = 100});
+  filters.push_back(model::AudioFilter{.frequency = 1000, .gain = 6});
+  equalizer.SetFilters(filters);
+
+  auto data = CreateSine(1000, 5000);
+  equalizer.Process(data.data(), kFrames);
+
+  EXPECT_NEAR(Peak(data, 0), 9976, 50);
+}
+
+}  // namespace
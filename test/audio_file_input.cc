@@ -0,0 +1,152 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <cstdint>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+#include "audio/file_input.h"
+
+namespace {
+
+using ::testing::ElementsAreArray;
+
+/**
+ * @brief Tests with FileInput class
+ */
+class FileInputTest : public ::testing::Test {
+ protected:
+  static constexpr int kFileSize = 300 * 1024;
+  static constexpr uint32_t kReadAhead = 64 * 1024;
+  static constexpr int kChunkSize = 4 * 1024;
+
+  void SetUp() override {
+    content_.resize(kFileSize);
+    for (int i = 0; i < kFileSize; i++) content_[i] = static_cast<uint8_t>(i * 7 % 251);
+
+    std::ofstream file(filepath_, std::ios::binary);
+    file.write(reinterpret_cast<const char*>(content_.data()), kFileSize);
+  }
+
+  void TearDown() override { std::remove(filepath_.c_str()); }
+
+  //! Read whole file in small chunks (just like demuxer does)
+  static std::vector<uint8_t> ReadAll(audio::FileInput& input, int& reads) {
+    std::vector<uint8_t> result;
+    std::vector<uint8_t> chunk(kChunkSize);
+
+    for (int bytes; (bytes = input.Read(chunk.data(), kChunkSize)) > 0; reads++) {
+      result.insert(result.end(), chunk.begin(), chunk.begin() + bytes);
+    }
+
+    return result;
+  }
+
+  const std::string filepath_ = ::testing::TempDir() + "spectrum_file_input.bin";
+  std::vector<uint8_t> content_;
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(FileInputTest, ReadWholeFileUsingStream) {
+  audio::FileInput input(model::InputSettings{
+      .access = model::InputSettings::Access::Stream,
+      .read_ahead = kReadAhead,
+  });
+
+  ASSERT_TRUE(input.Open(filepath_));
+  EXPECT_EQ(input.GetSize(), kFileSize);
+
+  int reads = 0;
+  EXPECT_THAT(ReadAll(input, reads), ElementsAreArray(content_));
+  EXPECT_EQ(reads, kFileSize / kChunkSize);
+
+  // Open, fstat and fadvise(SEQUENTIAL) + one pread for each 64KiB (five in total), followed by
+  // fadvise(WILLNEED) for the next one (except for the last)
+  const auto& statistics = input.GetStatistics();
+  EXPECT_EQ(statistics.bytes_read, kFileSize);
+  EXPECT_EQ(statistics.syscalls, 12);
+
+  input.Close();
+  EXPECT_FALSE(input.IsOpen());
+  EXPECT_EQ(statistics.syscalls, 13);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FileInputTest, ReadWholeFileUsingMmap) {
+  audio::FileInput input(model::InputSettings{.access = model::InputSettings::Access::Mmap});
+
+  ASSERT_TRUE(input.Open(filepath_));
+  EXPECT_EQ(input.GetSize(), kFileSize);
+
+  // Open, fstat, mmap, close and madvise(SEQUENTIAL)
+  const auto& statistics = input.GetStatistics();
+  EXPECT_EQ(statistics.syscalls, 5);
+
+  // And reading from memory does not need any other syscall
+  int reads = 0;
+  EXPECT_THAT(ReadAll(input, reads), ElementsAreArray(content_));
+  EXPECT_EQ(statistics.bytes_read, kFileSize);
+  EXPECT_EQ(statistics.syscalls, 5);
+
+  input.Close();
+  EXPECT_EQ(statistics.syscalls, 6);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FileInputTest, SeekInsideAndOutsideReadAheadBuffer) {
+  audio::FileInput input(model::InputSettings{
+      .access = model::InputSettings::Access::Stream,
+      .read_ahead = kReadAhead,
+  });
+
+  ASSERT_TRUE(input.Open(filepath_));
+
+  std::vector<uint8_t> chunk(kChunkSize);
+  EXPECT_EQ(input.Read(chunk.data(), kChunkSize), kChunkSize);
+
+  const auto& statistics = input.GetStatistics();
+  EXPECT_EQ(statistics.syscalls, 5);
+
+  // Going back to some content already in read-ahead buffer does not need any syscall
+  EXPECT_EQ(input.Seek(100, SEEK_SET), 100);
+  EXPECT_EQ(input.Read(chunk.data(), 100), 100);
+  EXPECT_THAT(std::vector<uint8_t>(chunk.begin(), chunk.begin() + 100),
+              ElementsAreArray(content_.begin() + 100, content_.begin() + 200));
+  EXPECT_EQ(statistics.syscalls, 5);
+
+  // But jumping to the end of file needs to read it again (and there is nothing else to prefetch)
+  EXPECT_EQ(input.Seek(-1000, SEEK_END), kFileSize - 1000);
+  EXPECT_EQ(input.Read(chunk.data(), kChunkSize), 1000);
+  EXPECT_THAT(std::vector<uint8_t>(chunk.begin(), chunk.begin() + 1000),
+              ElementsAreArray(content_.end() - 1000, content_.end()));
+  EXPECT_EQ(statistics.syscalls, 6);
+
+  EXPECT_EQ(input.Seek(0, SEEK_CUR), kFileSize);
+  EXPECT_EQ(input.Read(chunk.data(), kChunkSize), 0);
+
+  // Invalid offset
+  EXPECT_EQ(input.Seek(-1, SEEK_SET), -1);
+  EXPECT_EQ(input.Seek(0, SEEK_CUR), kFileSize);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FileInputTest, OpenMissingFile) {
+  audio::FileInput input;
+
+  EXPECT_FALSE(input.Open(::testing::TempDir() + "spectrum_missing_file.bin"));
+  EXPECT_FALSE(input.IsOpen());
+
+  std::vector<uint8_t> chunk(kChunkSize);
+  EXPECT_EQ(input.Read(chunk.data(), kChunkSize), -1);
+  EXPECT_EQ(input.Seek(0, SEEK_SET), -1);
+}
+
+}  // namespace
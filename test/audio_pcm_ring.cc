@@ -0,0 +1,122 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gmock/gmock.h>
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <chrono>
+#include <cstdint>
+#include <numeric>
+#include <thread>
+#include <vector>
+
+#include "audio/pcm_ring.h"
+
+namespace {
+
+using ::testing::ElementsAreArray;
+
+/**
+ * @brief Tests with PcmRing class
+ */
+class PcmRingTest : public ::testing::Test {
+ protected:
+  static constexpr int kChannels = 2;
+  static constexpr int kFrameSize = kChannels * sizeof(int16_t);
+
+  //! Create buffer with interleaved frames, filled with sequential values starting from offset
+  static std::vector<int16_t> CreateFrames(int frames, int16_t offset = 0) {
+    std::vector<int16_t> data(frames * kChannels);
+    std::iota(data.begin(), data.end(), offset);
+    return data;
+  }
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(PcmRingTest, CalculateCapacityFromDuration) {
+  using namespace std::chrono_literals;
+
+  EXPECT_EQ(audio::PcmRing::FramesFor(500ms, 44100), 22050);
+  EXPECT_EQ(audio::PcmRing::FramesFor(1000ms, 48000), 48000);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PcmRingTest, WriteUntilFullAndReadWrappingAround) {
+  audio::PcmRing ring(8, kFrameSize);
+  EXPECT_TRUE(ring.Empty());
+
+  // Only part of it should fit into ring
+  auto input = CreateFrames(10);
+  EXPECT_EQ(ring.Write(input.data(), 10), 8);
+  EXPECT_TRUE(ring.Full());
+  EXPECT_EQ(ring.Write(input.data(), 10), 0);
+
+  // Consume some frames to release space
+  std::vector<int16_t> output(6 * kChannels);
+  EXPECT_EQ(ring.Read(output.data(), 6), 6);
+  EXPECT_THAT(output, ElementsAreArray(input.data(), 6 * kChannels));
+  EXPECT_EQ(ring.Size(), 2);
+
+  // Now write more frames, this time wrapping around internal storage
+  auto more = CreateFrames(5, 100);
+  EXPECT_EQ(ring.Write(more.data(), 5), 5);
+  EXPECT_EQ(ring.Size(), 7);
+
+  std::vector<int16_t> expected(input.begin() + 6 * kChannels, input.begin() + 8 * kChannels);
+  expected.insert(expected.end(), more.begin(), more.end());
+
+  output.resize(7 * kChannels);
+  EXPECT_EQ(ring.Read(output.data(), 10), 7);
+  EXPECT_THAT(output, ElementsAreArray(expected));
+  EXPECT_TRUE(ring.Empty());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PcmRingTest, ClearDiscardAllFrames) {
+  audio::PcmRing ring(16, kFrameSize);
+
+  auto input = CreateFrames(12);
+  ring.Write(input.data(), 12);
+  ring.Clear();
+
+  EXPECT_TRUE(ring.Empty());
+  EXPECT_EQ(ring.Capacity(), 16);
+
+  std::vector<int16_t> output(kChannels);
+  EXPECT_EQ(ring.Read(output.data(), 1), 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PcmRingTest, ProducerAndConsumerOnDifferentThreads) {
+  constexpr int kTotalFrames = 100000;
+  constexpr int kChunk = 333;
+
+  audio::PcmRing ring(1024, kFrameSize);
+  auto input = CreateFrames(kTotalFrames);
+  std::vector<int16_t> output(input.size());
+
+  std::thread producer([&] {
+    int sent = 0;
+    while (sent < kTotalFrames) {
+      int count = std::min(kChunk, kTotalFrames - sent);
+      sent += ring.Write(&input[sent * kChannels], count);
+      std::this_thread::yield();
+    }
+  });
+
+  int received = 0;
+  while (received < kTotalFrames) {
+    received += ring.Read(&output[received * kChannels], kChunk);
+    std::this_thread::yield();
+  }
+
+  producer.join();
+
+  EXPECT_EQ(output, input);
+  EXPECT_TRUE(ring.Empty());
+}
+
+}  // namespace
@@ -4,7 +4,9 @@
 #include <gtest/gtest-test-part.h>  // for TestPartResult
 
 #include <chrono>
+#include <cstring>
 #include <memory>
+#include <numeric>
 #include <thread>
 
 #include "audio/player.h"
@@ -18,15 +20,46 @@
 namespace {
 
 using ::testing::_;
+using ::testing::AnyNumber;
+using ::testing::AtLeast;
 using ::testing::AtMost;
+using ::testing::DoAll;
 using ::testing::Eq;
 using ::testing::Field;
 using ::testing::InSequence;
 using ::testing::Invoke;
+using ::testing::InvokeWithoutArgs;
 using ::testing::Return;
 
 using testing::TestSyncer;
 
+/**
+ * @brief Emulate decoder reading a single chunk of frames (content is not relevant for these tests)
+ * @param position Position in song (in milliseconds) from the first frame in chunk
+ */
+ACTION_P(ReadChunk, position) {
+  arg1 = 1;
+  arg2 = position;
+  return error::kSuccess;
+}
+
+/**
+ * @brief Emulate decoder reading all requested frames at once
+ * @param position Position in song (in milliseconds) from the first frame
+ */
+ACTION_P(ReadChunks, position) {
+  arg2 = position;
+  return error::kSuccess;
+}
+
+/**
+ * @brief Emulate decoder reaching the end of song
+ */
+ACTION(ReadEndOfSong) {
+  arg1 = 0;
+  return error::kSuccess;
+}
+
 /**
  * @brief Tests with Player class
  */
@@ -45,23 +78,27 @@ class PlayerTest : public ::testing::Test {
     notifier.reset();
   }
 
-  void Init(bool asynchronous = false) {
+  void Init(bool asynchronous = false, audio::DecoderPool* warm_up = nullptr) {
     // Create mocks
     PlaybackMock* pb_mock = new PlaybackMock();
     DecoderMock* dc_mock = new DecoderMock();
+    DecoderMock* next_dc_mock = new DecoderMock();
 
     // Setup init expectations
     InSequence seq;
 
     EXPECT_CALL(*pb_mock, CreatePlaybackStream());
-    EXPECT_CALL(*pb_mock, ConfigureParameters());
+    EXPECT_CALL(*pb_mock, GetCapabilities());
+    EXPECT_CALL(*pb_mock, ConfigureParameters(model::AudioFormat{}));
     EXPECT_CALL(*pb_mock, GetPeriodSize());
+    EXPECT_CALL(*pb_mock, GetSettings());
 
     // Create Player without thread
-    audio_player = audio::Player::Create(pb_mock, dc_mock, asynchronous);
+    audio_player = audio::Player::Create(pb_mock, dc_mock, asynchronous, next_dc_mock, warm_up);
 
     // Register interface notifier to Audio Player
     notifier = std::make_shared<InterfaceNotifierMock>();
+    EXPECT_CALL(*notifier, NotifyPlaybackSettings(_));
     audio_player->RegisterInterfaceNotifier(notifier);
   }
 
@@ -75,12 +112,28 @@ class PlayerTest : public ::testing::Test {
     return reinterpret_cast<DecoderMock*>(audio_player->decoder_.get());
   }
 
+  //! Getter for spare Decoder (used to pre-open next song)
+  auto GetNextDecoder() -> DecoderMock* {
+    return reinterpret_cast<DecoderMock*>(audio_player->next_decoder_.get());
+  }
+
+  //! Setter for formats supported by Playback (usually discovered during Player initialization)
+  void SetCapabilities(const driver::Playback::Capabilities& capabilities) {
+    audio_player->capabilities_ = capabilities;
+  }
+
+  //! Getter for audio format currently used by Player
+  auto GetAudioFormat() -> model::AudioFormat { return audio_player->format_; }
+
   //! Getter for Public API for Player media control
   auto GetAudioControl() -> std::shared_ptr<audio::AudioControl> { return audio_player; }
 
   //! Run audio loop (same one executed as a thread in the real-life)
   void RunAudioLoop() { audio_player->AudioHandler(); }
 
+  //! Wait for decoders to be warmed up in background
+  void WaitForWarmUp() { audio_player->warm_up_->WaitUntilIdle(); }
+
  protected:
   Player audio_player;    //!< Audio player responsible for playing songs
   NotifierMock notifier;  //!< API for audio player to send interface events
@@ -100,6 +153,289 @@ TEST_F(PlayerTestThread, CreateDummyPlayer) {
 
 /* ********************************************************************************************** */
 
+TEST_F(PlayerTestThread, DecodeAheadAndWriteFromAnotherThread) {
+  auto playback = GetPlayback();
+  auto decoder = GetDecoder();
+  TestSyncer syncer;
+
+  // Fill decoded samples with some known pattern
+  constexpr int kChunks = 8;
+  constexpr int kFrames = 512;
+  std::vector<int16_t> decoded(kChunks * kFrames * 2);
+  std::iota(decoded.begin(), decoded.end(), 0);
+
+  std::vector<int16_t> written;
+
+  // Setup all expectations
+  EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(Return(error::kSuccess));
+  EXPECT_CALL(*notifier, NotifySongInformation(_));
+  EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+
+  // Player decides how many frames to read each time (usually, a whole period)
+  int read = 0;
+  EXPECT_CALL(*decoder, Read(_, _, _))
+      .WillRepeatedly(Invoke([&](void* buffer, int& frames, int64_t& position) {
+        frames = std::min(frames, kChunks * kFrames - read);
+        std::memcpy(buffer, &decoded[read * 2], frames * 2 * sizeof(int16_t));
+        read += frames;
+        position = 0;
+        return error::kSuccess;
+      }));
+
+  EXPECT_CALL(*notifier, NotifySongState(_));
+
+  // Samples are sent to audio analysis by writer thread, as soon as playback reports them as heard
+  int analyzed = 0;
+  EXPECT_CALL(*playback, GetDelay()).WillRepeatedly(Return(0));
+  EXPECT_CALL(*notifier, SendAudioRaw(_)).WillRepeatedly(Invoke([&](const model::PcmBlock& block) {
+    analyzed += block.frames;
+  }));
+
+  // Samples are written into playback by writer thread, not by the one decoding them
+  EXPECT_CALL(*playback, BeginDirectWrite(_)).WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(*playback, AudioCallback(_, _))
+      .WillRepeatedly(Invoke([&](void* buffer, int size) {
+        auto data = static_cast<int16_t*>(buffer);
+        written.insert(written.end(), data, data + size * 2);
+        return error::kSuccess;
+      }));
+
+  // Song ended naturally, so playback must finish playing remaining samples
+  EXPECT_CALL(*playback, Drain());
+
+  // Song must be cleared only after writer has consumed all decoded samples
+  EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+    syncer.NotifyStep(1);
+  }));
+
+  audio_player->Play("Tame Impala - The Less I Know the Better");
+  syncer.WaitForStep(1);
+
+  EXPECT_EQ(written, decoded);
+  EXPECT_EQ(analyzed, kChunks * kFrames);
+
+  auto status = audio_player->GetBufferStatus();
+  EXPECT_GT(status.capacity, 0);
+  EXPECT_EQ(status.filled, 0);
+
+  audio_player->Exit();
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTestThread, WriteDirectlyIntoPlaybackBuffer) {
+  auto playback = GetPlayback();
+  auto decoder = GetDecoder();
+  TestSyncer syncer;
+
+  // Fill decoded samples with some known pattern
+  constexpr int kChunks = 8;
+  constexpr int kFrames = 512;
+  std::vector<int16_t> decoded(kChunks * kFrames * 2);
+  std::iota(decoded.begin(), decoded.end(), 0);
+
+  // Emulate memory-mapped buffer from playback, where only a few frames are contiguous
+  constexpr int kContiguous = 300;
+  std::vector<int16_t> device(decoded.size());
+  int committed = 0;
+
+  // Setup all expectations
+  EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(Return(error::kSuccess));
+  EXPECT_CALL(*notifier, NotifySongInformation(_));
+  EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+
+  // Player decides how many frames to read each time (usually, a whole period)
+  int read = 0;
+  EXPECT_CALL(*decoder, Read(_, _, _))
+      .WillRepeatedly(Invoke([&](void* buffer, int& frames, int64_t& position) {
+        frames = std::min(frames, kChunks * kFrames - read);
+        std::memcpy(buffer, &decoded[read * 2], frames * 2 * sizeof(int16_t));
+        read += frames;
+        position = 0;
+        return error::kSuccess;
+      }));
+
+  EXPECT_CALL(*notifier, NotifySongState(_));
+
+  // Samples are sent to audio analysis by writer thread, as soon as playback reports them as heard
+  int analyzed = 0;
+  EXPECT_CALL(*playback, GetDelay()).WillRepeatedly(Return(0));
+  EXPECT_CALL(*notifier, SendAudioRaw(_)).WillRepeatedly(Invoke([&](const model::PcmBlock& block) {
+    analyzed += block.frames;
+  }));
+
+  // Samples must be copied from decode-ahead buffer straight into playback buffer
+  EXPECT_CALL(*playback, BeginDirectWrite(_)).WillRepeatedly(Invoke([&](int& frames) -> void* {
+    frames = std::min(frames, kContiguous);
+    return &device[committed * 2];
+  }));
+
+  EXPECT_CALL(*playback, CommitDirectWrite(_)).WillRepeatedly(Invoke([&](int frames) {
+    committed += frames;
+    return error::kSuccess;
+  }));
+
+  EXPECT_CALL(*playback, AudioCallback(_, _)).Times(0);
+  EXPECT_CALL(*playback, Drain());
+
+  // Song must be cleared only after writer has consumed all decoded samples
+  EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+    syncer.NotifyStep(1);
+  }));
+
+  audio_player->Play("Khruangbin - Maria También");
+  syncer.WaitForStep(1);
+
+  EXPECT_EQ(committed, kChunks * kFrames);
+  EXPECT_EQ(device, decoded);
+  EXPECT_EQ(analyzed, kChunks * kFrames);
+
+  audio_player->Exit();
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTestThread, DelayAudioAnalysisUntilSamplesAreHeard) {
+  auto playback = GetPlayback();
+  auto decoder = GetDecoder();
+  TestSyncer syncer;
+
+  // Player reads a full period each time, so writer always writes a full period (1024 frames by
+  // default)
+  constexpr int kFrames = 4096;
+  std::vector<int16_t> decoded(kFrames * 2);
+  std::iota(decoded.begin(), decoded.end(), 0);
+
+  // Emulate playback stream where the last two periods written are always queued (not heard yet)
+  constexpr int kLatency = 2048;
+  std::vector<int16_t> analyzed;
+
+  // Setup all expectations
+  EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(Return(error::kSuccess));
+  EXPECT_CALL(*notifier, NotifySongInformation(_));
+  EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+
+  int read = 0;
+  EXPECT_CALL(*decoder, Read(_, _, _))
+      .WillRepeatedly(Invoke([&](void* buffer, int& frames, int64_t& position) {
+        frames = std::min(frames, kFrames - read);
+        std::memcpy(buffer, &decoded[read * 2], frames * 2 * sizeof(int16_t));
+        read += frames;
+        position = 0;
+        return error::kSuccess;
+      }));
+
+  EXPECT_CALL(*notifier, NotifySongState(_));
+
+  EXPECT_CALL(*playback, BeginDirectWrite(_)).WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(*playback, AudioCallback(_, _)).Times(4).WillRepeatedly(Return(error::kSuccess));
+  EXPECT_CALL(*playback, GetDelay()).WillRepeatedly(Return(kLatency));
+  EXPECT_CALL(*playback, Drain());
+
+  EXPECT_CALL(*notifier, SendAudioRaw(_)).WillRepeatedly(Invoke([&](const model::PcmBlock& block) {
+    auto data = static_cast<const int16_t*>(block.data);
+    analyzed.insert(analyzed.end(), data, data + block.frames * 2);
+  }));
+
+  EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+    syncer.NotifyStep(1);
+  }));
+
+  audio_player->Play("Boards of Canada - Roygbiv");
+  syncer.WaitForStep(1);
+
+  // Only the first half was heard, the remaining samples were still queued in playback stream
+  std::vector<int16_t> expected(decoded.begin(), decoded.begin() + (kFrames - kLatency) * 2);
+  EXPECT_EQ(analyzed, expected);
+
+  audio_player->Exit();
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTestThread, SwitchTrackWithoutWaitingForPlaybackToDrain) {
+  auto playback = GetPlayback();
+  auto decoder = GetDecoder();
+  TestSyncer syncer;
+
+  // Emulate a device where each write blocks for a whole period, and draining waits for the whole
+  // buffer to be played (values are similar to the ones from balanced latency profile)
+  static constexpr auto kPeriodTime = std::chrono::milliseconds(10);
+  static constexpr auto kBufferTime = std::chrono::milliseconds(500);
+
+  // Maximum time expected between asking for a new song and opening it
+  static constexpr auto kTrackSwitchLatency = std::chrono::milliseconds(50);
+
+  constexpr int kFrames = 512;
+  int reads = 0;
+
+  std::chrono::steady_clock::time_point switched;
+
+  // Keep decoding until player receives some command to stop current song
+  auto read = [&](void* buffer, int& frames, int64_t& position) {
+    // Notify only when first song starts playing (i.e. first chunk was already handled)
+    if (++reads == 2) syncer.NotifyStep(1);
+
+    frames = std::min(frames, kFrames);
+    std::memset(buffer, 0, frames * 2 * sizeof(int16_t));
+    position = 0;
+    return error::kSuccess;
+  };
+
+  // Setup all expectations
+  EXPECT_CALL(*decoder, OpenFile(Field(&model::Song::filepath, "Air - La Femme d'Argent")))
+      .WillOnce(Return(error::kSuccess));
+
+  EXPECT_CALL(*decoder, OpenFile(Field(&model::Song::filepath, "Air - Sexy Boy")))
+      .WillOnce(Invoke([&](model::Song& audio_info) {
+        switched = std::chrono::steady_clock::now();
+        syncer.NotifyStep(2);
+        return error::kSuccess;
+      }));
+
+  EXPECT_CALL(*decoder, Read(_, _, _)).WillRepeatedly(Invoke(read));
+
+  EXPECT_CALL(*notifier, NotifySongInformation(_)).Times(2);
+  EXPECT_CALL(*notifier, NotifySongState(_)).Times(AnyNumber());
+  EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(AnyNumber());
+
+  // Notify only when second song is finished, so this test can safely exit
+  EXPECT_CALL(*notifier, ClearSongInformation(true))
+      .WillOnce(Return())
+      .WillOnce(Invoke([&] { syncer.NotifyStep(3); }));
+
+  EXPECT_CALL(*playback, Prepare()).Times(2).WillRepeatedly(Return(error::kSuccess));
+  EXPECT_CALL(*playback, BeginDirectWrite(_)).WillRepeatedly(Return(nullptr));
+  EXPECT_CALL(*playback, AudioCallback(_, _)).WillRepeatedly(Invoke([](void* buffer, int size) {
+    std::this_thread::sleep_for(kPeriodTime);
+    return error::kSuccess;
+  }));
+
+  ON_CALL(*playback, Drain()).WillByDefault(Invoke([] {
+    std::this_thread::sleep_for(kBufferTime);
+    return error::kSuccess;
+  }));
+
+  // Song was interrupted by user, so remaining samples must be dropped instead of played
+  EXPECT_CALL(*playback, Stop()).Times(AtLeast(1)).WillRepeatedly(Return(error::kSuccess));
+  EXPECT_CALL(*playback, Drain()).Times(0);
+
+  audio_player->Play("Air - La Femme d'Argent");
+  syncer.WaitForStep(1);
+
+  // Ask for a new song while first one is still playing
+  auto requested = std::chrono::steady_clock::now();
+  audio_player->Play("Air - Sexy Boy");
+  syncer.WaitForStep(2);
+
+  EXPECT_LT(switched - requested, kTrackSwitchLatency);
+
+  audio_player->Exit();
+  syncer.WaitForStep(3);
+}
+
+/* ********************************************************************************************** */
+
 TEST_F(PlayerTest, CreatePlayerAndStartPlaying) {
   auto player = [&](TestSyncer& syncer) {
     auto playback = GetPlayback();
@@ -118,21 +454,20 @@ TEST_F(PlayerTest, CreatePlayerAndStartPlaying) {
 
     EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
-    // Only interested in second argument, which is a lambda created internally by audio_player
-    // itself So it is necessary to manually call it, to keep the behaviour similar to a
-    // real-life situation
-    EXPECT_CALL(*decoder, Decode(_, _))
-        .WillOnce(Invoke([](int dummy, driver::Decoder::AudioCallback callback) {
-          int64_t position = 0;
-          callback(0, 0, position);
-          return error::kSuccess;
-        }));
+    // Player pulls decoded samples on its own pace, until decoder reaches the end of song
+    EXPECT_CALL(*decoder, Read(_, _, _)).WillOnce(ReadChunk(0));
 
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _));
+    EXPECT_CALL(*notifier, SendAudioRaw(_));
     EXPECT_CALL(*playback, AudioCallback(_, _));
 
     EXPECT_CALL(*notifier, NotifySongState(model::Song::CurrentInformation{
                                .state = model::Song::MediaState::Play, .position = 0}));
+
+    EXPECT_CALL(*decoder, Read(_, _, _)).WillOnce(ReadEndOfSong());
+
+    // Song ended naturally, so playback must finish playing remaining samples
+    EXPECT_CALL(*playback, Drain());
+
     EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
       syncer.NotifyStep(2);
     }));
@@ -174,32 +509,24 @@ TEST_F(PlayerTest, StartPlayingAndPause) {
         .WillOnce(Return(error::kSuccess));
     EXPECT_CALL(*notifier, NotifySongInformation(_));
 
-    // Prepare is called again right after Pause was called
-    EXPECT_CALL(*playback, Prepare()).Times(2).WillRepeatedly(Return(error::kSuccess));
-
-    // Only interested in second argument, which is a lambda created internally by audio_player
-    // itself So it is necessary to manually call it, to keep the behaviour similar to a
-    // real-life situation
-    EXPECT_CALL(*decoder, Decode(_, _))
-        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-          // Starts playing
-          int64_t position = 0;
-          callback(0, 0, position);
-
-          // Notify other thread to ask for pause and wait for it
-          syncer.NotifyStep(2);
-          syncer.WaitForStep(3);
-
-          // Pause and wait to resume
-          position++;
-          callback(0, 0, position);
+    // Prepare is called only before start playing, as stream is resumed right where it was paused
+    EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
-          return error::kSuccess;
-        }));
+    // Starts playing, and before reading next chunk, notify other thread to ask for pause and wait
+    // for it (so player will pause and wait to resume right after this chunk)
+    EXPECT_CALL(*decoder, Read(_, _, _))
+        .WillOnce(ReadChunk(0))
+        .WillOnce(DoAll(InvokeWithoutArgs([&] {
+                          syncer.NotifyStep(2);
+                          syncer.WaitForStep(3);
+                        }),
+                        ReadChunk(1000)))
+        .WillOnce(ReadEndOfSong());
 
     EXPECT_CALL(*playback, Pause());
+    EXPECT_CALL(*playback, Resume());
 
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(2);
+    EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(2);
     EXPECT_CALL(*playback, AudioCallback(_, _)).Times(2);
 
     // Using-declaration to improve readability
@@ -270,20 +597,11 @@ TEST_F(PlayerTest, StartPlayingAndStop) {
     // Prepare is called again right after Stop was called
     EXPECT_CALL(*playback, Prepare());
 
-    // Only interested in second argument, which is a lambda created internally by audio_player
-    // itself so it is necessary to manually call it, to keep the behaviour similar to a
-    // real-life situation
-    EXPECT_CALL(*decoder, Decode(_, _))
-        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-          syncer.WaitForStep(3);
-
-          int64_t position = 0;
-          callback(0, 0, position);
-
-          return error::kSuccess;
-        }));
+    // Stop command is already waiting to be handled right after the first chunk is read
+    EXPECT_CALL(*decoder, Read(_, _, _))
+        .WillOnce(DoAll(InvokeWithoutArgs([&] { syncer.WaitForStep(3); }), ReadChunk(0)));
 
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(0);
+    EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(0);
     EXPECT_CALL(*playback, AudioCallback(_, _)).Times(0);
     EXPECT_CALL(*playback, Stop());
 
@@ -309,7 +627,7 @@ TEST_F(PlayerTest, StartPlayingAndStop) {
     syncer.WaitForStep(2);
     player_ctl->Stop();
 
-    // Notify audio player to execute Decode callback right after the Stop command is sent
+    // Notify audio player to read first chunk right after the Stop command is sent
     syncer.NotifyStep(3);
 
     // Wait for Player to finish playing song before client asks to exit
@@ -339,23 +657,14 @@ TEST_F(PlayerTest, StartPlayingAndUpdateSongState) {
     // Prepare is called again right after Pause was called
     EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
-    // Only interested in second argument, which is a lambda created internally by audio_player
-    // itself So it is necessary to manually call it, to keep the behaviour similar to a
-    // real-life situation
-    EXPECT_CALL(*decoder, Decode(_, _))
-        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-          int64_t position = 1;
-          callback(0, 0, position);
-
-          return error::kSuccess;
-        }));
+    EXPECT_CALL(*decoder, Read(_, _, _)).WillOnce(ReadChunk(1000)).WillOnce(ReadEndOfSong());
 
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _));
+    EXPECT_CALL(*notifier, SendAudioRaw(_));
     EXPECT_CALL(*playback, AudioCallback(_, _));
 
     // In this case, decoder will tell us that the current timestamp matches some position other
-    // than zero (this value is represented in seconds). And for this, we should notify Media Player
-    // to update its graphical interface
+    // than zero (decoder uses milliseconds, while the song state holds it in seconds). And for
+    // this, we should notify Media Player to update its graphical interface
     uint32_t expected_position = 1;
     EXPECT_CALL(*notifier, NotifySongState(Field(&model::Song::CurrentInformation::position,
                                                  expected_position)));
@@ -402,8 +711,8 @@ TEST_F(PlayerTest, ErrorOpeningFile) {
     // None of these should be called in this situation
     EXPECT_CALL(*notifier, NotifySongInformation(_)).Times(0);
     EXPECT_CALL(*playback, Prepare()).Times(0);
-    EXPECT_CALL(*decoder, Decode(_, _)).Times(0);
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(0);
+    EXPECT_CALL(*decoder, Read(_, _, _)).Times(0);
+    EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(0);
     EXPECT_CALL(*playback, AudioCallback(_, _)).Times(0);
 
     // Only these should be called
@@ -450,7 +759,7 @@ TEST_F(PlayerTest, ErrorDecodingFile) {
     EXPECT_CALL(*notifier, NotifySongInformation(_));
     EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
-    EXPECT_CALL(*decoder, Decode(_, _)).WillOnce(Return(error::kUnknownError));
+    EXPECT_CALL(*decoder, Read(_, _, _)).WillOnce(Return(error::kUnknownError));
 
     // This should not be called in this situation
     EXPECT_CALL(*playback, AudioCallback(_, _)).Times(0);
@@ -488,25 +797,34 @@ TEST_F(PlayerTest, ChangeVolume) {
   auto decoder = GetDecoder();
   auto player_ctl = GetAudioControl();
 
-  // As decoder is just an interface, use this variable to hold volume information and setup
-  // expectation for decoder from player to always return the same variable
-  model::Volume value;
-  EXPECT_CALL(*decoder, GetVolume()).WillRepeatedly(Invoke([&] { return value; }));
-
   // Setup expectation for default value on volume
   EXPECT_THAT(player_ctl->GetAudioVolume(), Eq(model::Volume{1.f}));
 
-  // Setup expectation for decoder and set new volume on player
-  EXPECT_CALL(*decoder, SetVolume(_)).WillOnce(Invoke([&](model::Volume other) {
-    value = other;
-    return error::kSuccess;
-  }));
+  // Decoder is never touched by caller thread, not even while idle (only Audio thread does it)
+  EXPECT_CALL(*decoder, SetVolume(_)).Times(0);
+  EXPECT_CALL(*decoder, GetVolume()).Times(0);
 
   player_ctl->SetAudioVolume({0.3f});
 
   // Get updated volume from player
   EXPECT_THAT(player_ctl->GetAudioVolume(), Eq(model::Volume{0.3f}));
 
+  // Once Audio thread runs, it applies the new volume to decoders before waiting for a song
+  EXPECT_CALL(*decoder, SetVolume(Eq(model::Volume{0.3f}))).WillOnce(Return(error::kSuccess));
+  EXPECT_CALL(*GetNextDecoder(), SetVolume(Eq(model::Volume{0.3f})))
+      .WillOnce(Return(error::kSuccess));
+
+  // File cannot be opened, and that is the right moment to ask player to exit
+  EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(InvokeWithoutArgs([&] {
+    player_ctl->Exit();
+    return error::kFileNotSupported;
+  }));
+  EXPECT_CALL(*notifier, ClearSongInformation(_));
+  EXPECT_CALL(*notifier, NotifyError(_));
+
+  player_ctl->Play("Daft Punk - Around the World");
+  RunAudioLoop();
+
   // TODO: return error::Code on player API and create a test forcing error on volume change
 }
 
@@ -532,31 +850,25 @@ TEST_F(PlayerTest, StartPlayingSeekForwardAndBackward) {
     // Prepare is called again right after Pause was called
     EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
-    // Only interested in second argument, which is a lambda created internally by audio_player
-    // itself So it is necessary to manually call it, to keep the behaviour similar to a
-    // real-life situation
-    EXPECT_CALL(*decoder, Decode(_, _))
-        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-          int64_t position = 0;
-          syncer.NotifyStep(2);
-          callback(0, 0, position);
-          syncer.WaitForStep(3);
-
-          for (int i = 0; i <= 3; i++) {
-            position++;
-            callback(0, 0, position);
-          }
-
-          // This value is considering the seek backward/forward commands + sum in the for-loop
-          EXPECT_EQ(5, position);
-
-          return error::kSuccess;
-        }));
-
-    // These methods should be called only one time because of seek backward/forward command
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(2);
-    EXPECT_CALL(*playback, AudioCallback(_, _)).Times(2);
-    EXPECT_CALL(*notifier, NotifySongState(_)).Times(2);
+    // Before reading second chunk, wait for client to send seek commands
+    EXPECT_CALL(*decoder, Read(_, _, _))
+        .WillOnce(ReadChunk(0))
+        .WillOnce(DoAll(InvokeWithoutArgs([&] {
+                          syncer.NotifyStep(2);
+                          syncer.WaitForStep(3);
+                        }),
+                        ReadChunk(1000)))
+        .WillOnce(ReadChunk(2000))
+        .WillOnce(ReadChunk(3000))
+        .WillOnce(ReadChunk(4000))
+        .WillOnce(ReadEndOfSong());
+
+    // All seek commands are merged into a single one (forward by 1 second from the position of the
+    // chunk read), so decoder seeks only once and this chunk is discarded
+    EXPECT_CALL(*decoder, Seek(2000)).WillOnce(Return(error::kSuccess));
+    EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(4);
+    EXPECT_CALL(*playback, AudioCallback(_, _)).Times(4);
+    EXPECT_CALL(*notifier, NotifySongState(_)).Times(4);
 
     EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
       syncer.NotifyStep(4);
@@ -591,8 +903,8 @@ TEST_F(PlayerTest, StartPlayingSeekForwardAndBackward) {
 
 /* ********************************************************************************************** */
 
-TEST_F(PlayerTest, TryToSeekWhilePaused) {
-  const std::string song{"Joji - Glimpse of Us"};
+TEST_F(PlayerTest, StartPlayingAndSeekToExactPosition) {
+  const std::string song{"Tycho - Awake"};
 
   auto player = [&](TestSyncer& syncer) {
     auto playback = GetPlayback();
@@ -607,35 +919,108 @@ TEST_F(PlayerTest, TryToSeekWhilePaused) {
         }));
 
     EXPECT_CALL(*notifier, NotifySongInformation(_));
+    EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
-    // Prepare is called again right after Pause was called
-    EXPECT_CALL(*playback, Prepare()).Times(2).WillRepeatedly(Return(error::kSuccess));
+    // Before reading second chunk, wait for client to send seek commands
+    EXPECT_CALL(*decoder, Read(_, _, _))
+        .WillOnce(ReadChunk(0))
+        .WillOnce(DoAll(InvokeWithoutArgs([&] {
+                          syncer.NotifyStep(2);
+                          syncer.WaitForStep(3);
+                        }),
+                        ReadChunk(0)))
+        .WillOnce(ReadChunk(9500))
+        .WillOnce(ReadEndOfSong());
+
+    // Player asks decoder to seek exact position (in milliseconds), discarding the chunk read, and
+    // decoder is responsible to discard samples before the exact position
+    EXPECT_CALL(*decoder, Seek(9500)).WillOnce(Return(error::kSuccess));
+
+    EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(2);
+    EXPECT_CALL(*playback, AudioCallback(_, _)).Times(2);
 
-    // Only interested in second argument, which is a lambda created internally by audio_player
-    // itself So it is necessary to manually call it, to keep the behaviour similar to a
-    // real-life situation
-    EXPECT_CALL(*decoder, Decode(_, _))
-        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-          int64_t position = 0;
-          callback(0, 0, position);
+    // Using-declaration to improve readability
+    using Info = model::Song::CurrentInformation;
+    using State = model::Song::MediaState;
 
-          syncer.NotifyStep(2);
-          syncer.WaitForStep(3);
+    EXPECT_CALL(*notifier, NotifySongState(Eq(Info{.state = State::Play, .position = 0})));
 
-          for (int i = 0; i <= 3; i++) {
-            position++;
-            callback(0, 0, position);
-          }
+    // Even within the same second, UI receives the new position right after seeking
+    EXPECT_CALL(*notifier, NotifySongState(Eq(Info{
+                               .state = State::Play, .position = 9, .position_ms = 9500})));
 
-          // This value is considering the seek backward/forward commands + sum in the for-loop
-          EXPECT_EQ(4, position);
+    EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+      syncer.NotifyStep(4);
+    }));
 
+    // Notify that expectations are set, and run audio loop
+    syncer.NotifyStep(1);
+    RunAudioLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto player_ctl = GetAudioControl();
+    syncer.WaitForStep(1);
+
+    // Ask Audio Player to play file
+    player_ctl->Play(song);
+
+    // Consecutive absolute seeks are merged, so only the last one is handled
+    syncer.WaitForStep(2);
+    player_ctl->SeekTo(std::chrono::milliseconds(7250));
+    player_ctl->SeekTo(std::chrono::milliseconds(9500));
+    syncer.NotifyStep(3);
+
+    // Wait for Player to finish playing song before client asks to exit
+    syncer.WaitForStep(4);
+    player_ctl->Exit();
+  };
+
+  testing::RunAsyncTest({player, client});
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTest, TryToSeekWhilePaused) {
+  const std::string song{"Joji - Glimpse of Us"};
+
+  auto player = [&](TestSyncer& syncer) {
+    auto playback = GetPlayback();
+    auto decoder = GetDecoder();
+
+    // Setup all expectations
+    EXPECT_CALL(*decoder, OpenFile(Field(&model::Song::filepath, song)))
+        .WillOnce(Invoke([&](model::Song& audio_info) {
+          // To enable seek position feature, must fill duration info to song struct
+          audio_info.duration = 15;
           return error::kSuccess;
         }));
 
+    EXPECT_CALL(*notifier, NotifySongInformation(_));
+
+    // Prepare is called only before start playing, as stream is resumed right where it was paused
+    EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+
+    // Before reading second chunk, wait for client to pause song
+    EXPECT_CALL(*decoder, Read(_, _, _))
+        .WillOnce(ReadChunk(0))
+        .WillOnce(DoAll(InvokeWithoutArgs([&] {
+                          syncer.NotifyStep(2);
+                          syncer.WaitForStep(3);
+                        }),
+                        ReadChunk(1000)))
+        .WillOnce(ReadChunk(2000))
+        .WillOnce(ReadChunk(3000))
+        .WillOnce(ReadChunk(4000))
+        .WillOnce(ReadEndOfSong());
+
+    // Seek commands sent while paused are ignored
+    EXPECT_CALL(*decoder, Seek(_)).Times(0);
+
     EXPECT_CALL(*playback, Pause());
+    EXPECT_CALL(*playback, Resume());
 
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(5);
+    EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(5);
     EXPECT_CALL(*playback, AudioCallback(_, _)).Times(5);
 
     // Using-declaration to improve readability
@@ -708,31 +1093,23 @@ TEST_F(PlayerTest, StartPlayingAndRequestNewSong) {
     // Prepare is called before start playing
     EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
-    // Only interested in second argument, which is a lambda created internally by audio_player
-    // itself. So it is necessary to manually call it, to keep the behaviour similar to a
-    // real-life situation
-    EXPECT_CALL(*decoder, Decode(_, _))
-        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-          int64_t position = 1;
-          callback(0, 0, position);
-
-          syncer.NotifyStep(2);
-          syncer.WaitForStep(3);
+    // Before reading second chunk, wait for client to request a new song
+    EXPECT_CALL(*decoder, Read(_, _, _))
+        .WillOnce(ReadChunk(1000))
+        .WillOnce(DoAll(InvokeWithoutArgs([&] {
+                          syncer.NotifyStep(2);
+                          syncer.WaitForStep(3);
+                        }),
+                        ReadChunk(2000)));
 
-          position++;
-          callback(0, 0, position);
-
-          return error::kSuccess;
-        }));
-
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _));
+    EXPECT_CALL(*notifier, SendAudioRaw(_));
     EXPECT_CALL(*playback, AudioCallback(_, _));
 
     EXPECT_CALL(*playback, Stop());
 
     // In this case, decoder will tell us that the current timestamp matches some position other
-    // than zero (this value is represented in seconds). And for this, we should notify Media
-    // Player to update its graphical interface
+    // than zero (decoder uses milliseconds, while the song state holds it in seconds). And for
+    // this, we should notify Media Player to update its graphical interface
     uint32_t expected_position = 1;
     EXPECT_CALL(*notifier, NotifySongState(Field(&model::Song::CurrentInformation::position,
                                                  expected_position)));
@@ -752,18 +1129,14 @@ TEST_F(PlayerTest, StartPlayingAndRequestNewSong) {
       EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
       // In this case, this won't even play at all, it will wait for the Exit command from client
-      EXPECT_CALL(*decoder, Decode(_, _))
-          .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-            int64_t position = 0;
-
-            syncer.NotifyStep(4);
-            syncer.WaitForStep(5);
-
-            callback(0, 0, position);
-            return error::kSuccess;
-          }));
-
-      EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(0);
+      EXPECT_CALL(*decoder, Read(_, _, _))
+          .WillOnce(DoAll(InvokeWithoutArgs([&] {
+                            syncer.NotifyStep(4);
+                            syncer.WaitForStep(5);
+                          }),
+                          ReadChunk(0)));
+
+      EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(0);
       EXPECT_CALL(*playback, AudioCallback(_, _)).Times(0);
 
       expected_position = 0;
@@ -825,35 +1198,31 @@ TEST_F(PlayerTest, StartPlayingThenPauseAndRequestNewSong) {
     // it should exit from loop
     EXPECT_CALL(*playback, Prepare()).Times(1).WillRepeatedly(Return(error::kSuccess));
 
-    // Only interested in second argument, which is a lambda created internally by audio_player
-    // itself. So it is necessary to manually call it, to keep the behaviour similar to a
-    // real-life situation
-    EXPECT_CALL(*decoder, Decode(_, _))
-        .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-          int64_t position = 1;
-          callback(0, 0, position);
-
-          syncer.NotifyStep(2);
-          syncer.WaitForStep(3);
-
-          // This next callback call will be blocked until receives some of the expected commands
-          // for Paused state
-          position++;
-          callback(0, 0, position);
-
-          return error::kSuccess;
-        }));
+    // Before reading second chunk, wait for client to pause song (so player will be blocked right
+    // after this chunk, until receives some of the expected commands for Paused state)
+    EXPECT_CALL(*decoder, Read(_, _, _))
+        .WillOnce(ReadChunk(1000))
+        .WillOnce(DoAll(InvokeWithoutArgs([&] {
+                          syncer.NotifyStep(2);
+                          syncer.WaitForStep(3);
+                        }),
+                        ReadChunk(2000)));
 
     EXPECT_CALL(*playback, Pause());
 
-    EXPECT_CALL(*notifier, SendAudioRaw(_, _));
+    // Volume set while paused is still applied to both decoders
+    EXPECT_CALL(*decoder, SetVolume(Eq(model::Volume{0.5f}))).WillOnce(Return(error::kSuccess));
+    EXPECT_CALL(*GetNextDecoder(), SetVolume(Eq(model::Volume{0.5f})))
+        .WillOnce(Return(error::kSuccess));
+
+    EXPECT_CALL(*notifier, SendAudioRaw(_));
     EXPECT_CALL(*playback, AudioCallback(_, _));
 
     EXPECT_CALL(*playback, Stop());
 
     // In this case, decoder will tell us that the current timestamp matches some position other
-    // than zero (this value is represented in seconds). And for this, we should notify Media
-    // Player to update its graphical interface
+    // than zero (decoder uses milliseconds, while the song state holds it in seconds). And for
+    // this, we should notify Media Player to update its graphical interface
     uint32_t expected_position = 1;
     EXPECT_CALL(*notifier, NotifySongState(Field(&model::Song::CurrentInformation::position,
                                                  expected_position)));
@@ -876,18 +1245,14 @@ TEST_F(PlayerTest, StartPlayingThenPauseAndRequestNewSong) {
       EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
 
       // In this case, this won't even play at all, it will wait for the Exit command from client
-      EXPECT_CALL(*decoder, Decode(_, _))
-          .WillOnce(Invoke([&](int dummy, driver::Decoder::AudioCallback callback) {
-            int64_t position = 0;
-
-            syncer.NotifyStep(4);
-            syncer.WaitForStep(5);
-
-            callback(0, 0, position);
-            return error::kSuccess;
-          }));
-
-      EXPECT_CALL(*notifier, SendAudioRaw(_, _)).Times(0);
+      EXPECT_CALL(*decoder, Read(_, _, _))
+          .WillOnce(DoAll(InvokeWithoutArgs([&] {
+                            syncer.NotifyStep(4);
+                            syncer.WaitForStep(5);
+                          }),
+                          ReadChunk(0)));
+
+      EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(0);
       EXPECT_CALL(*playback, AudioCallback(_, _)).Times(0);
 
       expected_position = 0;
@@ -921,7 +1286,8 @@ TEST_F(PlayerTest, StartPlayingThenPauseAndRequestNewSong) {
     // Wait a bit, just until Player pauses
     std::this_thread::sleep_for(std::chrono::milliseconds(50));
 
-    // Send any command, just to check that it will be ignored by audio thread
+    // Send any command, just to check that it will be ignored by audio thread (except for volume,
+    // which is kept to be applied afterwards)
     player_ctl->SeekForwardPosition(1);
     player_ctl->SeekBackwardPosition(1);
     player_ctl->SetAudioVolume({0.5f});
@@ -938,4 +1304,319 @@ TEST_F(PlayerTest, StartPlayingThenPauseAndRequestNewSong) {
   testing::RunAsyncTest({player, client});
 }
 
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTest, PlayNextSongWithoutGap) {
+  auto player = [&](TestSyncer& syncer) {
+    auto playback = GetPlayback();
+    auto decoder = GetDecoder();
+    auto next_decoder = GetNextDecoder();
+
+    // Received filepaths to play
+    const std::string expected_name1{"Daft Punk - Veridis Quo"};
+    const std::string expected_name2{"Daft Punk - Short Circuit"};
+
+    // Setup all expectations
+    InSequence seq;
+
+    EXPECT_CALL(*decoder, OpenFile(Field(&model::Song::filepath, expected_name1)))
+        .WillOnce(Return(error::kSuccess));
+    EXPECT_CALL(*notifier, NotifySongInformation(Field(&model::Song::filepath, expected_name1)));
+
+    // Playback stream is prepared only once for both songs
+    EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+
+    EXPECT_CALL(*decoder, Read(_, _, _)).WillOnce(ReadChunk(0));
+
+    EXPECT_CALL(*notifier, SendAudioRaw(_));
+    EXPECT_CALL(*playback, AudioCallback(_, _));
+
+    // As first song is about to end, spare decoder opens the next one
+    EXPECT_CALL(*next_decoder, OpenFile(Field(&model::Song::filepath, expected_name2)))
+        .WillOnce(Return(error::kSuccess));
+
+    EXPECT_CALL(*notifier, NotifySongState(_));
+    EXPECT_CALL(*decoder, Read(_, _, _)).WillOnce(ReadEndOfSong());
+
+    // After switching decoders, the previous one is released
+    EXPECT_CALL(*decoder, ClearCache());
+    EXPECT_CALL(*notifier, NotifySongInformation(Field(&model::Song::filepath, expected_name2)));
+
+    EXPECT_CALL(*next_decoder, Read(_, _, _)).WillOnce(ReadChunk(0));
+
+    EXPECT_CALL(*notifier, SendAudioRaw(_));
+    EXPECT_CALL(*playback, AudioCallback(_, _));
+    EXPECT_CALL(*notifier, NotifySongState(_));
+    EXPECT_CALL(*next_decoder, Read(_, _, _)).WillOnce(ReadEndOfSong());
+
+    // Playback stream is drained only after the last song
+    EXPECT_CALL(*playback, Drain());
+
+    EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+      syncer.NotifyStep(3);
+    }));
+
+    // Playback stream should never be stopped or paused between songs
+    EXPECT_CALL(*playback, Stop()).Times(0);
+    EXPECT_CALL(*playback, Pause()).Times(0);
+
+    // Notify that expectations are set, and run audio loop only after both commands were sent
+    syncer.NotifyStep(1);
+    syncer.WaitForStep(2);
+    RunAudioLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto player_ctl = GetAudioControl();
+    syncer.WaitForStep(1);
+
+    // Ask Audio Player to play file and inform which one should come next
+    player_ctl->Play("Daft Punk - Veridis Quo");
+    player_ctl->SetNextSong("Daft Punk - Short Circuit");
+    syncer.NotifyStep(2);
+
+    // Wait for Player to finish playing both songs before client asks to exit
+    syncer.WaitForStep(3);
+    player_ctl->Exit();
+  };
+
+  testing::RunAsyncTest({player, client});
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTest, PlayWarmedUpSong) {
+  DecoderMock* warmed_up = nullptr;
+
+  // Create Player again, now with a pool to open files in background
+  auto pool = new audio::DecoderPool(
+      [&warmed_up] {
+        auto decoder = std::make_unique<DecoderMock>();
+        EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(Return(error::kSuccess));
+        EXPECT_CALL(*decoder, SetOutputFormat(_)).Times(AnyNumber());
+        EXPECT_CALL(*decoder, Read(_, _, _)).WillRepeatedly(ReadChunks(0));
+
+        warmed_up = decoder.get();
+        return decoder;
+      },
+      /* budget= */ 1024 * 1024, /* overhead= */ 0);
+
+  Init(/* asynchronous= */ false, pool);
+
+  const std::string filename{"Daft Punk - One More Time"};
+
+  // User selected this file on interface, so it is opened and decoded in background
+  audio_player->WarmUp({filename});
+  WaitForWarmUp();
+  ASSERT_NE(warmed_up, nullptr);
+
+  auto player = [&](TestSyncer& syncer) {
+    auto playback = GetPlayback();
+    auto decoder = GetDecoder();
+
+    // File is not opened again, as decoder warmed up in background takes place of the current one
+    EXPECT_CALL(*decoder, OpenFile(_)).Times(0);
+    EXPECT_CALL(*notifier, NotifySongInformation(Field(&model::Song::filepath, filename)));
+    EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+
+    // Samples decoded in background (300ms) are played before reading anything else from decoder
+    int played = 0;
+    EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(AnyNumber());
+    EXPECT_CALL(*playback, AudioCallback(_, _)).WillRepeatedly(Invoke([&](void*, int frames) {
+      played += frames;
+      return error::kSuccess;
+    }));
+
+    EXPECT_CALL(*notifier, NotifySongState(_));
+    EXPECT_CALL(*warmed_up, Read(_, _, _)).WillOnce(Invoke([&](void*, int& frames, int64_t&) {
+      EXPECT_EQ(played, 13230);
+      frames = 0;
+      return error::kSuccess;
+    }));
+
+    EXPECT_CALL(*playback, Drain());
+    EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+      syncer.NotifyStep(2);
+    }));
+
+    // Notify that expectations are set, and run audio loop
+    syncer.NotifyStep(1);
+    RunAudioLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto player_ctl = GetAudioControl();
+    syncer.WaitForStep(1);
+
+    player_ctl->Play(filename);
+
+    syncer.WaitForStep(2);
+    player_ctl->Exit();
+  };
+
+  testing::RunAsyncTest({player, client});
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTest, PlayNextSongWarmedUpInBackground) {
+  DecoderMock* warmed_up = nullptr;
+
+  // Create Player again, now with a pool to open files in background
+  auto pool = new audio::DecoderPool(
+      [&warmed_up] {
+        auto decoder = std::make_unique<DecoderMock>();
+        EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(Return(error::kSuccess));
+        EXPECT_CALL(*decoder, SetOutputFormat(_)).Times(AnyNumber());
+        EXPECT_CALL(*decoder, Read(_, _, _)).WillRepeatedly(ReadChunks(0));
+
+        warmed_up = decoder.get();
+        return decoder;
+      },
+      /* budget= */ 1024 * 1024, /* overhead= */ 0);
+
+  Init(/* asynchronous= */ false, pool);
+
+  const std::string expected_name1{"Daft Punk - Aerodynamic"};
+  const std::string expected_name2{"Daft Punk - Digital Love"};
+
+  auto player = [&](TestSyncer& syncer) {
+    auto playback = GetPlayback();
+    auto decoder = GetDecoder();
+
+    // Spare decoder is never used to open next song, as it was already opened in background
+    EXPECT_CALL(*GetNextDecoder(), OpenFile(_)).Times(0);
+
+    EXPECT_CALL(*decoder, OpenFile(Field(&model::Song::filepath, expected_name1)))
+        .WillOnce(Return(error::kSuccess));
+    EXPECT_CALL(*notifier, NotifySongInformation(Field(&model::Song::filepath, expected_name1)));
+    EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+
+    int played = 0;
+    EXPECT_CALL(*notifier, SendAudioRaw(_)).Times(AnyNumber());
+    EXPECT_CALL(*notifier, NotifySongState(_)).Times(AnyNumber());
+    EXPECT_CALL(*playback, AudioCallback(_, _)).WillRepeatedly(Invoke([&](void*, int frames) {
+      played += frames;
+      return error::kSuccess;
+    }));
+
+    // Next song was set before playing the first one, so it is warmed up while the first plays
+    EXPECT_CALL(*decoder, Read(_, _, _)).WillOnce(Invoke([&](void*, int& frames, int64_t&) {
+      WaitForWarmUp();
+      EXPECT_NE(warmed_up, nullptr);
+
+      // Samples decoded in background are played before reading anything else from decoder
+      EXPECT_CALL(*warmed_up, Read(_, _, _)).WillOnce(Invoke([&](void*, int& frames, int64_t&) {
+        EXPECT_EQ(played, 13230);
+        frames = 0;
+        return error::kSuccess;
+      }));
+
+      frames = 0;
+      return error::kSuccess;
+    }));
+
+    EXPECT_CALL(*decoder, ClearCache());
+    EXPECT_CALL(*notifier, NotifySongInformation(Field(&model::Song::filepath, expected_name2)));
+
+    EXPECT_CALL(*playback, Drain());
+    EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+      syncer.NotifyStep(3);
+    }));
+
+    // Notify that expectations are set, and run audio loop only after both commands were sent
+    syncer.NotifyStep(1);
+    syncer.WaitForStep(2);
+    RunAudioLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto player_ctl = GetAudioControl();
+    syncer.WaitForStep(1);
+
+    // Next song arrives while player is still idle, so it must be kept until first song plays
+    player_ctl->SetNextSong(expected_name2);
+    player_ctl->Play(expected_name1);
+    syncer.NotifyStep(2);
+
+    syncer.WaitForStep(3);
+    player_ctl->Exit();
+  };
+
+  testing::RunAsyncTest({player, client});
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PlayerTest, NegotiateOutputFormatWithPlayback) {
+  // Playback supports only some of the formats
+  SetCapabilities(driver::Playback::Capabilities{
+      .sample_formats = {model::AudioFormat::SampleFormat::S16,
+                         model::AudioFormat::SampleFormat::S32},
+      .sample_rates = {44100, 48000, 96000},
+  });
+
+  auto player = [&](TestSyncer& syncer) {
+    auto playback = GetPlayback();
+    auto decoder = GetDecoder();
+    auto next_decoder = GetNextDecoder();
+
+    // Song in high resolution, which should be played without resampling or truncating samples
+    const model::AudioFormat expected_format{
+        .sample_format = model::AudioFormat::SampleFormat::S32,
+        .sample_rate = 96000,
+        .channels = 2,
+    };
+
+    // Setup all expectations
+    InSequence seq;
+
+    EXPECT_CALL(*decoder, OpenFile(_)).WillOnce(Invoke([](model::Song& song) {
+      song.sample_rate = 96000;
+      song.bit_depth = 24;
+      return error::kSuccess;
+    }));
+
+    EXPECT_CALL(*playback, Stop());
+    EXPECT_CALL(*playback, ConfigureParameters(expected_format))
+        .WillOnce(Return(error::kSuccess));
+    EXPECT_CALL(*playback, GetPeriodSize());
+    EXPECT_CALL(*playback, GetSettings());
+    EXPECT_CALL(*notifier, NotifyAudioFormat(expected_format));
+    EXPECT_CALL(*notifier, NotifyPlaybackSettings(_));
+    EXPECT_CALL(*next_decoder, SetOutputFormat(expected_format));
+    EXPECT_CALL(*decoder, SetOutputFormat(expected_format)).WillOnce(Return(error::kSuccess));
+
+    EXPECT_CALL(*notifier, NotifySongInformation(_));
+    EXPECT_CALL(*playback, Prepare()).WillOnce(Return(error::kSuccess));
+    EXPECT_CALL(*decoder, Read(_, _, _)).WillOnce(ReadEndOfSong());
+    EXPECT_CALL(*playback, Drain());
+
+    EXPECT_CALL(*notifier, ClearSongInformation(true)).WillOnce(Invoke([&] {
+      syncer.NotifyStep(2);
+    }));
+
+    // Notify that expectations are set, and run audio loop
+    syncer.NotifyStep(1);
+    RunAudioLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto player_ctl = GetAudioControl();
+    syncer.WaitForStep(1);
+
+    // Ask Audio Player to play file
+    player_ctl->Play("Pink Floyd - Time");
+
+    // Wait for Player to finish playing song before client asks to exit
+    syncer.WaitForStep(2);
+    player_ctl->Exit();
+  };
+
+  testing::RunAsyncTest({player, client});
+
+  // Negotiated format is kept until another song requires something different
+  EXPECT_EQ(GetAudioFormat().sample_rate, 96000);
+}
+
 }  // namespace
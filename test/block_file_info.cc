@@ -148,4 +148,47 @@ TEST_F(FileInfoTest, UpdateAndClearSongInfo) {
   EXPECT_THAT(rendered, StrEq(expected));
 }
 
+/* ********************************************************************************************** */
+
+TEST_F(FileInfoTest, UpdatePlaybackSettings) {
+  model::PlaybackSettings settings{
+      .device = "hw:1,0",
+      .latency = model::PlaybackSettings::Latency::Low,
+      .format =
+          model::AudioFormat{
+              .sample_format = model::AudioFormat::SampleFormat::S32,
+              .sample_rate = 96000,
+          },
+      .period_size = 480,
+      .buffer_size = 1920,
+  };
+
+  // Process custom event on block
+  auto event = interface::CustomEvent::UpdatePlaybackSettings(settings);
+  Process(event);
+
+  ftxui::Render(*screen, block->Render());
+
+  std::string rendered = utils::FilterAnsiCommands(screen->ToString());
+
+  std::string expected = R"(
+╭ information ─────────────────╮
+│Artist                 <Empty>│
+│Title                  <Empty>│
+│Channels               <Empty>│
+│Sample rate            <Empty>│
+│Bit rate               <Empty>│
+│Bits per sample        <Empty>│
+│Duration               <Empty>│
+│Device                  hw:1,0│
+│Output              S32 96 kHz│
+│Period                  5.0 ms│
+│Latency                20.0 ms│
+│                              │
+│                              │
+╰──────────────────────────────╯)";
+
+  EXPECT_THAT(rendered, StrEq(expected));
+}
+
 }  // namespace
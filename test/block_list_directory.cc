@@ -5,6 +5,8 @@
 
 #include <filesystem>  // for current_path, path
 #include <memory>      // for __shared_ptr_access
+#include <optional>
+#include <vector>
 
 #include "ftxui/component/component.hpp"       // for Make
 #include "ftxui/component/component_base.hpp"  // for Component, ComponentBase
@@ -21,7 +23,10 @@
 namespace {
 
 using ::testing::AllOf;
+using ::testing::ElementsAre;
 using ::testing::Field;
+using ::testing::HasSubstr;
+using ::testing::Not;
 using ::testing::StrEq;
 using ::testing::VariantWith;
 
@@ -44,12 +49,16 @@ class ListDirectoryTest : public ::BlockTest {
 
     // use test directory as base dir
     std::string source_dir{std::filesystem::current_path().parent_path().string() + "/test"};
-    block = ftxui::Make<ListDirectoryMock>(dispatcher, source_dir);
+    block = ftxui::Make<ListDirectoryMock>(dispatcher, source_dir, [this](const auto& file) {
+      return lookup ? lookup(file) : std::optional<model::Song>{};
+    });
 
     // Set this block as focused
     auto dummy = std::static_pointer_cast<interface::Block>(block);
     dummy->SetFocused(true);
   }
+
+  interface::SongLookup lookup;  //!< Find song information for files listed (empty by default)
 };
 
 /* ********************************************************************************************** */
@@ -298,6 +307,18 @@ TEST_F(ListDirectoryTest, EnterAndExitSearchMode) {
 TEST_F(ListDirectoryTest, NotifyFileSelection) {
   // Setup expectation for event sending
   std::filesystem::path file{"audio_player.cc"};
+  std::filesystem::path next{"block_file_info.cc"};
+
+  // Selected file and its neighbour are opened in background by player (".." is skipped)
+  using Files = std::vector<std::filesystem::path>;
+  EXPECT_CALL(*dispatcher,
+              SendEvent(AllOf(Field(&interface::CustomEvent::id,
+                                    interface::CustomEvent::Identifier::WarmUpFiles),
+                              Field(&interface::CustomEvent::content,
+                                    VariantWith<Files>(ElementsAre(IsSameFilename(file),
+                                                                   IsSameFilename(next)))))))
+      .Times(1);
+
   EXPECT_CALL(*dispatcher,
               SendEvent(AllOf(Field(&interface::CustomEvent::id,
                                     interface::CustomEvent::Identifier::NotifyFileSelection),
@@ -334,6 +355,25 @@ TEST_F(ListDirectoryTest, NotifyFileSelection) {
 
 /* ********************************************************************************************** */
 
+TEST_F(ListDirectoryTest, QueueNextSongWhilePlaying) {
+  auto list_dir = std::static_pointer_cast<interface::ListDirectory>(block);
+  std::filesystem::path next = list_dir->entries_.at(2).filename();
+
+  // Entry right after the one playing is the next song to be played by player
+  EXPECT_CALL(*dispatcher,
+              SendEvent(AllOf(Field(&interface::CustomEvent::id,
+                                    interface::CustomEvent::Identifier::SetNextSong),
+                              Field(&interface::CustomEvent::content,
+                                    VariantWith<std::filesystem::path>(IsSameFilename(next))))))
+      .Times(1);
+
+  model::Song audio{.filepath = list_dir->entries_.at(1).string()};
+  auto event = interface::CustomEvent::UpdateSongInfo(audio);
+  block->OnCustomEvent(event);
+}
+
+/* ********************************************************************************************** */
+
 TEST_F(ListDirectoryTest, RunTextAnimation) {
   // Hacky method to add new entry
   auto list_dir = std::static_pointer_cast<interface::ListDirectory>(block);
@@ -346,6 +386,11 @@ TEST_F(ListDirectoryTest, RunTextAnimation) {
                                            interface::CustomEvent::Identifier::Refresh)))
       .Times(5);
 
+  // Only the selected file is opened in background, as the previous entry is a directory
+  EXPECT_CALL(*dispatcher, SendEvent(Field(&interface::CustomEvent::id,
+                                           interface::CustomEvent::Identifier::WarmUpFiles)))
+      .Times(1);
+
   block->OnEvent(ftxui::Event::End);
 
   ftxui::Render(*screen, block->Render());
@@ -511,4 +556,23 @@ TEST_F(ListDirectoryTest, ScrollMenuOnBigList) {
   EXPECT_THAT(rendered, StrEq(expected));
 }
 
+/* ********************************************************************************************** */
+
+TEST_F(ListDirectoryTest, ShowSongInformationFromLookup) {
+  // Only files found by lookup (and with a title) are listed using song information
+  lookup = [](const std::filesystem::path& file) -> std::optional<model::Song> {
+    if (file.filename() == "audio_player.cc") return model::Song{.artist = "Who", .title = "Me"};
+    if (file.filename() == "block_file_info.cc") return model::Song{.artist = "Nobody"};
+    return std::nullopt;
+  };
+
+  ftxui::Render(*screen, block->Render());
+
+  std::string rendered = utils::FilterAnsiCommands(screen->ToString());
+
+  EXPECT_THAT(rendered, HasSubstr("│  Who - Me"));
+  EXPECT_THAT(rendered, HasSubstr("│  block_file_info.cc"));
+  EXPECT_THAT(rendered, Not(HasSubstr("audio_player.cc")));
+}
+
 }  // namespace
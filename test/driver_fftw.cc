@@ -3,7 +3,9 @@
 #include <gtest/gtest-message.h>    // for Message
 #include <gtest/gtest-test-part.h>  // for TestPartResult
 
+#include <algorithm>
 #include <cmath>
+#include <filesystem>
 #include <iostream>
 #include <memory>
 #include <vector>
@@ -39,9 +41,50 @@ class FftwTest : public ::testing::Test {
   // TODO: implement (get block starting on line :78)
   void PrintResults(const std::vector<double>& result) {}
 
+  //! Get plan used by each audio range
+  std::vector<fftwf_plan> GetPlans() const {
+    return {analyzer->bass_.plan.get(), analyzer->mid_.plan.get(), analyzer->treble_.plan.get()};
+  }
+
+  //! Get the most recent frames from input buffer, in the same way they are read by each range
+  std::vector<float> GetInput(int frames) const {
+    const float* data = analyzer->ReadInput(analyzer->input_left_, frames);
+    return std::vector<float>(data, data + frames);
+  }
+
+  //! Run analysis on sinus waves (200Hz in left channel and 2000Hz in right), returning last
+  //! output from each channel rounded to nearest 1/1000th
+  void RunAnalysis(std::vector<double>& left, std::vector<double>& right) {
+    // Create in/out buffers
+    int out_size = analyzer->GetOutputSize();
+    std::vector<double> out(out_size, 0);
+    std::vector<float> in_left(kBufferSize, 0);
+    std::vector<float> in_right(kBufferSize, 0);
+
+    // Running execute 300 times (simulating about 3.5 seconds run time
+    for (int k = 0; k < 300; k++) {
+      // Filling up 512 frames at a time, making sure the sinus wave is unbroken
+      for (int n = 0; n < kBufferSize; n++) {
+        in_left[n] = sin(2 * M_PI * 200 / 44100 * (n + ((float)k * kBufferSize))) * 20000;
+        in_right[n] = sin(2 * M_PI * 2000 / 44100 * (n + ((float)k * kBufferSize))) * 20000;
+      }
+
+      analyzer->Execute(in_left.data(), in_right.data(), kBufferSize, out.data());
+    }
+
+    // Rounding last output to nearest 1/1000th
+    for (int i = 0; i < out_size; i++) {
+      out[i] = (double)round(out[i] * 1000) / 1000;
+    }
+
+    // Split result by channel
+    left.assign(out.begin(), out.begin() + out_size / 2);
+    right.assign(out.begin() + out_size / 2, out.end());
+  }
+
  protected:
-  static constexpr int kNumberBars = 10;    //!< Number of bars per channel
-  static constexpr int kBufferSize = 1024;  //!< Input buffer size
+  static constexpr int kNumberBars = 10;   //!< Number of bars per channel
+  static constexpr int kBufferSize = 512;  //!< Input buffer size (in frames)
 
   Fftw analyzer;  //!< Audio frequency analysis
 };
@@ -50,34 +93,11 @@ class FftwTest : public ::testing::Test {
 
 TEST_F(FftwTest, InitAndExecute) {
   // Create expected results
-  const Matcher<double> expected_200MHz[kNumberBars] = {0, 0, 0.999, 0.009, 0, 0.001, 0, 0, 0, 0};
-  const Matcher<double> expected_2000MHz[kNumberBars] = {0, 0, 0, 0, 0, 0, 0.524, 0.474, 0, 0};
-
-  // Create in/out buffers
-  int out_size = analyzer->GetOutputSize();
-  std::vector<double> out(out_size, 0);
-  std::vector<double> in(kBufferSize, 0);
-
-  // Running execute 300 times (simulating about 3.5 seconds run time
-  for (int k = 0; k < 300; k++) {
-    // Filling up 512*2 samples at a time, making sure the sinus wave is unbroken
-    // 200MHz in left channel, 2000MHz in right
-    for (int n = 0; n < kBufferSize / 2; n++) {
-      in[n * 2] = sin(2 * M_PI * 200 / 44100 * (n + ((float)k * kBufferSize / 2))) * 20000;
-      in[n * 2 + 1] = sin(2 * M_PI * 2000 / 44100 * (n + ((float)k * kBufferSize / 2))) * 20000;
-    }
+  const Matcher<double> expected_200MHz[kNumberBars] = {0, 0, 0.997, 0.009, 0, 0.001, 0, 0, 0, 0};
+  const Matcher<double> expected_2000MHz[kNumberBars] = {0, 0, 0, 0, 0, 0, 0.523, 0.474, 0, 0};
 
-    analyzer->Execute(in.data(), kBufferSize, out.data());
-  }
-
-  // Rounding last output to nearest 1/1000th
-  for (int i = 0; i < out_size; i++) {
-    out[i] = (double)round(out[i] * 1000) / 1000;
-  }
-
-  // Split result by channel
-  std::vector<double> left(out.begin(), out.begin() + 10);
-  std::vector<double> right(out.begin() + 10, out.begin() + 20);
+  std::vector<double> left, right;
+  RunAnalysis(left, right);
 
   // Print results
   std::cout.setf(std::ios::fixed, std::ios::floatfield);
@@ -98,4 +118,80 @@ TEST_F(FftwTest, InitAndExecute) {
   ASSERT_THAT(right, ElementsAreArray(expected_2000MHz));
 }
 
+/* ********************************************************************************************** */
+
+TEST_F(FftwTest, ResizeOutputReusingPlans) {
+  const Matcher<double> expected_200MHz[kNumberBars] = {0, 0, 0.997, 0.009, 0, 0.001, 0, 0, 0, 0};
+  const Matcher<double> expected_2000MHz[kNumberBars] = {0, 0, 0, 0, 0, 0, 0.523, 0.474, 0, 0};
+
+  auto plans = GetPlans();
+
+  // Change number of bars, just like when terminal is resized
+  EXPECT_EQ(analyzer->Init(6 * 2), error::kSuccess);
+  EXPECT_EQ(analyzer->GetOutputSize(), 12);
+  EXPECT_EQ(GetPlans(), plans);
+
+  EXPECT_EQ(analyzer->Init(kNumberBars * 2), error::kSuccess);
+  EXPECT_EQ(analyzer->GetOutputSize(), kNumberBars * 2);
+  EXPECT_EQ(GetPlans(), plans);
+
+  // Bars are distributed as if analyzer was just created
+  std::vector<double> left, right;
+  RunAnalysis(left, right);
+
+  ASSERT_THAT(left, ElementsAreArray(expected_200MHz));
+  ASSERT_THAT(right, ElementsAreArray(expected_2000MHz));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FftwTest, KeepMostRecentFramesContiguous) {
+  int input_size = analyzer->GetBufferSize();
+  std::vector<double> out(analyzer->GetOutputSize(), 0);
+
+  // Sequential values, with a chunk size that makes writes wrap around input buffer
+  constexpr int kChunk = 3000;
+  std::vector<float> chunk(kChunk);
+
+  for (int k = 0; k < 5; k++) {
+    for (int n = 0; n < kChunk; n++) chunk[n] = static_cast<float>(k * kChunk + n);
+
+    analyzer->Execute(chunk.data(), chunk.data(), kChunk, out.data());
+
+    // Whole history and windows from smaller ranges are always ordered from oldest to newest
+    for (int frames : {input_size, 4096, 1024}) {
+      int available = std::min((k + 1) * kChunk, frames);
+      auto input = GetInput(frames);
+
+      std::vector<float> expected(frames, 0);
+      for (int n = 0; n < available; n++) {
+        expected[frames - available + n] = static_cast<float>((k + 1) * kChunk - available + n);
+      }
+
+      ASSERT_THAT(input, ElementsAreArray(expected));
+    }
+  }
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(FftwTest, SaveWisdomAfterCreatingPlans) {
+  auto directory = std::filesystem::temp_directory_path() / "spectrum_fftw_test";
+  auto wisdom = directory / "fftw.wisdom";
+  std::filesystem::remove_all(directory);
+
+  // Directory is created along with wisdom file
+  analyzer = std::make_unique<driver::FFTW>(wisdom);
+  analyzer->Init(kNumberBars * 2);
+
+  EXPECT_TRUE(std::filesystem::exists(wisdom));
+
+  // Analyzer created later imports it, running just like before
+  analyzer = std::make_unique<driver::FFTW>(wisdom);
+  EXPECT_EQ(analyzer->Init(kNumberBars * 2), error::kSuccess);
+  EXPECT_EQ(analyzer->GetBufferSize(), 8192);
+
+  std::filesystem::remove_all(directory);
+}
+
 }  // namespace
@@ -4,6 +4,7 @@
 #include <gtest/gtest-test-part.h>  // for TestPartResult
 
 #include <chrono>
+#include <cstdint>
 #include <memory>
 #include <thread>
 #include <vector>
@@ -15,6 +16,7 @@
 #include "mock/audio_control_mock.h"
 #include "mock/event_dispatcher_mock.h"
 #include "model/application_error.h"
+#include "model/pcm_block.h"
 #include "util/logger.h"
 #include "view/base/notifier.h"
 
@@ -22,6 +24,7 @@ namespace {
 
 using ::testing::_;
 using ::testing::AllOf;
+using ::testing::Each;
 using ::testing::ElementsAreArray;
 using ::testing::Eq;
 using ::testing::Field;
@@ -29,6 +32,7 @@ using ::testing::InSequence;
 using ::testing::Invoke;
 using ::testing::Ne;
 using ::testing::Return;
+using ::testing::SizeIs;
 using ::testing::VariantWith;
 
 using testing::TestSyncer;
@@ -147,8 +151,9 @@ TEST_F(MediaControllerTest, ExecuteAllMethodsFromAudioNotifier) {
   EXPECT_CALL(*audio_ctl, SetAudioVolume(Eq(volume)));
   notifier->SetVolume(volume);
 
+  // Analyzer is only resized by analysis thread (not running in this test)
   int number_bars = 16;
-  EXPECT_CALL(*analyzer, Init(Eq(number_bars)));
+  EXPECT_CALL(*analyzer, Init(_)).Times(0);
   notifier->ResizeAnalysisOutput(number_bars);
 
   int skip_seconds = 25;
@@ -221,8 +226,8 @@ TEST_F(MediaControllerTest, AnalysisOnRawAudio) {
     EXPECT_CALL(*analyzer, GetOutputSize()).WillOnce(Return(kNumberBars));
 
     // Thread received a new command, create expectation to analyze and send its result back to UI
-    EXPECT_CALL(*analyzer, Execute(_, Eq(sample_size), _))
-        .WillOnce(Invoke([&](double*, int, double*) {
+    EXPECT_CALL(*analyzer, Execute(_, _, Eq(sample_size), _))
+        .WillOnce(Invoke([&](const float*, const float*, int, double*) {
           syncer.NotifyStep(2);
           return error::kSuccess;
         }));
@@ -243,8 +248,174 @@ TEST_F(MediaControllerTest, AnalysisOnRawAudio) {
 
     // Send random data to the thread to analyze it
     syncer.WaitForStep(1);
-    std::vector<uint8_t> buffer(sample_size, 1);
-    notifier->SendAudioRaw(buffer.data(), buffer.size());
+    std::vector<int16_t> buffer(sample_size * 2, 1);
+    notifier->SendAudioRaw(model::PcmBlock{.data = buffer.data(), .frames = sample_size});
+
+    // Wait for Analysis to finish before exiting from controller
+    syncer.WaitForStep(2);
+    controller->Exit();
+  };
+
+  testing::RunAsyncTest({analysis, client});
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MediaControllerTest, AnalyzeOnlyMostRecentWindow) {
+  int sample_size = 16;
+
+  auto analysis = [&](TestSyncer& syncer) {
+    auto analyzer = GetAnalyzer();
+    auto dispatcher = GetEventDispatcher();
+
+    // Wait for client to send all data before running audio loop
+    syncer.WaitForStep(1);
+
+    // Setup all expectations
+    InSequence seq;
+
+    EXPECT_CALL(*analyzer, GetBufferSize()).WillOnce(Return(sample_size));
+    EXPECT_CALL(*analyzer, GetOutputSize()).WillOnce(Return(kNumberBars));
+
+    // Backlog is collapsed into a single analysis, using only data from the most recent block
+    EXPECT_CALL(*analyzer, Execute(_, _, Eq(sample_size), _))
+        .WillOnce(Invoke([&](const float* left, const float* right, int frames, double*) {
+          EXPECT_THAT(std::vector<float>(left, left + frames), Each(3));
+          EXPECT_THAT(std::vector<float>(right, right + frames), Each(3));
+          syncer.NotifyStep(2);
+          return error::kSuccess;
+        }));
+
+    EXPECT_CALL(*dispatcher,
+                SendEvent(Field(&interface::CustomEvent::id,
+                                interface::CustomEvent::Identifier::DrawAudioSpectrum)));
+
+    RunAnalysisLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto notifier = GetInterfaceNotifier();
+
+    // Send multiple blocks before analysis has any chance to run
+    for (int16_t value : {1, 2, 3}) {
+      std::vector<int16_t> buffer(sample_size * 2, value);
+      notifier->SendAudioRaw(model::PcmBlock{.data = buffer.data(), .frames = sample_size});
+    }
+
+    syncer.NotifyStep(1);
+
+    // Wait for Analysis to finish before exiting from controller
+    syncer.WaitForStep(2);
+    controller->Exit();
+  };
+
+  testing::RunAsyncTest({analysis, client});
+
+  auto statistics = controller->GetAnalysisStatistics();
+  EXPECT_EQ(statistics.skipped, 2 * sample_size);
+  EXPECT_EQ(statistics.dropped, 0);
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MediaControllerTest, ChangeSampleRateBetweenAnalyses) {
+  int sample_size = 16;
+
+  auto analysis = [&](TestSyncer& syncer) {
+    auto analyzer = GetAnalyzer();
+    auto dispatcher = GetEventDispatcher();
+
+    // Wait for client to send everything before running audio loop
+    syncer.WaitForStep(1);
+
+    EXPECT_CALL(*analyzer, GetBufferSize()).WillRepeatedly(Return(sample_size));
+    EXPECT_CALL(*analyzer, GetOutputSize()).WillRepeatedly(Return(kNumberBars));
+
+    // Sample rate is only changed by analysis thread, never while running some analysis
+    InSequence seq;
+
+    EXPECT_CALL(*analyzer, SetSampleRate(Eq(48000)));
+    EXPECT_CALL(*analyzer, Execute(_, _, Eq(sample_size), _))
+        .WillOnce(Invoke([&](const float*, const float*, int, double*) {
+          syncer.NotifyStep(2);
+          return error::kSuccess;
+        }));
+
+    EXPECT_CALL(*dispatcher,
+                SendEvent(Field(&interface::CustomEvent::id,
+                                interface::CustomEvent::Identifier::DrawAudioSpectrum)));
+
+    RunAnalysisLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto notifier = GetInterfaceNotifier();
+
+    // Player changed audio format right before sending new data
+    notifier->NotifyAudioFormat(model::AudioFormat{.sample_rate = 48000});
+
+    std::vector<int16_t> buffer(sample_size * 2, 1);
+    notifier->SendAudioRaw(model::PcmBlock{.data = buffer.data(), .frames = sample_size});
+
+    syncer.NotifyStep(1);
+
+    // Wait for Analysis to finish before exiting from controller
+    syncer.WaitForStep(2);
+    controller->Exit();
+  };
+
+  testing::RunAsyncTest({analysis, client});
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MediaControllerTest, ResizeOutputBetweenAnalyses) {
+  int sample_size = 16;
+  int number_bars = 16;
+
+  auto analysis = [&](TestSyncer& syncer) {
+    auto analyzer = GetAnalyzer();
+    auto dispatcher = GetEventDispatcher();
+
+    // Wait for client to send everything before running audio loop
+    syncer.WaitForStep(1);
+
+    // Setup all expectations
+    InSequence seq;
+
+    EXPECT_CALL(*analyzer, GetBufferSize()).WillOnce(Return(sample_size));
+    EXPECT_CALL(*analyzer, GetOutputSize()).WillOnce(Return(kNumberBars));
+    EXPECT_CALL(*analyzer, Init(Eq(number_bars)));
+
+    // Output is resized before running the next analysis
+    EXPECT_CALL(*analyzer, GetBufferSize()).WillOnce(Return(sample_size));
+    EXPECT_CALL(*analyzer, GetOutputSize()).WillOnce(Return(number_bars));
+
+    EXPECT_CALL(*analyzer, Execute(_, _, Eq(sample_size), _))
+        .WillOnce(Invoke([&](const float*, const float*, int, double*) {
+          syncer.NotifyStep(2);
+          return error::kSuccess;
+        }));
+
+    EXPECT_CALL(*dispatcher,
+                SendEvent(AllOf(Field(&interface::CustomEvent::id,
+                                      interface::CustomEvent::Identifier::DrawAudioSpectrum),
+                                Field(&interface::CustomEvent::content,
+                                      VariantWith<std::vector<double>>(SizeIs(number_bars))))));
+
+    RunAnalysisLoop();
+  };
+
+  auto client = [&](TestSyncer& syncer) {
+    auto notifier = GetInterfaceNotifier();
+
+    // User changed the number of bars right before player sent new data
+    GetPlayerNotifier()->ResizeAnalysisOutput(number_bars);
+
+    std::vector<int16_t> buffer(sample_size * 2, 1);
+    notifier->SendAudioRaw(model::PcmBlock{.data = buffer.data(), .frames = sample_size});
+
+    syncer.NotifyStep(1);
 
     // Wait for Analysis to finish before exiting from controller
     syncer.WaitForStep(2);
@@ -275,13 +446,9 @@ TEST_F(MediaControllerTest, AnalysisAndClearAnimation) {
       InSequence seq;
 
       // Create expectation to analyze data and send its result back to UI
-      EXPECT_CALL(*analyzer, Execute(_, Eq(sample_size), _))
-          .WillOnce(Invoke([&](double* input, int, double* output) {
-            for (int i = 0; i < kNumberBars; i++) {
-              std::cout << input[i] << " ";
-            }
-            std::cout << std::endl;
-            std::copy(input, input + kNumberBars, output);
+      EXPECT_CALL(*analyzer, Execute(_, _, Eq(sample_size), _))
+          .WillOnce(Invoke([&](const float* left, const float*, int, double* output) {
+            std::copy(left, left + kNumberBars, output);
             syncer.NotifyStep(2);
             return error::kSuccess;
           }));
@@ -342,8 +509,8 @@ TEST_F(MediaControllerTest, AnalysisAndClearAnimation) {
 
     // In order to run ClearAnimation, must send some raw data first (to fill internal buffer)
     syncer.WaitForStep(1);
-    std::vector<uint8_t> buffer(sample_size, 1);
-    notifier->SendAudioRaw(buffer.data(), buffer.size());
+    std::vector<int16_t> buffer(sample_size * 2, 1);
+    notifier->SendAudioRaw(model::PcmBlock{.data = buffer.data(), .frames = sample_size});
 
     // Send a Pause notification to run ClearAnimation
     // syncer.WaitForStep(2);
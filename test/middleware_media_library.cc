@@ -0,0 +1,194 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <atomic>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include "middleware/media_library.h"
+#include "model/application_error.h"
+#include "model/song.h"
+#include "util/logger.h"
+
+namespace {
+
+/**
+ * @brief Tests with MediaLibrary class
+ */
+class MediaLibraryTest : public ::testing::Test {
+ protected:
+  using Statistics = middleware::MediaLibrary::Statistics;
+
+  static void SetUpTestSuite() { util::Logger::GetInstance().Configure(); }
+
+  void SetUp() override {
+    root = std::filesystem::temp_directory_path() /
+           ("spectrum_library_" + std::string{::testing::UnitTest::GetInstance()
+                                                  ->current_test_info()
+                                                  ->name()});
+
+    std::filesystem::remove_all(root);
+    std::filesystem::create_directories(root / "music" / "album");
+
+    index = root / "cache" / "library.idx";
+  }
+
+  void TearDown() override {
+    library.reset();
+    std::filesystem::remove_all(root);
+  }
+
+  //! Create library using a fake probe, where only files with ".mp3" extension are supported
+  void Init() {
+    library = middleware::MediaLibrary::Create(
+        index,
+        [this](model::Song& song) {
+          probed++;
+
+          std::filesystem::path filepath{song.filepath};
+          if (filepath.extension() != ".mp3") return error::kFileNotSupported;
+
+          song.artist = "Artist";
+          song.title = filepath.stem().string();
+          song.sample_rate = 44100;
+          song.duration = 180;
+          return error::kSuccess;
+        },
+        /* workers= */ 2);
+  }
+
+  //! Create file with some content, so it is possible to change its size later
+  void CreateFile(const std::filesystem::path& filepath, const std::string& content = "data") {
+    std::ofstream file(filepath, std::ios::trunc);
+    file << content;
+  }
+
+  //! Scan music directory and wait for it to finish
+  void Scan() {
+    probed = 0;
+    library->Scan(root / "music");
+    library->Wait();
+  }
+
+ protected:
+  std::filesystem::path root;   //!< Temporary directory for test
+  std::filesystem::path index;  //!< Path to index file
+
+  std::unique_ptr<middleware::MediaLibrary> library;  //!< Media library
+  std::atomic<int> probed = 0;                        //!< Number of files probed by fake probe
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(MediaLibraryTest, ScanAndFindSong) {
+  CreateFile(root / "music" / "first.mp3");
+  CreateFile(root / "music" / "album" / "second.mp3");
+  CreateFile(root / "music" / "album" / "cover.jpg");
+
+  Init();
+  Scan();
+
+  EXPECT_FALSE(library->IsScanning());
+  EXPECT_EQ(probed, 3);
+  EXPECT_EQ(library->Size(), 3);
+  EXPECT_EQ(library->GetStatistics(), (Statistics{.files = 3, .probed = 3, .failed = 1}));
+
+  auto song = library->Find(root / "music" / "album" / "second.mp3");
+  ASSERT_TRUE(song.has_value());
+
+  EXPECT_EQ(song->filepath, (root / "music" / "album" / "second.mp3").string());
+  EXPECT_EQ(song->artist, "Artist");
+  EXPECT_EQ(song->title, "second");
+  EXPECT_EQ(song->sample_rate, 44100);
+  EXPECT_EQ(song->duration, 180);
+
+  // File not supported is kept in index, but there is no song information for it
+  EXPECT_FALSE(library->Find(root / "music" / "album" / "cover.jpg").has_value());
+  EXPECT_FALSE(library->Find(root / "music" / "unknown.mp3").has_value());
+
+  // Index was saved to disk right after scanning
+  EXPECT_TRUE(std::filesystem::exists(index));
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MediaLibraryTest, RescanOnlyModifiedFiles) {
+  CreateFile(root / "music" / "first.mp3");
+  CreateFile(root / "music" / "album" / "second.mp3");
+  CreateFile(root / "music" / "album" / "cover.jpg");
+
+  Init();
+  Scan();
+
+  EXPECT_EQ(probed, 3);
+
+  // Nothing changed, so no file is probed again (not even the unsupported one)
+  Scan();
+
+  EXPECT_EQ(probed, 0);
+  EXPECT_EQ(library->GetStatistics(), (Statistics{.files = 3, .unchanged = 3}));
+
+  // Change size from one file and add a new one
+  CreateFile(root / "music" / "first.mp3", "modified data");
+  CreateFile(root / "music" / "album" / "third.mp3");
+
+  Scan();
+
+  EXPECT_EQ(probed, 2);
+  EXPECT_EQ(library->Size(), 4);
+  EXPECT_EQ(library->GetStatistics(), (Statistics{.files = 4, .probed = 2, .unchanged = 2}));
+  EXPECT_TRUE(library->Find(root / "music" / "album" / "third.mp3").has_value());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MediaLibraryTest, RemoveDeletedFiles) {
+  CreateFile(root / "music" / "first.mp3");
+  CreateFile(root / "music" / "album" / "second.mp3");
+
+  Init();
+  Scan();
+
+  EXPECT_EQ(library->Size(), 2);
+
+  std::filesystem::remove_all(root / "music" / "album");
+  Scan();
+
+  EXPECT_EQ(probed, 0);
+  EXPECT_EQ(library->Size(), 1);
+  EXPECT_EQ(library->GetStatistics(), (Statistics{.files = 1, .unchanged = 1, .removed = 1}));
+  EXPECT_FALSE(library->Find(root / "music" / "album" / "second.mp3").has_value());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(MediaLibraryTest, LoadIndexFromDisk) {
+  CreateFile(root / "music" / "first.mp3");
+  CreateFile(root / "music" / "album" / "second.mp3");
+  CreateFile(root / "music" / "album" / "cover.jpg");
+
+  Init();
+  Scan();
+
+  auto expected = library->Find(root / "music" / "first.mp3");
+  ASSERT_TRUE(expected.has_value());
+
+  // Create a new library, which loads index saved by the previous one
+  library.reset();
+  Init();
+
+  EXPECT_EQ(library->Size(), 3);
+  EXPECT_EQ(library->Find(root / "music" / "first.mp3"), expected);
+  EXPECT_FALSE(library->Find(root / "music" / "album" / "cover.jpg").has_value());
+
+  // And everything is up-to-date, so there is nothing to probe
+  Scan();
+
+  EXPECT_EQ(probed, 0);
+  EXPECT_EQ(library->GetStatistics(), (Statistics{.files = 3, .unchanged = 3}));
+}
+
+}  // namespace
@@ -15,7 +15,9 @@ namespace {
 class AnalyzerMock final : public driver::Analyzer {
  public:
   MOCK_METHOD(error::Code, Init, (int output_size), (override));
-  MOCK_METHOD(error::Code, Execute, (double *in, int size, double *out), (override));
+  MOCK_METHOD(error::Code, SetSampleRate, (int sample_rate), (override));
+  MOCK_METHOD(error::Code, Execute,
+              (const float *left, const float *right, int frames, double *out), (override));
   MOCK_METHOD(int, GetBufferSize, (), (override));
   MOCK_METHOD(int, GetOutputSize, (), (override));
 };
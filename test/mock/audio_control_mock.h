@@ -21,8 +21,11 @@ class AudioControlMock final : public audio::AudioControl {
   MOCK_METHOD(model::Volume, GetAudioVolume, (), (const, override));
   MOCK_METHOD(void, SeekForwardPosition, (int value), (override));
   MOCK_METHOD(void, SeekBackwardPosition, (int value), (override));
+  MOCK_METHOD(void, SeekTo, (std::chrono::milliseconds position), (override));
   MOCK_METHOD(void, ApplyAudioFilters, (const std::vector<model::AudioFilter>& filters),
               (override));
+  MOCK_METHOD(void, SetNextSong, (const std::string& filepath), (override));
+  MOCK_METHOD(void, WarmUp, (const std::vector<std::string>& filepaths), (override));
   MOCK_METHOD(void, Exit, (), (override));
 };
 
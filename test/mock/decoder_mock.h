@@ -19,8 +19,10 @@ namespace {
 class DecoderMock final : public driver::Decoder {
  public:
   MOCK_METHOD(error::Code, OpenFile, (model::Song & audio_info), (override));
-  MOCK_METHOD(error::Code, Decode, (int samples, AudioCallback callback), (override));
+  MOCK_METHOD(error::Code, Read, (void* buffer, int& frames, int64_t& position), (override));
+  MOCK_METHOD(error::Code, Seek, (int64_t position), (override));
   MOCK_METHOD(void, ClearCache, (), (override));
+  MOCK_METHOD(error::Code, SetOutputFormat, (const model::AudioFormat& format), (override));
   MOCK_METHOD(error::Code, SetVolume, (model::Volume value), (override));
   MOCK_METHOD(model::Volume, GetVolume, (), (const, override));
   MOCK_METHOD(error::Code, UpdateFilters, (const std::vector<model::AudioFilter>& filters),
@@ -12,6 +12,7 @@
 
 #include <memory>  // for shared_ptr
 #include <string>  // for string
+#include <utility>  // for move
 
 #include "view/block/list_directory.h"  // for ListDirectory
 
@@ -25,8 +26,9 @@ ACTION_P(ReturnPointee, p) { return p->filename().string(); }
 //! Mock class to change default behaviour when rendering the inner element corresponding to Title
 class ListDirectoryMock final : public interface::ListDirectory {
  public:
-  ListDirectoryMock(const std::shared_ptr<interface::EventDispatcher>& d, const std::string& s)
-      : interface::ListDirectory(d, s) {
+  ListDirectoryMock(const std::shared_ptr<interface::EventDispatcher>& d, const std::string& s,
+                    interface::SongLookup l = nullptr)
+      : interface::ListDirectory(d, s, std::move(l)) {
     SetupTitleExpectation();
   }
 
@@ -15,14 +15,21 @@ namespace {
 class PlaybackMock final : public driver::Playback {
  public:
   MOCK_METHOD(error::Code, CreatePlaybackStream, (), (override));
-  MOCK_METHOD(error::Code, ConfigureParameters, (), (override));
+  MOCK_METHOD(Capabilities, GetCapabilities, (), (override));
+  MOCK_METHOD(error::Code, ConfigureParameters, (const model::AudioFormat& format), (override));
   MOCK_METHOD(error::Code, Prepare, (), (override));
   MOCK_METHOD(error::Code, Pause, (), (override));
+  MOCK_METHOD(error::Code, Resume, (), (override));
   MOCK_METHOD(error::Code, Stop, (), (override));
+  MOCK_METHOD(error::Code, Drain, (), (override));
   MOCK_METHOD(error::Code, AudioCallback, (void* buffer, int size), (override));
+  MOCK_METHOD(void*, BeginDirectWrite, (int& frames), (override));
+  MOCK_METHOD(error::Code, CommitDirectWrite, (int frames), (override));
+  MOCK_METHOD(int, GetDelay, (), (override));
   MOCK_METHOD(error::Code, SetVolume, (model::Volume), (override));
   MOCK_METHOD(model::Volume, GetVolume, (), (override));
   MOCK_METHOD(uint32_t, GetPeriodSize, (), (const override));
+  MOCK_METHOD(model::PlaybackSettings, GetSettings, (), (const override));
 };
 
 }  // namespace
@@ -0,0 +1,84 @@
+#include <gmock/gmock-matchers.h>  // for StrEq, EXPECT_THAT
+#include <gtest/gtest-message.h>    // for Message
+#include <gtest/gtest-test-part.h>  // for TestPartResult
+
+#include <filesystem>
+#include <stdexcept>
+#include <string_view>
+
+#include "util/path_table.h"
+
+namespace {
+
+using ::testing::ElementsAre;
+
+/**
+ * @brief Tests with PathTable class
+ */
+class PathTableTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    table.emplace_back("/music/Some Artist - Song.mp3", false);
+    table.emplace_back("/music/album", true);
+    table.emplace_back("/music/another song.flac", false);
+    table.emplace_back("cover.jpg", false);
+  }
+
+ protected:
+  util::PathTable table;  //!< Table of file paths
+};
+
+/* ********************************************************************************************** */
+
+TEST_F(PathTableTest, GetEntries) {
+  ASSERT_EQ(table.size(), 4);
+
+  EXPECT_EQ(table.at(0), std::filesystem::path{"/music/Some Artist - Song.mp3"});
+  EXPECT_EQ(table.native(1), "/music/album");
+  EXPECT_EQ(table.filename(2), "another song.flac");
+  EXPECT_EQ(table.filename(3), "cover.jpg");
+
+  EXPECT_FALSE(table.is_directory(0));
+  EXPECT_TRUE(table.is_directory(1));
+
+  EXPECT_THROW(table.at(4), std::out_of_range);
+
+  // Entry added at the beginning shifts all the others
+  table.emplace_front("..", true);
+
+  EXPECT_EQ(table.size(), 5);
+  EXPECT_EQ(table.filename(0), "..");
+  EXPECT_EQ(table.filename(1), "Some Artist - Song.mp3");
+
+  table.clear();
+  EXPECT_TRUE(table.empty());
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PathTableTest, SortByFilename) {
+  table.sort([](std::string_view lhs, std::string_view rhs) { return lhs < rhs; });
+
+  EXPECT_EQ(table.filename(0), "Some Artist - Song.mp3");
+  EXPECT_EQ(table.filename(1), "album");
+  EXPECT_EQ(table.filename(2), "another song.flac");
+  EXPECT_EQ(table.filename(3), "cover.jpg");
+
+  // Type is moved along with its entry
+  EXPECT_TRUE(table.is_directory(1));
+  EXPECT_EQ(table.native(1), "/music/album");
+}
+
+/* ********************************************************************************************** */
+
+TEST_F(PathTableTest, FindByFilename) {
+  // Only filename is considered, ignoring case
+  EXPECT_THAT(table.find("SONG"), ElementsAre(0, 2));
+  EXPECT_THAT(table.find("music"), ElementsAre());
+  EXPECT_THAT(table.find(".jpg"), ElementsAre(3));
+
+  // Empty text matches everything
+  EXPECT_THAT(table.find(""), ElementsAre(0, 1, 2, 3));
+}
+
+}  // namespace